@@ -0,0 +1,45 @@
+/*
+ * alloc_count.c - Bộ đếm số lần cấp phát heap, nạp qua LD_PRELOAD (glibc)
+ *
+ * Dùng cho 'make bench': chặn malloc/calloc/realloc của chương trình được đo,
+ * chuyển tiếp sang hàm gốc của glibc và in tổng số lần gọi ra stderr khi
+ * chương trình kết thúc.
+ */
+#include <stdio.h>
+#include <stddef.h>
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static unsigned long g_malloc_calls = 0;
+static unsigned long g_calloc_calls = 0;
+static unsigned long g_realloc_calls = 0;
+
+void* malloc(size_t size) {
+    __atomic_fetch_add(&g_malloc_calls, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&g_calloc_calls, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    __atomic_fetch_add(&g_realloc_calls, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+/**
+ * @brief In số lần cấp phát khi tiến trình thoát.
+ * Dùng fprintf lên stderr (không đệm) nên không cấp phát thêm trong lúc in.
+ */
+__attribute__((destructor))
+static void report_alloc_counts(void) {
+    unsigned long mallocs = __atomic_load_n(&g_malloc_calls, __ATOMIC_RELAXED);
+    unsigned long callocs = __atomic_load_n(&g_calloc_calls, __ATOMIC_RELAXED);
+    unsigned long reallocs = __atomic_load_n(&g_realloc_calls, __ATOMIC_RELAXED);
+    fprintf(stderr, "alloc_count: malloc=%lu calloc=%lu realloc=%lu total=%lu\n",
+            mallocs, callocs, reallocs, mallocs + callocs + reallocs);
+}
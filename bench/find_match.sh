@@ -0,0 +1,56 @@
+#!/bin/sh
+# find_match.sh - Đo số lần cấp phát và thời gian của 'find <từ> --match -j 1'
+#
+# Cách dùng: find_match.sh <chương trình> <alloc_count.so> [chương trình cũ]
+# Dữ liệu vào được sinh lại giống hệt ở mỗi lần chạy (không dùng số ngẫu nhiên),
+# nên có thể so sánh kết quả giữa hai bản dựng. Khi có chương trình cũ, kết quả
+# của nó được in trước để thấy số lần cấp phát trước và sau khi thay đổi.
+set -e
+
+BIN=$1
+PRELOAD=$2
+BEFORE=$3
+LINES=${BENCH_LINES:-200000}
+WORK=${TMPDIR:-/tmp}/text_analyst_bench.$$
+INPUT=$WORK/bench_log.txt
+
+if [ -z "$BIN" ] || [ -z "$PRELOAD" ]; then
+    echo "Cách dùng: $0 <chương trình> <alloc_count.so> [chương trình cũ]" >&2
+    exit 1
+fi
+
+mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+# Nhật ký giả lập: mức độ, đường dẫn và mã trạng thái xoay vòng theo số dòng
+awk -v n="$LINES" 'BEGIN {
+    split("INFO WARN ERROR DEBUG", level, " ");
+    split("/api/users /api/orders /static/app.js /health /api/Request/retry", path, " ");
+    for (i = 0; i < n; i++) {
+        printf "2026-10-19 %02d:%02d:%02d %s request id=%d GET %s status=%d in %d ms\n",
+               (i / 3600) % 24, (i / 60) % 60, i % 60, level[i % 4 + 1], i,
+               path[(i * 7) % 5 + 1], 200 + (i % 3) * 100, (i * 13) % 977;
+    }
+}' > "$INPUT"
+
+run_case() {
+    label=$1
+    prog=$2
+    out=$WORK/out_$label.txt
+    start=$(date +%s.%N)
+    LD_PRELOAD=$PRELOAD "$prog" find "$INPUT" request --match -j 1 > "$out" 2> "$WORK/err_$label.txt"
+    end=$(date +%s.%N)
+    counts=$(grep '^alloc_count:' "$WORK/err_$label.txt" | tail -n 1 | sed 's/^alloc_count: //')
+    printf "%-7s %s  time=%ss  output_lines=%s\n" "$label" "$counts" \
+        "$(awk -v a="$start" -v b="$end" 'BEGIN { printf "%.3f", b - a }')" "$(wc -l < "$out" | tr -d ' ')"
+}
+
+echo "find request --match -j 1 trên $LINES dòng ($(wc -c < "$INPUT" | tr -d ' ') byte):"
+if [ -n "$BEFORE" ]; then
+    run_case before "$BEFORE"
+fi
+run_case after "$BIN"
+if [ -n "$BEFORE" ] && ! cmp -s "$WORK/out_before.txt" "$WORK/out_after.txt"; then
+    echo "Cảnh báo: kết quả của hai chương trình khác nhau." >&2
+    exit 1
+fi
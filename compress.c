@@ -1,110 +1,296 @@
 #include "compress.h"
+#include "crc32c.h"
+#include "huffman.h"
+#include "lz77.h"
+#include "lzh.h"
+#include "search.h"
+#include "threadpool.h"
 #include <stdlib.h> // Cho các hàm khác nếu cần
 #include <stdio.h>
 #include <string.h>
 
-// Khai báo các cấu trúc dữ liệu cần thiết cho thuật toán nén Huffman
-// Node cho cây Huffman
-typedef struct HuffmanNode {
-    unsigned char data;
-    unsigned int freq;
-    struct HuffmanNode *left, *right;
-} HuffmanNode;
-
-// Hàng đợi ưu tiên (Min-Heap)
-typedef struct MinHeap {
-    unsigned int size;
-    unsigned int capacity;
-    HuffmanNode** array;
-} MinHeap;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Lấy mẫu cho --algo auto: khoảng 1/AUTO_SAMPLE_RATIO dữ liệu, chia thành các mẫu AUTO_SAMPLE_SIZE byte rải đều
+#define AUTO_SAMPLE_SIZE  (64 << 10)
+#define AUTO_SAMPLE_RATIO 256
+#define AUTO_MIN_SAMPLES  4
+#define AUTO_MAX_SAMPLES  32
+// Hai bảng độ dài mã ở đầu mỗi khối LZH
+#define AUTO_LZH_TABLES_SIZE (HUFFMAN_LENGTHS_SIZE(LZH_LITLEN_SYMBOLS) + HUFFMAN_LENGTHS_SIZE(LZH_DISTANCE_SYMBOLS))
+
+// Vị trí trong tệp 64 bit cho bảng tra vị trí: long chỉ có 32 bit trên Windows
+#ifdef _WIN32
+#define file_seek64 _fseeki64
+#define file_tell64 _ftelli64
+#else
+#define file_seek64 fseeko
+#define file_tell64 ftello
+#endif
+
+#define BLOCK_CRC_MISMATCH (-2)
+#define OUTPUT_SINK_INITIAL_SIZE (1 << 20) // Kích thước bộ đệm ban đầu khi giải nén vào bộ nhớ // Trạng thái của slot khi CRC32C của dữ liệu giải nén không khớp header
+
+// Đích của dữ liệu giải nén: tệp, hoặc bộ đệm trong bộ nhớ tự nới rộng khi file = NULL
+typedef struct {
+    FILE* file;
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} OutputSink;
 
 // --- KHAI BÁO CÁC HÀM "PRIVATE" (CHỈ DÙNG TRONG FILE NÀY) ---
-// Chữ ký hàm cho RLE
-static int perform_rle_compress(FILE* input, FILE* output);
-static int perform_rle_decompress(FILE* input, FILE* output);
-
-// Chữ ký hàm cho Huffman
-HuffmanNode* create_node(unsigned char data, unsigned int freq);
-MinHeap* create_min_heap(unsigned int capacity);
-void swap_nodes(HuffmanNode** a, HuffmanNode** b);
-void min_heapify(MinHeap* minHeap, int idx);
-HuffmanNode* extract_min(MinHeap* minHeap);
-void insert_node(MinHeap* minHeap, HuffmanNode* node);
-HuffmanNode* build_huffman_tree(unsigned int freq[]);
-void generate_codes_recursive(HuffmanNode* root, int arr[], int top, char** codes);
-void free_huffman_tree(HuffmanNode* root);
-static int perform_huffman_compress(FILE* input, FILE* output);
-static int perform_huffman_decompress(FILE* input, FILE* output);
+// Chữ ký hàm cho RLE (định dạng cũ không có header chỉ còn được giải nén)
+static int perform_rle_decompress(FILE* input, FILE* output, const unsigned char* prefix, size_t prefix_size);
+static size_t rle_pair_bound(size_t size);
+static size_t rle_pair_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst);
+static int rle_pair_decode(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+
+// Chữ ký hàm cho RLE theo khối
+static size_t rle_run_length(const unsigned char* p, const unsigned char* end);
+static const unsigned char* rle_find_run(const unsigned char* p, const unsigned char* limit, const unsigned char* end);
+static size_t rle_block_encode(const unsigned char* src, size_t size, unsigned char* dst);
+static int rle_block_decode(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+static size_t rle_block_bound(size_t size);
+static size_t rle_block_codec_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst);
+
+// Chữ ký hàm cho Huffman (định dạng cũ)
+static int perform_huffman_legacy_decompress(FILE* input, FILE* output);
+
+// Chữ ký hàm cho khung chung
+typedef struct BlockCodec BlockCodec;
+typedef struct BlockBatch BlockBatch;
+static const BlockCodec* frame_codec(CompressionAlgorithm algo);
+static int frame_compress(FILE* input, FILE* output, CompressionAlgorithm algo, const CompressOptions* options);
+static int frame_decompress(FILE* input, OutputSink* output, const CompressOptions* options, CompressionAlgorithm* detected);
+static int block_decompress_loop(FILE* input, OutputSink* output, const BlockCodec* codec, const FrameHeader* frame,
+                                 const CompressOptions* options);
+static int sink_write(OutputSink* sink, const unsigned char* data, size_t size);
+static int read_block_header(FILE* input, FrameBlockHeader* header);
+typedef struct BlockSlot BlockSlot;
+static int read_block(FILE* input, const BlockBatch* batch, BlockSlot* slot);
+static void report_block_error(const BlockSlot* slot, uint64_t index, uint64_t offset);
+static void write_seek_table_entry(unsigned char* p, const BlockSlot* slot);
+static void read_seek_table_entry(const unsigned char* p, SeekTableEntry* entry);
+static int read_seek_table_footer(FILE* input, SeekTableFooter* footer);
+static int check_seek_table(FILE* input, uint32_t entry_count, uint32_t crc);
+static int write_frame_header(FILE* output, const FrameHeader* header);
+static int read_frame_header(FILE* input, FrameHeader* header);
+static int write_frame_block_header(FILE* output, const FrameBlockHeader* header);
+static void write_le32(unsigned char* p, uint32_t value);
+static void write_le64(unsigned char* p, uint64_t value);
+static uint32_t read_le32(const unsigned char* p);
+static uint64_t read_le64(const unsigned char* p);
+static int block_batch_init(BlockBatch* batch, const BlockCodec* codec, size_t block_size, const CompressOptions* options, int compressing);
+static void block_batch_free(BlockBatch* batch);
+static void block_batch_run(BlockBatch* batch, int count, ThreadPoolTask task);
+static void block_compress_task(void* context, int index, int worker);
+static void block_decompress_task(void* context, int index, int worker);
+
+// Chữ ký hàm cho đọc ngẫu nhiên tệp nén có bảng tra vị trí
+static size_t seekable_find_block(const SeekableFile* file, uint64_t offset);
+static int seekable_decode(SeekableFile* file, size_t first, uint64_t end);
+
+// Bộ mã khối của từng định dạng
+static size_t huffman_block_bound(size_t size);
+static size_t huffman_block_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst);
+static size_t lz77_block_bound(size_t size);
+static void* create_matcher(const CompressOptions* options, size_t block_size, int default_level);
+static void* lz77_create_state(const CompressOptions* options, size_t block_size);
+static void lz77_free_state(void* state);
+static size_t lz77_block_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst);
+static size_t lzh_block_bound(size_t size);
+static void* lzh_create_state(const CompressOptions* options, size_t block_size);
+static size_t lzh_block_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst);
+
+// Chữ ký hàm cho --algo auto; thống kê được cộng dồn trên các mẫu
+typedef struct {
+    uint64_t sampled;                       // Tổng số byte đã lấy mẫu
+    uint64_t freq[HUFFMAN_SYMBOLS];         // Tần suất bậc 0
+    uint64_t rle_size;                      // Kích thước RLE theo khối của các mẫu
+    uint64_t lzh_size;                      // Kích thước LZH của các mẫu, không tính bảng mã
+} SampleStats;
+static void sample_block(SampleStats* stats, const unsigned char* src, size_t size, unsigned char* scratch,
+                         void* matcher, unsigned char* lzh_out);
+static uint64_t huffman_size_estimate(const uint64_t freq[HUFFMAN_SYMBOLS]);
+
+/**
+ * @brief Bộ mã của một định dạng theo khối. state là dữ liệu riêng của từng luồng khi nén
+ * (ví dụ bảng băm của LZ77), tạo một lần cho mỗi luồng; NULL nếu định dạng không cần.
+ */
+struct BlockCodec {
+    size_t block_size;
+    size_t (*bound)(size_t size);
+    void* (*create_state)(const CompressOptions* options, size_t block_size);
+    void (*free_state)(void* state);
+    size_t (*encode)(void* state, const unsigned char* src, size_t size, unsigned char* dst);
+    int (*decode)(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+};
+
+static const BlockCodec rle_codec = {
+    RLE_BLOCK_SIZE, rle_pair_bound, NULL, NULL, rle_pair_encode, rle_pair_decode
+};
+
+static const BlockCodec rle_block_codec = {
+    RLE_BLOCK_SIZE, rle_block_bound, NULL, NULL, rle_block_codec_encode, rle_block_decode
+};
+
+static const BlockCodec huffman_block_codec = {
+    HUFFMAN_BLOCK_SIZE, huffman_block_bound, NULL, NULL, huffman_block_encode, huffman_decode_block
+};
+
+static const BlockCodec lz77_block_codec = {
+    LZ77_BLOCK_SIZE, lz77_block_bound, lz77_create_state, lz77_free_state, lz77_block_encode, lz77_decode_block
+};
+
+static const BlockCodec lzh_block_codec = {
+    LZH_BLOCK_SIZE, lzh_block_bound, lzh_create_state, lz77_free_state, lzh_block_encode, lzh_decode_block
+};
 
 // --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
 
-int compress_file(FILE* input, FILE* output, CompressionAlgorithm algo) {
-    switch (algo) {
-        case ALG_RLE:
-            return perform_rle_compress(input, output);
-        case ALG_HUFFMAN:
-            return perform_huffman_compress(input, output);
-        default:
-            fprintf(stderr, "Lỗi: Thuật toán nén không xác định.\n");
-            return -1;
+int compress_file(FILE* input, FILE* output, CompressionAlgorithm algo, const CompressOptions* options) {
+    if (algo == ALG_AUTO) algo = choose_compression_algorithm(input);
+    if (frame_codec(algo) == NULL) {
+        fprintf(stderr, "Lỗi: Thuật toán nén không xác định.\n");
+        return -1;
     }
+    return frame_compress(input, output, algo, options);
 }
 
-int decompress_file(FILE* input, FILE* output, CompressionAlgorithm algo) {
-    switch (algo) {
-        case ALG_RLE:
-            return perform_rle_decompress(input, output);
-        case ALG_HUFFMAN:
-            return perform_huffman_decompress(input, output);
-        default:
-            fprintf(stderr, "Lỗi: Thuật toán giải nén không xác định.\n");
-            return -1;
+int decompress_file(FILE* input, FILE* output, CompressionAlgorithm algo, const CompressOptions* options,
+                    CompressionAlgorithm* detected) {
+    CompressionAlgorithm found = ALG_UNKNOWN;
+    if (detected == NULL) detected = &found;
+    *detected = ALG_UNKNOWN;
+
+    // 1. Nhận diện định dạng qua "số ma thuật", không dựa vào đuôi tệp
+    unsigned char magic[4];
+    size_t got = fread(magic, 1, 4, input);
+    if (got == 4 && memcmp(magic, FRAME_MAGIC, 4) == 0) {
+        OutputSink sink;
+        memset(&sink, 0, sizeof(OutputSink));
+        sink.file = output;
+        return frame_decompress(input, output != NULL ? &sink : NULL, options, detected);
     }
-}
 
-// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+    if (got == 4 && memcmp(magic, HUFFMAN_MAGIC, 4) == 0) *detected = ALG_HUFFMAN;
+    // RLE cũ không có header: chỉ giải nén khi được chỉ định (đuôi .rle hoặc --algo rle)
+    if (*detected == ALG_UNKNOWN && algo == ALG_RLE) *detected = ALG_RLE;
+    if (*detected == ALG_UNKNOWN) {
+        fprintf(stderr, "Lỗi: Không nhận diện được định dạng tệp nén (header không hợp lệ).\n");
+        return -1;
+    }
+
+    // 2. Các định dạng cũ không có CRC: chỉ kiểm tra được bằng cách giải nén thật
+    if (output == NULL) {
+        fprintf(stderr, "Lỗi: Tệp dùng định dạng cũ không có CRC để kiểm tra; hãy dùng lệnh decompress.\n");
+        return -1;
+    }
+    if (*detected == ALG_HUFFMAN) return perform_huffman_legacy_decompress(input, output);
+    return perform_rle_decompress(input, output, magic, got);
+}
 
-static int perform_rle_compress(FILE* input, FILE* output) {
-    // Xử lý trường hợp file rỗng
-   int last_char = fgetc(input);
-    if (last_char == EOF) {
-        return 0; // File rỗng, nén thành công
+int decompress_to_memory(FILE* input, const CompressOptions* options, unsigned char** data, size_t* size) {
+    *data = NULL;
+    *size = 0;
+    char magic[4];
+    if (fread(magic, 1, 4, input) != 4 || memcmp(magic, FRAME_MAGIC, 4) != 0) {
+        fprintf(stderr, "Lỗi: Chỉ giải nén được vào bộ nhớ tệp nén dạng khung.\n");
+        return -1;
+    }
+    OutputSink sink;
+    memset(&sink, 0, sizeof(OutputSink));
+    CompressionAlgorithm detected = ALG_UNKNOWN;
+    if (frame_decompress(input, &sink, options, &detected) != 0) {
+        free(sink.data);
+        return -1;
     }
+    // Dữ liệu gốc rỗng vẫn trả về một bộ đệm hợp lệ
+    if (sink.data == NULL && (sink.data = (unsigned char*)malloc(1)) == NULL) {
+        fprintf(stderr, "Lỗi: Không đủ bộ nhớ cho dữ liệu giải nén.\n");
+        return -1;
+    }
+    *data = sink.data;
+    *size = sink.size;
+    return 0;
+}
 
-    int count = 1;
-    int current_char;
+CompressionAlgorithm choose_compression_algorithm(FILE* input) {
+    long start = ftell(input);
+    if (start < 0 || fseek(input, 0, SEEK_END) != 0) return ALG_LZH;
+    long end = ftell(input);
+    if (end < start) end = start;
+    uint64_t size = (uint64_t)(end - start);
 
-    // Vòng lặp đọc các ký tự còn lại
-    while ((current_char = fgetc(input)) != EOF) {
-        if (current_char == last_char && count < 255) {
-            // Nếu ký tự giống ký tự trước và số đếm chưa đầy 1 byte
-            count++;
-        } else {
-            // Nếu ký tự khác, hoặc đã đếm đủ 255
-            // Ghi số đếm và ký tự cũ ra file
-            fputc(count, output);
-            fputc(last_char, output);
-
-            // Reset lại cho ký tự mới
-            last_char = current_char;
-            count = 1;
+    // 1. Số mẫu tỉ lệ với kích thước tệp; tệp nhỏ được lấy mẫu toàn bộ
+    uint64_t sample_count = size / ((uint64_t)AUTO_SAMPLE_SIZE * AUTO_SAMPLE_RATIO);
+    if (sample_count < AUTO_MIN_SAMPLES) sample_count = AUTO_MIN_SAMPLES;
+    if (sample_count > AUTO_MAX_SAMPLES) sample_count = AUTO_MAX_SAMPLES;
+    if (size <= sample_count * AUTO_SAMPLE_SIZE) sample_count = (size + AUTO_SAMPLE_SIZE - 1) / AUTO_SAMPLE_SIZE;
+
+    SampleStats* stats = (SampleStats*)calloc(1, sizeof(SampleStats));
+    unsigned char* buffer = (unsigned char*)malloc(AUTO_SAMPLE_SIZE);
+    unsigned char* scratch = (unsigned char*)malloc(AUTO_SAMPLE_SIZE + AUTO_SAMPLE_SIZE / RLE_MAX_LITERAL + 1);
+    unsigned char* lzh_out = (unsigned char*)malloc(LZH_BLOCK_BOUND(AUTO_SAMPLE_SIZE));
+    void* matcher = create_matcher(NULL, AUTO_SAMPLE_SIZE, LZH_DEFAULT_LEVEL);
+    CompressionAlgorithm algo = ALG_LZH;
+    if (stats != NULL && buffer != NULL && scratch != NULL && lzh_out != NULL && matcher != NULL) {
+        for (uint64_t i = 0; i < sample_count; i++) {
+            // Mẫu đầu ở đầu tệp, mẫu cuối kết thúc ở cuối tệp, các mẫu khác cách đều ở giữa
+            uint64_t offset = sample_count > 1 && size > AUTO_SAMPLE_SIZE
+                                  ? (size - AUTO_SAMPLE_SIZE) * i / (sample_count - 1) : i * AUTO_SAMPLE_SIZE;
+            if (fseek(input, start + (long)offset, SEEK_SET) != 0) break;
+            size_t got = fread(buffer, 1, AUTO_SAMPLE_SIZE, input);
+            if (got == 0) break;
+            sample_block(stats, buffer, got, scratch, matcher, lzh_out);
         }
-    }
 
-    // GHI CẶP CUỐI CÙNG
-    fputc(count, output);
-    fputc(last_char, output);
+        // 2. Kích thước ước lượng của từng ứng viên, theo thứ tự tốc độ nén giảm dần
+        static const CompressionAlgorithm candidates[] = { ALG_RLE_BLOCK, ALG_HUFFMAN_BLOCK, ALG_LZH };
+        uint64_t estimates[3];
+        estimates[0] = stats->rle_size;
+        estimates[1] = huffman_size_estimate(stats->freq);
+        // Mỗi khối LZH thật (tới LZH_BLOCK_SIZE byte) có một bảng mã, chia đều cho các byte của tệp
+        uint64_t lzh_blocks = (size + LZH_BLOCK_SIZE - 1) / LZH_BLOCK_SIZE;
+        estimates[2] = stats->lzh_size + (size > 0 ? AUTO_LZH_TABLES_SIZE * lzh_blocks * stats->sampled / size : 0);
+        uint64_t best = estimates[0];
+        for (int i = 1; i < 3; i++) {
+            if (estimates[i] < best) best = estimates[i];
+        }
 
-    return 0;
+        // 3. Chọn thuật toán nhanh nhất giảm được ít nhất 0.5% dữ liệu và kém thuật toán tốt nhất không quá
+        // 5% (cộng 0.5% kích thước mẫu). Dữ liệu không nén được dùng Huffman theo khối: khối được lưu nguyên văn.
+        algo = ALG_HUFFMAN_BLOCK;
+        for (int i = 0; i < 3; i++) {
+            if (estimates[i] + stats->sampled / 200 < stats->sampled && estimates[i] <= best + best / 20 + stats->sampled / 200) {
+                algo = candidates[i];
+                break;
+            }
+        }
+    }
+    free(stats);
+    free(buffer);
+    free(scratch);
+    free(lzh_out);
+    if (matcher != NULL) lz77_free_state(matcher);
+
+    if (fseek(input, start, SEEK_SET) != 0) return ALG_LZH;
+    return algo;
 }
 
-static int perform_rle_decompress(FILE* input, FILE* output) {
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+static int perform_rle_decompress(FILE* input, FILE* output, const unsigned char* prefix, size_t prefix_size) {
     int count;
     int data;
+    size_t used = 0; // Các byte đầu đã được đọc khi dò "số ma thuật"
 
     // Vòng lặp đọc từng cặp byte
-    while ((count = fgetc(input)) != EOF) {
-        data = fgetc(input);
+    while ((count = used < prefix_size ? prefix[used++] : fgetc(input)) != EOF) {
+        data = used < prefix_size ? prefix[used++] : fgetc(input);
         if (data == EOF) {
             // File nén bị lỗi (thiếu byte dữ liệu)
             return -1;
@@ -119,93 +305,155 @@ static int perform_rle_decompress(FILE* input, FILE* output) {
     return 0; // Thành công
 }
 
-static int perform_huffman_compress(FILE* input, FILE* output) {
-    // 1. Đếm tần suất và lấy kích thước file
-    unsigned int freq[MAX_TREE_HT] = {0};
-    int c;
-    uint64_t original_size = 0;
-    uint8_t num_symbols = 0;
-
-    rewind(input);
-    while ((c = fgetc(input)) != EOF) {
-        if (freq[c] == 0) {
-            num_symbols++;
-        }
-        freq[c]++;
-        original_size++;
+static size_t rle_pair_bound(size_t size) {
+    return 2 * size;
+}
+
+/**
+ * @brief Mã hóa một khối thành các cặp (số lần 1..255, byte) như định dạng RLE gốc.
+ * @param dst Cần ít nhất 2 * size byte.
+ */
+static size_t rle_pair_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst) {
+    (void)state;
+    const unsigned char* p = src;
+    const unsigned char* end = src + size;
+    unsigned char* out = dst;
+    while (p < end) {
+        size_t run = 1;
+        while (run < 255 && p + run < end && p[run] == *p) run++;
+        *out++ = (unsigned char)run;
+        *out++ = *p;
+        p += run;
     }
+    return (size_t)(out - dst);
+}
 
-    // Xử lý file rỗng
-    if (original_size == 0) {
-        HuffmanHeader header;
-        memcpy(header.magic, HUFFMAN_MAGIC, 4);
-        header.num_symbols = 0;
-        header.original_size = 0;
-        fwrite(&header, sizeof(HuffmanHeader), 1, output);
-        return 0;
+static int rle_pair_decode(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size) {
+    unsigned char* out = dst;
+    unsigned char* out_end = dst + raw_size;
+    if (size % 2 != 0) return -1;
+    for (size_t i = 0; i < size; i += 2) {
+        size_t count = src[i];
+        if ((size_t)(out_end - out) < count) return -1;
+        memset(out, src[i + 1], count);
+        out += count;
+    }
+    return out == out_end ? 0 : -1;
+}
+
+/**
+ * @brief Đếm số byte liên tiếp bằng *p tính từ p (tối đa RLE_MAX_RUN, không vượt end).
+ * Bản SSE2 so sánh 16 byte với byte lặp mỗi lần và dừng ở làn khác đầu tiên.
+ */
+static size_t rle_run_length(const unsigned char* p, const unsigned char* end) {
+    const unsigned char* stop = (size_t)(end - p) > RLE_MAX_RUN ? p + RLE_MAX_RUN : end;
+    const unsigned char* q = p + 1;
+#if defined(__SSE2__)
+    const __m128i value = _mm_set1_epi8((char)*p);
+    while (stop - q >= 16) {
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)q), value));
+        if (mask != 0xFFFF) return (size_t)(q - p) + __builtin_ctz(~mask);
+        q += 16;
     }
+#endif
+    while (q < stop && *q == *p) q++;
+    return (size_t)(q - p);
+}
 
-    // 2. Xây dựng cây Huffman
-    HuffmanNode* root = build_huffman_tree(freq);
+/**
+ * @brief Tìm vị trí đầu tiên trong [p, limit) bắt đầu một đoạn lặp ít nhất RLE_MIN_RUN byte
+ * (ba byte liên tiếp bằng nhau; hai byte sau có thể nằm sau limit nhưng không vượt end).
+ * Bản SSE2 kiểm tra 16 vị trí mỗi lần bằng cách so khối với chính nó dịch đi 1 và 2 byte.
+ * @return Vị trí tìm được, hoặc limit nếu không có.
+ */
+static const unsigned char* rle_find_run(const unsigned char* p, const unsigned char* limit, const unsigned char* end) {
+#if defined(__SSE2__)
+    while (limit - p >= 16 && end - p >= 18) {
+        __m128i a = _mm_loadu_si128((const __m128i*)p);
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + 1));
+        __m128i c = _mm_loadu_si128((const __m128i*)(p + 2));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(b, c)));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    for (; p < limit && end - p >= RLE_MIN_RUN; p++) {
+        if (p[0] == p[1] && p[1] == p[2]) return p;
+    }
+    return limit;
+}
 
-    // 3. Tạo bảng mã
-    char* codes[MAX_TREE_HT] = {NULL};
-    int arr[MAX_TREE_HT], top = 0;
-    generate_codes_recursive(root, arr, top, codes);
+/**
+ * @brief Mã hóa một khối: xen kẽ đoạn lặp (>= RLE_MIN_RUN byte) và đoạn literal (<= RLE_MAX_LITERAL byte).
+ * @param dst Bộ đệm đích, cần ít nhất size + size / RLE_MAX_LITERAL + 1 byte.
+ * @return Số byte đã ghi vào dst.
+ */
+static size_t rle_block_encode(const unsigned char* src, size_t size, unsigned char* dst) {
+    const unsigned char* p = src;
+    const unsigned char* end = src + size;
+    unsigned char* out = dst;
 
-    // 4. Ghi header đã tối ưu
-    HuffmanHeader header;
-    memcpy(header.magic, HUFFMAN_MAGIC, 4);
-    header.num_symbols = num_symbols;
-    header.original_size = original_size;
-    fwrite(&header, sizeof(HuffmanHeader), 1, output);
-
-    // Ghi bảng tần suất rút gọn
-    for (int i = 0; i < MAX_TREE_HT; i++) {
-        if (freq[i] > 0) {
-            SymbolFreq sf = {(uint8_t)i, freq[i]};
-            fwrite(&sf, sizeof(SymbolFreq), 1, output);
+    while (p < end) {
+        size_t run = rle_run_length(p, end);
+        if (run >= RLE_MIN_RUN) {
+            *out++ = (unsigned char)(128 + run - RLE_MIN_RUN);
+            *out++ = *p;
+            p += run;
+            continue;
         }
+        // Literal kéo dài đến đoạn lặp tiếp theo (hoặc đủ RLE_MAX_LITERAL byte)
+        const unsigned char* limit = (size_t)(end - p) > RLE_MAX_LITERAL ? p + RLE_MAX_LITERAL : end;
+        const unsigned char* literal_end = rle_find_run(p + 1, limit, end);
+        size_t length = (size_t)(literal_end - p);
+        *out++ = (unsigned char)(length - 1);
+        memcpy(out, p, length);
+        out += length;
+        p = literal_end;
     }
+    return (size_t)(out - dst);
+}
 
-    // 5. Nén và ghi body
-    rewind(input);
-    unsigned char byte_buffer = 0;
-    int bit_count = 0;
-    while ((c = fgetc(input)) != EOF) {
-        char* code = codes[c];
-        for (int i = 0; code[i] != '\0'; i++) {
-            byte_buffer <<= 1;
-            if (code[i] == '1') {
-                byte_buffer |= 1;
-            }
-            bit_count++;
-            if (bit_count == 8) {
-                fputc(byte_buffer, output);
-                bit_count = 0;
-                byte_buffer = 0;
-            }
+/**
+ * @brief Giải mã một khối bằng memcpy (literal) và memset (đoạn lặp).
+ * @return 0 nếu dữ liệu mã hóa sinh ra đúng raw_size byte, -1 nếu bị hỏng.
+ */
+static int rle_block_decode(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size) {
+    const unsigned char* in = src;
+    const unsigned char* in_end = src + size;
+    unsigned char* out = dst;
+    unsigned char* out_end = dst + raw_size;
+
+    while (in < in_end) {
+        unsigned int control = *in++;
+        if (control < 128) {
+            size_t length = control + 1;
+            if ((size_t)(in_end - in) < length || (size_t)(out_end - out) < length) return -1;
+            memcpy(out, in, length);
+            in += length;
+            out += length;
+        } else {
+            size_t length = control - 128 + RLE_MIN_RUN;
+            if (in == in_end || (size_t)(out_end - out) < length) return -1;
+            memset(out, *in++, length);
+            out += length;
         }
     }
-    // Ghi các bit còn lại nếu có
-    if (bit_count > 0) {
-        byte_buffer <<= (8 - bit_count);
-        fputc(byte_buffer, output);
-    }
+    return out == out_end ? 0 : -1;
+}
 
-    // 6. Dọn dẹp
-    free_huffman_tree(root);
-    for(int i=0; i < MAX_TREE_HT; i++) {
-        free(codes[i]);
-    }
-    return 0;
+static size_t rle_block_bound(size_t size) {
+    return size + size / RLE_MAX_LITERAL + 1;
+}
+
+static size_t rle_block_codec_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst) {
+    (void)state;
+    return rle_block_encode(src, size, dst);
 }
 
-static int perform_huffman_decompress(FILE* input, FILE* output) {
-    // 1. Đọc và xác thực header
+static int perform_huffman_legacy_decompress(FILE* input, FILE* output) {
+    // 1. Đọc phần còn lại của header (sau "số ma thuật")
     HuffmanHeader header;
-    size_t read_bytes = fread(&header, sizeof(HuffmanHeader), 1, input);
-    if (read_bytes < 1 || memcmp(header.magic, HUFFMAN_MAGIC, 4) != 0) {
+    if (fread((char*)&header + 4, sizeof(HuffmanHeader) - 4, 1, input) < 1) {
         fprintf(stderr, "Lỗi: File không phải là định dạng Huffman hợp lệ hoặc header bị hỏng.\n");
         return -1;
     }
@@ -215,9 +463,11 @@ static int perform_huffman_decompress(FILE* input, FILE* output) {
         return 0;
     }
 
-    // 2. Đọc bảng tần suất rút gọn và xây dựng lại bảng đầy đủ
+    // 2. Đọc bảng tần suất rút gọn và xây dựng lại bảng đầy đủ.
+    // Bộ nén cũ ghi num_symbols = 0 khi đủ cả 256 ký hiệu (tràn uint8_t) nhưng vẫn ghi đủ 256 mục.
+    int num_symbols = header.num_symbols != 0 ? header.num_symbols : MAX_TREE_HT;
     unsigned int freq[MAX_TREE_HT] = {0};
-    for (int i = 0; i < header.num_symbols; i++) {
+    for (int i = 0; i < num_symbols; i++) {
         SymbolFreq sf;
         if (fread(&sf, sizeof(SymbolFreq), 1, input) < 1) {
             fprintf(stderr, "Lỗi: File nén bị hỏng khi đang đọc bảng tần suất.\n");
@@ -226,160 +476,896 @@ static int perform_huffman_decompress(FILE* input, FILE* output) {
         freq[sf.symbol] = sf.frequency;
     }
 
-    // 3. Tái tạo cây Huffman
-    HuffmanNode* root = build_huffman_tree(freq);
-    HuffmanNode* current = root;
+    // 3. Tái tạo cây Huffman và dựng bảng giải mã từ cây
+    HuffmanDecoder dec;
+    if (huffman_decoder_from_frequencies(&dec, freq) != 0) {
+        fprintf(stderr, "Lỗi: Không dựng được bảng giải mã Huffman.\n");
+        return -1;
+    }
 
     // 4. Giải nén body
-    int c;
-    uint64_t decoded_count = 0;
-    while (decoded_count < header.original_size && (c = fgetc(input)) != EOF) {
-        for (int i = 7; i >= 0; i--) {
-            int bit = (c >> i) & 1;
-            if (bit) {
-                current = current->right;
-            } else {
-                current = current->left;
+    int result = huffman_decode_stream(input, output, &dec, header.original_size);
+    huffman_decoder_free(&dec);
+    if (result != 0) {
+        fprintf(stderr, "Lỗi: Dữ liệu giải nén bị hỏng hoặc không đầy đủ.\n");
+        return -1;
+    }
+    return 0;
+}
+
+// --- KHUNG CHUNG VÀ ĐỊNH DẠNG THEO KHỐI ---
+
+// Một khối trong đợt xử lý: dữ liệu gốc, dữ liệu mã hóa và header của nó
+struct BlockSlot {
+    unsigned char* raw;
+    unsigned char* encoded;
+    FrameBlockHeader header;
+    uint32_t line_count; // Số '\n' trong dữ liệu gốc (chỉ khi BlockBatch.count_lines)
+    int status;
+};
+
+// Mỗi đợt đọc tối đa slot_count khối, xử lý song song rồi ghi theo đúng thứ tự chỉ số:
+// các slot đóng vai trò bộ đệm sắp xếp lại, nên bộ nhớ bị chặn bởi slot_count * 2 * block_size
+struct BlockBatch {
+    const BlockCodec* codec;
+    BlockSlot* slots;
+    int slot_count;
+    size_t block_size;
+    int use_crc;      // Tính (khi nén) hoặc kiểm tra (khi giải nén) CRC32C của từng khối
+    int count_lines;  // Đếm '\n' của từng khối cho bảng tra vị trí
+    ThreadPool* pool; // NULL nếu chạy một luồng
+    void** states;    // Trạng thái bộ mã của từng luồng (chỉ khi nén)
+    int state_count;
+};
+
+/**
+ * @brief Bộ mã khối dùng trong khung cho từng thuật toán.
+ * @return NULL nếu thuật toán không có bộ mã (ALG_AUTO, ALG_UNKNOWN hoặc giá trị lạ trong header).
+ */
+static const BlockCodec* frame_codec(CompressionAlgorithm algo) {
+    switch (algo) {
+        case ALG_RLE:
+            return &rle_codec;
+        case ALG_RLE_BLOCK:
+            return &rle_block_codec;
+        // 'huffman' và 'huffb' dùng chung khối Huffman 4 luồng; header vẫn ghi thuật toán người dùng chọn
+        case ALG_HUFFMAN:
+        case ALG_HUFFMAN_BLOCK:
+            return &huffman_block_codec;
+        case ALG_LZ77:
+            return &lz77_block_codec;
+        case ALG_LZH:
+            return &lzh_block_codec;
+        default:
+            return NULL;
+    }
+}
+
+static int frame_compress(FILE* input, FILE* output, CompressionAlgorithm algo, const CompressOptions* options) {
+    const BlockCodec* codec = frame_codec(algo);
+    BlockBatch batch;
+    if (block_batch_init(&batch, codec, codec->block_size, options, 1) != 0) {
+        fprintf(stderr, "Lỗi: Không đủ bộ nhớ để nén.\n");
+        return -1;
+    }
+    batch.use_crc = 1;
+    batch.count_lines = options != NULL && options->seekable;
+
+    int result = 0;
+    // Bảng tra vị trí được giữ trong bộ nhớ ở dạng đã mã hóa tới khi ghi xong khối cuối
+    unsigned char* table = NULL;
+    size_t table_count = 0;
+    size_t table_capacity = 0;
+    FrameHeader header;
+    memset(&header, 0, sizeof(FrameHeader));
+    memcpy(header.magic, FRAME_MAGIC, 4);
+    header.version = FRAME_VERSION;
+    header.codec = (uint8_t)algo;
+    header.flags = FRAME_FLAG_BLOCK_CRC;
+    if (batch.count_lines) header.flags |= FRAME_FLAG_SEEK_TABLE;
+    header.block_size = (uint32_t)batch.block_size;
+    header.original_size = 0;
+    // Kích thước gốc chỉ biết trước khi đầu vào tua lại được (không phải pipe, stdin)
+    long start = ftell(input);
+    if (start >= 0 && fseek(input, 0, SEEK_END) == 0) {
+        long end = ftell(input);
+        if (fseek(input, start, SEEK_SET) != 0) {
+            result = -1;
+        } else if (end >= start) {
+            header.original_size = (uint64_t)(end - start);
+            header.flags |= FRAME_FLAG_SIZE_KNOWN;
+        }
+    }
+    long header_pos = ftell(output);
+    if (result == 0 && write_frame_header(output, &header) != 0) result = -1;
+
+    uint64_t total = 0;
+    int at_end = 0;
+    while (result == 0 && !at_end) {
+        // fread chỉ trả về ít hơn yêu cầu khi gặp EOF hoặc lỗi
+        int count = 0;
+        while (count < batch.slot_count) {
+            BlockSlot* slot = &batch.slots[count];
+            size_t got = fread(slot->raw, 1, batch.block_size, input);
+            if (got > 0) {
+                slot->header.raw_size = (uint32_t)got;
+                count++;
             }
+            if (got < batch.block_size) {
+                at_end = 1;
+                break;
+            }
+        }
+        block_batch_run(&batch, count, block_compress_task);
 
-            // Nếu là node lá, ghi ký tự và quay về gốc
-            if (current->left == NULL && current->right == NULL) {
-                fputc(current->data, output);
-                decoded_count++;
-                if (decoded_count == header.original_size) break;
-                current = root;
+        for (int i = 0; i < count && result == 0; i++) {
+            const BlockSlot* slot = &batch.slots[i];
+            const unsigned char* data = slot->header.stored ? slot->raw : slot->encoded;
+            if (write_frame_block_header(output, &slot->header) != 0 ||
+                fwrite(data, 1, slot->header.encoded_size, output) != slot->header.encoded_size) {
+                result = -1;
+            }
+            total += slot->header.raw_size;
+            if (batch.count_lines) {
+                if (table_count == table_capacity) {
+                    size_t capacity = table_capacity ? table_capacity * 2 : 256;
+                    unsigned char* grown = (unsigned char*)realloc(table, capacity * SEEK_TABLE_ENTRY_SIZE);
+                    if (grown == NULL) {
+                        fprintf(stderr, "Lỗi: Không đủ bộ nhớ cho bảng tra vị trí.\n");
+                        result = -1;
+                        break;
+                    }
+                    table = grown;
+                    table_capacity = capacity;
+                }
+                write_seek_table_entry(table + table_count++ * SEEK_TABLE_ENTRY_SIZE, slot);
             }
         }
     }
+    if (ferror(input) || ferror(output)) result = -1;
 
-    // 5. Dọn dẹp
-    free_huffman_tree(root);
-    
-    // Kiểm tra xem số lượng ký tự đã giải nén có khớp không
-    if (decoded_count != header.original_size) {
-        fprintf(stderr, "Lỗi: Dữ liệu giải nén bị hỏng hoặc không đầy đủ.\n");
+    // Khối kết thúc: thiếu khối này khi giải nén nghĩa là tệp bị cắt cụt
+    if (result == 0) {
+        FrameBlockHeader end_marker;
+        memset(&end_marker, 0, sizeof(FrameBlockHeader));
+        if (write_frame_block_header(output, &end_marker) != 0) result = -1;
+    }
+
+    // Bảng tra vị trí và footer nằm cuối tệp, nên seekable_open tìm được chúng bằng một lần tua từ cuối
+    if (result == 0 && batch.count_lines) {
+        unsigned char footer[SEEK_TABLE_FOOTER_SIZE];
+        write_le32(footer, (uint32_t)table_count);
+        write_le32(footer + 4, crc32c_update(0, table, table_count * SEEK_TABLE_ENTRY_SIZE));
+        memcpy(footer + 8, SEEK_TABLE_MAGIC, 4);
+        if (table_count > UINT32_MAX ||
+            fwrite(table, SEEK_TABLE_ENTRY_SIZE, table_count, output) != table_count ||
+            fwrite(footer, 1, SEEK_TABLE_FOOTER_SIZE, output) != SEEK_TABLE_FOOTER_SIZE) {
+            result = -1;
+        }
+    }
+    free(table);
+
+    // Tệp đầu vào thay đổi trong khi nén (ví dụ log đang được ghi thêm): sửa kích thước trong header
+    if (result == 0 && (header.flags & FRAME_FLAG_SIZE_KNOWN) && total != header.original_size) {
+        long end_pos = ftell(output);
+        header.original_size = total;
+        if (header_pos < 0 || end_pos < 0 || fseek(output, header_pos, SEEK_SET) != 0 ||
+            write_frame_header(output, &header) != 0 || fseek(output, end_pos, SEEK_SET) != 0) {
+            fprintf(stderr, "Lỗi: Tệp đầu vào thay đổi kích thước trong khi nén.\n");
+            result = -1;
+        }
+    }
+
+    block_batch_free(&batch);
+    return result;
+}
+
+/**
+ * @brief Giải nén (hoặc chỉ kiểm tra, khi output = NULL) phần sau "số ma thuật" của khung chung.
+ */
+static int frame_decompress(FILE* input, OutputSink* output, const CompressOptions* options, CompressionAlgorithm* detected) {
+    FrameHeader header;
+    const BlockCodec* codec = NULL;
+    if (read_frame_header(input, &header) == 0 && header.version == FRAME_VERSION &&
+        (header.flags & ~FRAME_KNOWN_FLAGS) == 0 && header.block_size > 0 && header.block_size <= BLOCK_MAX_SIZE) {
+        codec = frame_codec((CompressionAlgorithm)header.codec);
+    }
+    if (codec == NULL) {
+        fprintf(stderr, "Lỗi: Phiên bản khung nén không được hỗ trợ hoặc header bị hỏng.\n");
+        return -1;
+    }
+    *detected = (CompressionAlgorithm)header.codec;
+    return block_decompress_loop(input, output, codec, &header, options);
+}
+
+/**
+ * @brief Giải nén các khối theo sau header của khung tới khối kết thúc, đối chiếu CRC và kích thước gốc.
+ * output = NULL thì chỉ giải mã và kiểm tra.
+ */
+static int block_decompress_loop(FILE* input, OutputSink* output, const BlockCodec* codec, const FrameHeader* frame,
+                                 const CompressOptions* options) {
+    BlockBatch batch;
+    if (block_batch_init(&batch, codec, frame->block_size, options, 0) != 0) {
+        fprintf(stderr, "Lỗi: Không đủ bộ nhớ để giải nén.\n");
         return -1;
     }
+    batch.use_crc = (frame->flags & FRAME_FLAG_BLOCK_CRC) != 0;
+    // Bảng tra vị trí được dựng lại từ các khối để đối chiếu với bảng ghi ở cuối tệp
+    batch.count_lines = (frame->flags & FRAME_FLAG_SEEK_TABLE) != 0;
+
+    int result = 0;
+    int reported = 0; // Đã in thông báo lỗi cụ thể
+    int at_end = 0;
+    uint64_t total = 0; // Số byte gốc của các khối đã xử lý
+    uint64_t index = 0; // Chỉ số của khối đầu tiên trong đợt
+    uint32_t table_crc = 0;
+    while (result == 0 && !at_end) {
+        int count = 0;
+        while (count < batch.slot_count) {
+            int status = read_block(input, &batch, &batch.slots[count]);
+            if (status <= 0) {
+                if (status < 0) result = -1;
+                at_end = 1;
+                break;
+            }
+            count++;
+        }
+        // Các khối đã đọc đủ trước chỗ hỏng vẫn được giải nén và ghi ra
+        block_batch_run(&batch, count, block_decompress_task);
+
+        for (int i = 0; i < count; i++) {
+            const BlockSlot* slot = &batch.slots[i];
+            if (slot->status != 0) {
+                report_block_error(slot, index + i, total);
+                result = -1;
+                reported = 1;
+                break;
+            }
+            if (output != NULL && sink_write(output, slot->raw, slot->header.raw_size) != 0) {
+                result = -1;
+                reported = 1;
+                break;
+            }
+            total += slot->header.raw_size;
+            if (batch.count_lines) {
+                unsigned char entry[SEEK_TABLE_ENTRY_SIZE];
+                write_seek_table_entry(entry, slot);
+                table_crc = crc32c_update(table_crc, entry, SEEK_TABLE_ENTRY_SIZE);
+            }
+        }
+        index += (uint64_t)count;
+    }
+    if (result == 0 && batch.count_lines && check_seek_table(input, (uint32_t)index, table_crc) != 0) {
+        fprintf(stderr, "Lỗi: Bảng tra vị trí ở cuối tệp không khớp với các khối: tệp bị hỏng.\n");
+        result = -1;
+        reported = 1;
+    }
 
+    if (result == 0 && (frame->flags & FRAME_FLAG_SIZE_KNOWN) && total != frame->original_size) {
+        fprintf(stderr, "Lỗi: Dữ liệu giải nén có %llu byte, khác kích thước gốc ghi trong header (%llu byte).\n",
+                (unsigned long long)total, (unsigned long long)frame->original_size);
+        result = -1;
+        reported = 1;
+    }
+    if (result != 0 && !reported) {
+        fprintf(stderr, feof(input) ? "Lỗi: Tệp nén bị cắt cụt (thiếu dữ liệu sau byte gốc %llu).\n"
+                                    : "Lỗi: Dữ liệu giải nén bị hỏng hoặc không đầy đủ (sau byte gốc %llu).\n",
+                (unsigned long long)total);
+    }
+    if (ferror(input) || (output != NULL && output->file != NULL && ferror(output->file))) result = -1;
+
+    block_batch_free(&batch);
+    return result;
+}
+
+/**
+ * @brief Ghi dữ liệu giải nén ra tệp của sink, hoặc nối vào bộ đệm của nó (khi file = NULL).
+ * Bộ đệm được nới gấp đôi khi đầy và luôn dư ít nhất 1 byte sau dữ liệu.
+ * @return 0 nếu thành công, -1 nếu ghi tệp lỗi hoặc không đủ bộ nhớ (đã in lỗi).
+ */
+static int sink_write(OutputSink* sink, const unsigned char* data, size_t size) {
+    if (sink->file != NULL) return fwrite(data, 1, size, sink->file) == size ? 0 : -1;
+    if (size >= sink->capacity - sink->size || sink->data == NULL) {
+        if (size > SIZE_MAX / 2 - sink->size) {
+            fprintf(stderr, "Lỗi: Dữ liệu giải nén quá lớn để giữ trong bộ nhớ.\n");
+            return -1;
+        }
+        size_t capacity = sink->capacity > 0 ? sink->capacity : OUTPUT_SINK_INITIAL_SIZE;
+        while (capacity <= sink->size + size) capacity *= 2;
+        unsigned char* grown = (unsigned char*)realloc(sink->data, capacity);
+        if (grown == NULL) {
+            fprintf(stderr, "Lỗi: Không đủ bộ nhớ cho dữ liệu giải nén.\n");
+            return -1;
+        }
+        sink->data = grown;
+        sink->capacity = capacity;
+    }
+    if (size > 0) memcpy(sink->data + sink->size, data, size);
+    sink->size += size;
+    return 0;
+}
+
+/**
+ * @brief Đọc header của khối kế tiếp trong khung.
+ * @return 1 nếu có khối, 0 nếu gặp khối kết thúc, -1 nếu header bị cắt cụt hoặc hỏng.
+ */
+static int read_block_header(FILE* input, FrameBlockHeader* header) {
+    // Khung luôn có khối kết thúc: hết tệp trước nó nghĩa là tệp bị cắt cụt
+    unsigned char bytes[FRAME_BLOCK_HEADER_SIZE];
+    if (fread(bytes, 1, FRAME_BLOCK_HEADER_SIZE, input) != FRAME_BLOCK_HEADER_SIZE) return -1;
+    header->raw_size = read_le32(bytes);
+    header->encoded_size = read_le32(bytes + 4);
+    header->stored = bytes[8];
+    header->crc = read_le32(bytes + 9);
+    if (header->raw_size != 0) return 1;
+    return header->encoded_size == 0 && header->stored == 0 && header->crc == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Ghi FrameHeader theo bố cục trên đĩa (FRAME_HEADER_SIZE byte, little-endian).
+ * @return 0 nếu thành công, -1 nếu ghi lỗi.
+ */
+static int write_frame_header(FILE* output, const FrameHeader* header) {
+    unsigned char bytes[FRAME_HEADER_SIZE];
+    memcpy(bytes, header->magic, 4);
+    bytes[4] = header->version;
+    bytes[5] = header->codec;
+    bytes[6] = header->flags;
+    write_le32(bytes + 7, header->block_size);
+    write_le64(bytes + 11, header->original_size);
+    return fwrite(bytes, 1, FRAME_HEADER_SIZE, output) == FRAME_HEADER_SIZE ? 0 : -1;
+}
+
+/**
+ * @brief Đọc phần còn lại của FrameHeader sau "số ma thuật" (đã được decompress_file đọc).
+ * @return 0 nếu đọc đủ, -1 nếu tệp bị cắt cụt.
+ */
+static int read_frame_header(FILE* input, FrameHeader* header) {
+    unsigned char bytes[FRAME_HEADER_SIZE];
+    if (fread(bytes + 4, 1, FRAME_HEADER_SIZE - 4, input) != FRAME_HEADER_SIZE - 4) return -1;
+    memcpy(header->magic, FRAME_MAGIC, 4);
+    header->version = bytes[4];
+    header->codec = bytes[5];
+    header->flags = bytes[6];
+    header->block_size = read_le32(bytes + 7);
+    header->original_size = read_le64(bytes + 11);
     return 0;
 }
 
-HuffmanNode* create_node(unsigned char data, unsigned int freq) {
-    HuffmanNode* node = (HuffmanNode*)malloc(sizeof(HuffmanNode));
-    node->left = node->right = NULL;
-    node->data = data;
-    node->freq = freq;
-    return node;
+static int write_frame_block_header(FILE* output, const FrameBlockHeader* header) {
+    unsigned char bytes[FRAME_BLOCK_HEADER_SIZE];
+    write_le32(bytes, header->raw_size);
+    write_le32(bytes + 4, header->encoded_size);
+    bytes[8] = header->stored;
+    write_le32(bytes + 9, header->crc);
+    return fwrite(bytes, 1, FRAME_BLOCK_HEADER_SIZE, output) == FRAME_BLOCK_HEADER_SIZE ? 0 : -1;
 }
 
-MinHeap* create_min_heap(unsigned int capacity) {
-    MinHeap* minHeap = (MinHeap*)malloc(sizeof(MinHeap));
-    minHeap->size = 0;
-    minHeap->capacity = capacity;
-    minHeap->array = (HuffmanNode**)malloc(minHeap->capacity * sizeof(HuffmanNode*));
-    return minHeap;
+static void write_le32(unsigned char* p, uint32_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
 }
 
-void swap_nodes(HuffmanNode** a, HuffmanNode** b) {
-    HuffmanNode* t = *a;
-    *a = *b;
-    *b = t;
+static void write_le64(unsigned char* p, uint64_t value) {
+    write_le32(p, (uint32_t)value);
+    write_le32(p + 4, (uint32_t)(value >> 32));
 }
 
-void min_heapify(MinHeap* minHeap, int idx) {
-    int smallest = idx;
-    unsigned int left = 2 * idx + 1;
-    unsigned int right = 2 * idx + 2;
-    // Kiểm tra khoảng bên trái và phải có vượt quá kích thước không và so sánh tần số
-    // của các node con với node hiện tại
-    if (left < minHeap->size && minHeap->array[left]->freq < minHeap->array[smallest]->freq)
-        smallest = left;
-    if (right < minHeap->size && minHeap->array[right]->freq < minHeap->array[smallest]->freq)
-        smallest = right;
+static uint32_t read_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t read_le64(const unsigned char* p) {
+    return (uint64_t)read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+}
 
-    // Nếu node hiện tại không phải là nhỏ nhất, hoán đổi và tiếp tục heapify
-    if (smallest != idx) {
-        swap_nodes(&minHeap->array[smallest], &minHeap->array[idx]);
-        min_heapify(minHeap, smallest);
+/**
+ * @brief Đọc header và dữ liệu mã hóa của khối kế tiếp vào slot, kiểm tra các kích thước trong header.
+ * @return 1 nếu đọc được khối, 0 nếu hết khối, -1 nếu tệp bị cắt cụt hoặc header hỏng.
+ */
+static int read_block(FILE* input, const BlockBatch* batch, BlockSlot* slot) {
+    FrameBlockHeader* header = &slot->header;
+    int status = read_block_header(input, header);
+    if (status <= 0) return status;
+    // Khối lưu nguyên văn được đọc thẳng vào bộ đệm dữ liệu gốc
+    unsigned char* dst = header->stored ? slot->raw : slot->encoded;
+    if (header->raw_size == 0 || header->raw_size > batch->block_size ||
+        header->stored > 1 || (header->stored && header->encoded_size != header->raw_size) ||
+        header->encoded_size > batch->codec->bound(batch->block_size) ||
+        fread(dst, 1, header->encoded_size, input) != header->encoded_size) {
+        return -1;
     }
+    return 1;
 }
 
-HuffmanNode* extract_min(MinHeap* minHeap) {
-    HuffmanNode* temp = minHeap->array[0];
-    minHeap->array[0] = minHeap->array[minHeap->size - 1];
-    --minHeap->size;
-    min_heapify(minHeap, 0);
-    return temp;
+/**
+ * @brief In lỗi của một khối giải mã hỏng; offset là byte gốc đầu tiên của khối.
+ */
+static void report_block_error(const BlockSlot* slot, uint64_t index, uint64_t offset) {
+    fprintf(stderr, slot->status == BLOCK_CRC_MISMATCH
+                        ? "Lỗi: CRC32C của khối %llu (byte gốc %llu..%llu) không khớp: dữ liệu bị hỏng.\n"
+                        : "Lỗi: Không giải mã được khối %llu (byte gốc %llu..%llu): dữ liệu bị hỏng.\n",
+            (unsigned long long)index, (unsigned long long)offset,
+            (unsigned long long)(offset + slot->header.raw_size - 1));
 }
 
-void insert_node(MinHeap* minHeap, HuffmanNode* node) {
-    ++minHeap->size;
-    int i = minHeap->size - 1;
-    while (i && node->freq < minHeap->array[(i - 1) / 2]->freq) {
-        minHeap->array[i] = minHeap->array[(i - 1) / 2];
-        i = (i - 1) / 2;
+/**
+ * @brief Ghi mục bảng tra vị trí của một khối theo bố cục trên đĩa (SEEK_TABLE_ENTRY_SIZE byte, little-endian).
+ */
+static void write_seek_table_entry(unsigned char* p, const BlockSlot* slot) {
+    write_le32(p, FRAME_BLOCK_HEADER_SIZE + slot->header.encoded_size);
+    write_le32(p + 4, slot->header.raw_size);
+    write_le32(p + 8, slot->line_count);
+}
+
+static void read_seek_table_entry(const unsigned char* p, SeekTableEntry* entry) {
+    entry->frame_size = read_le32(p);
+    entry->raw_size = read_le32(p + 4);
+    entry->line_count = read_le32(p + 8);
+}
+
+/**
+ * @brief Đọc SeekTableFooter tại vị trí hiện tại của input.
+ * @return 0 nếu đọc đủ và đúng "số ma thuật", -1 nếu không.
+ */
+static int read_seek_table_footer(FILE* input, SeekTableFooter* footer) {
+    unsigned char bytes[SEEK_TABLE_FOOTER_SIZE];
+    if (fread(bytes, 1, SEEK_TABLE_FOOTER_SIZE, input) != SEEK_TABLE_FOOTER_SIZE) return -1;
+    footer->entry_count = read_le32(bytes);
+    footer->crc = read_le32(bytes + 4);
+    memcpy(footer->magic, bytes + 8, 4);
+    return memcmp(footer->magic, SEEK_TABLE_MAGIC, 4) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Đọc bảng tra vị trí sau khối kết thúc và đối chiếu với bảng dựng lại khi giải nén.
+ * @param crc CRC32C của các SeekTableEntry dựng lại từ entry_count khối đã giải nén.
+ * @return 0 nếu khớp, -1 nếu không.
+ */
+static int check_seek_table(FILE* input, uint32_t entry_count, uint32_t crc) {
+    unsigned char entries[256 * SEEK_TABLE_ENTRY_SIZE];
+    uint32_t stored_crc = 0;
+    uint32_t remaining = entry_count;
+    while (remaining > 0) {
+        uint32_t n = remaining < 256 ? remaining : 256;
+        if (fread(entries, SEEK_TABLE_ENTRY_SIZE, n, input) != n) return -1;
+        stored_crc = crc32c_update(stored_crc, entries, n * SEEK_TABLE_ENTRY_SIZE);
+        remaining -= n;
+    }
+    SeekTableFooter footer;
+    if (read_seek_table_footer(input, &footer) != 0 ||
+        footer.entry_count != entry_count || footer.crc != crc || stored_crc != crc) {
+        return -1;
     }
-    minHeap->array[i] = node;
+    return 0;
 }
 
-HuffmanNode* build_huffman_tree(unsigned int freq[]) {
-    MinHeap* minHeap = create_min_heap(MAX_TREE_HT);
-    for (int i = 0; i < MAX_TREE_HT; ++i) {
-        if (freq[i]) {
-            insert_node(minHeap, create_node(i, freq[i]));
+/**
+ * @brief Cấp phát các slot, nhóm luồng (khi dùng nhiều hơn một luồng) và trạng thái bộ mã khi nén.
+ * Số slot gấp đôi số luồng để luồng xong sớm có khối tiếp theo mà không phải chờ đợt sau.
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ.
+ */
+static int block_batch_init(BlockBatch* batch, const BlockCodec* codec, size_t block_size, const CompressOptions* options, int compressing) {
+    int num_threads = options != NULL ? options->num_threads : 0;
+    if (num_threads <= 0) num_threads = get_cpu_count();
+
+    // Chọn cài đặt CRC32C trước khi các luồng dùng tới
+    crc32c_init();
+    memset(batch, 0, sizeof(BlockBatch));
+    batch->codec = codec;
+    batch->block_size = block_size;
+    if (num_threads > 1) {
+        batch->pool = threadpool_create(num_threads);
+        if (batch->pool != NULL) num_threads = threadpool_size(batch->pool);
+        else num_threads = 1;
+    }
+    batch->slot_count = num_threads > 1 ? num_threads * 2 : 1;
+
+    batch->slots = (BlockSlot*)calloc(batch->slot_count, sizeof(BlockSlot));
+    if (batch->slots == NULL) {
+        block_batch_free(batch);
+        return -1;
+    }
+    for (int i = 0; i < batch->slot_count; i++) {
+        batch->slots[i].raw = (unsigned char*)malloc(block_size);
+        batch->slots[i].encoded = (unsigned char*)malloc(codec->bound(block_size));
+        if (batch->slots[i].raw == NULL || batch->slots[i].encoded == NULL) {
+            block_batch_free(batch);
+            return -1;
+        }
+    }
+
+    if (compressing && codec->create_state != NULL) {
+        batch->states = (void**)calloc(num_threads, sizeof(void*));
+        if (batch->states == NULL) {
+            block_batch_free(batch);
+            return -1;
+        }
+        batch->state_count = num_threads;
+        for (int i = 0; i < num_threads; i++) {
+            batch->states[i] = codec->create_state(options, block_size);
+            if (batch->states[i] == NULL) {
+                block_batch_free(batch);
+                return -1;
+            }
         }
     }
+    return 0;
+}
 
-    // Trường hợp đặc biệt: chỉ có 1 ký tự duy nhất
-    if (minHeap->size == 1) {
-        HuffmanNode* single_node = extract_min(minHeap);
-        // Tạo một root giả với node đó làm con trái
-        HuffmanNode* root = create_node('$', single_node->freq);
-        root->left = single_node;
-        root->right = NULL;
-        free(minHeap->array);
-        free(minHeap);
-        return root;
-    }
-
-    while (minHeap->size > 1) {
-        HuffmanNode* left = extract_min(minHeap);
-        HuffmanNode* right = extract_min(minHeap);
-        
-        // Tạo node nội, data có thể là ký tự đặc biệt như '$'
-        HuffmanNode* top = create_node('$', left->freq + right->freq);
-        top->left = left;
-        top->right = right;
-        insert_node(minHeap, top);
-    }
-    
-    HuffmanNode* root = extract_min(minHeap);
-    free(minHeap->array);
-    free(minHeap);
-    return root;
-}
-
-void generate_codes_recursive(HuffmanNode* root, int arr[], int top, char** codes) {
-    if (root->left) {
-        arr[top] = 0;
-        generate_codes_recursive(root->left, arr, top + 1, codes);
-    }
-    if (root->right) {
-        arr[top] = 1;
-        generate_codes_recursive(root->right, arr, top + 1, codes);
-    }
-    if (!(root->left) && !(root->right)) { // Nếu là node lá
-        codes[root->data] = (char*)malloc(top + 1);
-        for (int i = 0; i < top; ++i) {
-            codes[root->data][i] = arr[i] + '0';
+static void block_batch_free(BlockBatch* batch) {
+    if (batch->slots != NULL) {
+        for (int i = 0; i < batch->slot_count; i++) {
+            free(batch->slots[i].raw);
+            free(batch->slots[i].encoded);
+        }
+        free(batch->slots);
+    }
+    if (batch->states != NULL) {
+        for (int i = 0; i < batch->state_count; i++) {
+            if (batch->states[i] != NULL) batch->codec->free_state(batch->states[i]);
         }
-        codes[root->data][top] = '\0';
+        free(batch->states);
+    }
+    if (batch->pool != NULL) threadpool_destroy(batch->pool);
+    memset(batch, 0, sizeof(BlockBatch));
+}
+
+static void block_batch_run(BlockBatch* batch, int count, ThreadPoolTask task) {
+    if (count == 0) return;
+    if (batch->pool != NULL && count > 1) {
+        threadpool_run(batch->pool, count, task, batch);
+    } else {
+        for (int i = 0; i < count; i++) task(batch, i, 0);
+    }
+}
+
+/**
+ * @brief Nén một khối; khối không nhỏ đi (dữ liệu ngẫu nhiên) được lưu nguyên văn.
+ */
+static void block_compress_task(void* context, int index, int worker) {
+    BlockBatch* batch = (BlockBatch*)context;
+    BlockSlot* slot = &batch->slots[index];
+    void* state = batch->states != NULL ? batch->states[worker] : NULL;
+    size_t size = batch->codec->encode(state, slot->raw, slot->header.raw_size, slot->encoded);
+    slot->header.stored = size >= slot->header.raw_size;
+    slot->header.encoded_size = slot->header.stored ? slot->header.raw_size : (uint32_t)size;
+    slot->header.crc = batch->use_crc ? crc32c_update(0, slot->raw, slot->header.raw_size) : 0;
+    slot->line_count = batch->count_lines ? (uint32_t)count_newlines((const char*)slot->raw,
+                                                                     (const char*)slot->raw + slot->header.raw_size) : 0;
+    slot->status = 0;
+}
+
+static void block_decompress_task(void* context, int index, int worker) {
+    (void)worker;
+    BlockBatch* batch = (BlockBatch*)context;
+    BlockSlot* slot = &batch->slots[index];
+    slot->status = slot->header.stored ? 0 : batch->codec->decode(slot->encoded, slot->header.encoded_size,
+                                                                  slot->raw, slot->header.raw_size);
+    // CRC tính ngay sau khi giải mã, khi dữ liệu còn nằm trong cache của luồng này
+    if (slot->status == 0 && batch->use_crc && crc32c_update(0, slot->raw, slot->header.raw_size) != slot->header.crc) {
+        slot->status = BLOCK_CRC_MISMATCH;
+    }
+    if (slot->status == 0 && batch->count_lines) {
+        slot->line_count = (uint32_t)count_newlines((const char*)slot->raw, (const char*)slot->raw + slot->header.raw_size);
+    }
+}
+
+// --- TỆP NÉN CÓ BẢNG TRA VỊ TRÍ ---
+
+// Các mảng có block_count + 1 phần tử; phần tử cuối là tổng của cả tệp
+struct SeekableFile {
+    FILE* input;
+    BlockBatch batch;
+    size_t block_count;
+    uint64_t* positions; // Vị trí (trong tệp nén) của header khối i
+    uint64_t* offsets;   // Byte gốc đầu tiên của khối i
+    uint64_t* lines;     // Số '\n' trong dữ liệu gốc trước khối i
+};
+
+SeekableFile* seekable_open(FILE* input, const CompressOptions* options) {
+    FrameHeader header;
+    const BlockCodec* codec = NULL;
+    char magic[4];
+    if (file_seek64(input, 0, SEEK_SET) == 0 && fread(magic, 1, 4, input) == 4 && memcmp(magic, FRAME_MAGIC, 4) == 0 &&
+        read_frame_header(input, &header) == 0 && header.version == FRAME_VERSION &&
+        (header.flags & ~FRAME_KNOWN_FLAGS) == 0 && header.block_size > 0 && header.block_size <= BLOCK_MAX_SIZE) {
+        codec = frame_codec((CompressionAlgorithm)header.codec);
+    }
+    if (codec == NULL) {
+        fprintf(stderr, "Lỗi: Tệp không phải tệp nén hợp lệ hoặc phiên bản khung không được hỗ trợ.\n");
+        return NULL;
+    }
+    if (!(header.flags & FRAME_FLAG_SEEK_TABLE)) {
+        fprintf(stderr, "Lỗi: Tệp nén không có bảng tra vị trí; hãy nén lại với tùy chọn '--seekable'.\n");
+        return NULL;
+    }
+
+    // Footer ở cuối tệp cho biết số mục của bảng nằm ngay trước nó
+    SeekTableFooter footer;
+    long long file_size = -1;
+    if (file_seek64(input, 0, SEEK_END) == 0) file_size = file_tell64(input);
+    if (file_size < FRAME_HEADER_SIZE + FRAME_BLOCK_HEADER_SIZE + SEEK_TABLE_FOOTER_SIZE ||
+        file_seek64(input, file_size - SEEK_TABLE_FOOTER_SIZE, SEEK_SET) != 0 ||
+        read_seek_table_footer(input, &footer) != 0 ||
+        (uint64_t)footer.entry_count * SEEK_TABLE_ENTRY_SIZE > (uint64_t)file_size - SEEK_TABLE_FOOTER_SIZE) {
+        fprintf(stderr, "Lỗi: Không tìm thấy bảng tra vị trí ở cuối tệp: tệp bị cắt cụt hoặc hỏng.\n");
+        return NULL;
+    }
+    uint64_t table_pos = (uint64_t)file_size - SEEK_TABLE_FOOTER_SIZE - (uint64_t)footer.entry_count * SEEK_TABLE_ENTRY_SIZE;
+
+    SeekableFile* file = (SeekableFile*)calloc(1, sizeof(SeekableFile));
+    size_t count = footer.entry_count;
+    unsigned char* entries = (unsigned char*)malloc((count > 0 ? count : 1) * SEEK_TABLE_ENTRY_SIZE);
+    uint64_t* arrays = (uint64_t*)malloc(3 * (count + 1) * sizeof(uint64_t));
+    if (file == NULL || entries == NULL || arrays == NULL) {
+        fprintf(stderr, "Lỗi: Không đủ bộ nhớ cho bảng tra vị trí.\n");
+        free(file);
+        free(entries);
+        free(arrays);
+        return NULL;
+    }
+    file->input = input;
+    file->block_count = count;
+    file->positions = arrays;
+    file->offsets = arrays + (count + 1);
+    file->lines = arrays + 2 * (count + 1);
+
+    // Cộng dồn bảng; các khối phải nối tiếp nhau từ sau header tới khối kết thúc ngay trước bảng
+    int valid = file_seek64(input, (long long)table_pos, SEEK_SET) == 0 &&
+                fread(entries, SEEK_TABLE_ENTRY_SIZE, count, input) == count &&
+                crc32c_update(0, entries, count * SEEK_TABLE_ENTRY_SIZE) == footer.crc;
+    file->positions[0] = FRAME_HEADER_SIZE;
+    file->offsets[0] = 0;
+    file->lines[0] = 0;
+    for (size_t i = 0; i < count && valid; i++) {
+        SeekTableEntry entry;
+        read_seek_table_entry(entries + i * SEEK_TABLE_ENTRY_SIZE, &entry);
+        valid = entry.raw_size > 0 && entry.raw_size <= header.block_size &&
+                entry.frame_size >= FRAME_BLOCK_HEADER_SIZE && entry.line_count <= entry.raw_size;
+        file->positions[i + 1] = file->positions[i] + entry.frame_size;
+        file->offsets[i + 1] = file->offsets[i] + entry.raw_size;
+        file->lines[i + 1] = file->lines[i] + entry.line_count;
     }
+    free(entries);
+    if (valid && (file->positions[count] + FRAME_BLOCK_HEADER_SIZE != table_pos ||
+                  ((header.flags & FRAME_FLAG_SIZE_KNOWN) && file->offsets[count] != header.original_size))) {
+        valid = 0;
+    }
+    if (!valid) {
+        fprintf(stderr, "Lỗi: Bảng tra vị trí bị hỏng.\n");
+        seekable_close(file);
+        return NULL;
+    }
+
+    if (block_batch_init(&file->batch, codec, header.block_size, options, 0) != 0) {
+        fprintf(stderr, "Lỗi: Không đủ bộ nhớ để giải nén.\n");
+        seekable_close(file);
+        return NULL;
+    }
+    file->batch.use_crc = (header.flags & FRAME_FLAG_BLOCK_CRC) != 0;
+    return file;
+}
+
+void seekable_close(SeekableFile* file) {
+    if (file == NULL) return;
+    block_batch_free(&file->batch);
+    free(file->positions);
+    free(file);
+}
+
+uint64_t seekable_size(const SeekableFile* file) {
+    return file->offsets[file->block_count];
+}
+
+int seekable_read(SeekableFile* file, uint64_t offset, size_t size, unsigned char* dst) {
+    uint64_t total = file->offsets[file->block_count];
+    if (offset > total || size > total - offset) return -1;
+    if (size == 0) return 0;
+    uint64_t end = offset + size;
+    size_t block = seekable_find_block(file, offset);
+    while (offset < end) {
+        int count = seekable_decode(file, block, end);
+        if (count <= 0) return -1;
+        for (int i = 0; i < count; i++) {
+            const BlockSlot* slot = &file->batch.slots[i];
+            uint64_t block_end = file->offsets[block + i + 1];
+            size_t from = (size_t)(offset - file->offsets[block + i]);
+            size_t length = (size_t)((block_end < end ? block_end : end) - offset);
+            memcpy(dst, slot->raw + from, length);
+            dst += length;
+            offset += length;
+        }
+        block += (size_t)count;
+    }
+    return 0;
+}
+
+int seekable_line_start(SeekableFile* file, uint64_t line, uint64_t* offset) {
+    size_t n = file->block_count;
+    // Dòng thứ line bắt đầu ngay sau '\n' thứ line (đếm từ 1)
+    if (line == 0) {
+        *offset = 0;
+        return 0;
+    }
+    if (line > file->lines[n]) {
+        *offset = file->offsets[n];
+        return 0;
+    }
+    // Khối k chứa '\n' đó: lines[k] < line <= lines[k + 1]
+    size_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (file->lines[mid + 1] < line) lo = mid + 1;
+        else hi = mid;
+    }
+    if (seekable_decode(file, lo, file->offsets[lo] + 1) != 1) return -1;
+    const BlockSlot* slot = &file->batch.slots[0];
+    const unsigned char* p = slot->raw;
+    const unsigned char* end = slot->raw + slot->header.raw_size;
+    for (uint64_t remaining = line - file->lines[lo];; remaining--) {
+        const unsigned char* newline = (const unsigned char*)memchr(p, '\n', (size_t)(end - p));
+        if (newline == NULL) {
+            fprintf(stderr, "Lỗi: Số dòng của khối %llu khác bảng tra vị trí: tệp bị hỏng.\n", (unsigned long long)lo);
+            return -1;
+        }
+        p = newline + 1;
+        if (remaining == 1) break;
+    }
+    *offset = file->offsets[lo] + (uint64_t)(p - slot->raw);
+    return 0;
+}
+
+int seekable_count_lines(SeekableFile* file, uint64_t offset, uint64_t* lines) {
+    size_t n = file->block_count;
+    if (offset > file->offsets[n]) return -1;
+    if (offset == file->offsets[n]) {
+        *lines = file->lines[n];
+        return 0;
+    }
+    size_t block = seekable_find_block(file, offset);
+    if (seekable_decode(file, block, offset + 1) != 1) return -1;
+    const char* raw = (const char*)file->batch.slots[0].raw;
+    *lines = file->lines[block] + count_newlines(raw, raw + (offset - file->offsets[block]));
+    return 0;
+}
+
+/**
+ * @brief Chỉ số của khối chứa byte gốc offset (offset < seekable_size).
+ */
+static size_t seekable_find_block(const SeekableFile* file, uint64_t offset) {
+    size_t lo = 0, hi = file->block_count - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo + 1) / 2;
+        if (file->offsets[mid] <= offset) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+/**
+ * @brief Đọc và giải mã song song tối đa slot_count khối liên tiếp bắt đầu từ khối first,
+ * dừng ở khối đầu tiên bắt đầu từ byte gốc end trở đi. Khối thứ i nằm trong batch.slots[i].
+ * @return Số khối đã giải mã, hoặc -1 (đã in lỗi) nếu tệp bị hỏng.
+ */
+static int seekable_decode(SeekableFile* file, size_t first, uint64_t end) {
+    BlockBatch* batch = &file->batch;
+    if (file_seek64(file->input, (long long)file->positions[first], SEEK_SET) != 0) return -1;
+    int count = 0;
+    while (count < batch->slot_count && first + count < file->block_count && file->offsets[first + count] < end) {
+        size_t block = first + (size_t)count;
+        BlockSlot* slot = &batch->slots[count];
+        // Khối phải khớp với mục của nó trong bảng tra
+        if (read_block(file->input, batch, slot) != 1 ||
+            slot->header.raw_size != file->offsets[block + 1] - file->offsets[block] ||
+            FRAME_BLOCK_HEADER_SIZE + slot->header.encoded_size != file->positions[block + 1] - file->positions[block]) {
+            fprintf(stderr, "Lỗi: Khối %llu (byte gốc %llu..%llu) không khớp với bảng tra vị trí: tệp bị hỏng.\n",
+                    (unsigned long long)block, (unsigned long long)file->offsets[block],
+                    (unsigned long long)(file->offsets[block + 1] - 1));
+            return -1;
+        }
+        count++;
+    }
+    block_batch_run(batch, count, block_decompress_task);
+    for (int i = 0; i < count; i++) {
+        if (batch->slots[i].status != 0) {
+            report_block_error(&batch->slots[i], first + i, file->offsets[first + i]);
+            return -1;
+        }
+    }
+    return count;
+}
+
+static size_t huffman_block_bound(size_t size) {
+    return HUFFMAN_BLOCK_BOUND(size);
+}
+
+static size_t huffman_block_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst) {
+    (void)state;
+    return huffman_encode_block(src, size, dst);
+}
+
+static size_t lz77_block_bound(size_t size) {
+    return LZ77_BLOCK_BOUND(size);
+}
+
+/**
+ * @brief Tạo bộ tìm chuỗi khớp cho một luồng nén (dùng chung cho LZ77 và LZH).
+ */
+static void* create_matcher(const CompressOptions* options, size_t block_size, int default_level) {
+    Lz77Matcher* m = (Lz77Matcher*)malloc(sizeof(Lz77Matcher));
+    if (m == NULL) return NULL;
+    int level = options != NULL && options->level > 0 ? options->level : default_level;
+    if (lz77_matcher_init(m, level, block_size) != 0) {
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+static void* lz77_create_state(const CompressOptions* options, size_t block_size) {
+    return create_matcher(options, block_size, LZ77_DEFAULT_LEVEL);
+}
+
+static void lz77_free_state(void* state) {
+    lz77_matcher_free((Lz77Matcher*)state);
+    free(state);
+}
+
+static size_t lz77_block_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst) {
+    return lz77_encode_block((Lz77Matcher*)state, src, size, dst);
+}
+
+static size_t lzh_block_bound(size_t size) {
+    return LZH_BLOCK_BOUND(size);
+}
+
+static void* lzh_create_state(const CompressOptions* options, size_t block_size) {
+    return create_matcher(options, block_size, LZH_DEFAULT_LEVEL);
+}
+
+static size_t lzh_block_encode(void* state, const unsigned char* src, size_t size, unsigned char* dst) {
+    return lzh_encode_block((Lz77Matcher*)state, src, size, dst);
+}
+
+// --- TỰ CHỌN THUẬT TOÁN ---
+
+/**
+ * @brief Cộng thống kê của một mẫu: tần suất byte, kích thước RLE theo khối và kích thước LZH,
+ * cả hai đều mã hóa thật vào vùng nhớ tạm (scratch, lzh_out). Mẫu LZH là một khối độc lập
+ * nên chỉ có lịch sử trong chính mẫu; bảng mã ở đầu khối được trừ ra và tính lại theo khối thật.
+ */
+static void sample_block(SampleStats* stats, const unsigned char* src, size_t size, unsigned char* scratch,
+                         void* matcher, unsigned char* lzh_out) {
+    // 4 bảng đếm xen kẽ: các byte giống nhau liên tiếp không phải chờ nhau cập nhật cùng một ô
+    uint32_t counts[4][HUFFMAN_SYMBOLS];
+    memset(counts, 0, sizeof(counts));
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        counts[0][src[i]]++;
+        counts[1][src[i + 1]]++;
+        counts[2][src[i + 2]]++;
+        counts[3][src[i + 3]]++;
+    }
+    for (; i < size; i++) counts[0][src[i]]++;
+    for (int c = 0; c < HUFFMAN_SYMBOLS; c++) stats->freq[c] += (uint64_t)counts[0][c] + counts[1][c] + counts[2][c] + counts[3][c];
+    stats->sampled += size;
+    stats->rle_size += rle_block_encode(src, size, scratch);
+
+    size_t encoded = lzh_block_encode(matcher, src, size, lzh_out);
+    stats->lzh_size += encoded > AUTO_LZH_TABLES_SIZE ? encoded - AUTO_LZH_TABLES_SIZE : 0;
 }
 
-void free_huffman_tree(HuffmanNode* root) {
-    if (root == NULL) return;
-    free_huffman_tree(root->left);
-    free_huffman_tree(root->right);
-    free(root);
+/**
+ * @brief Kích thước (byte) khi mã hóa các ký hiệu bằng bảng Huffman bậc 0 của chính chúng:
+ * gần với entropy bậc 0 nhưng tính cả giới hạn mỗi ký hiệu ít nhất 1 bit.
+ */
+static uint64_t huffman_size_estimate(const uint64_t freq[HUFFMAN_SYMBOLS]) {
+    uint8_t lengths[HUFFMAN_SYMBOLS];
+    huffman_build_lengths(freq, HUFFMAN_SYMBOLS, HUFFMAN_MAX_CODE_LENGTH, lengths);
+    uint64_t bits = 0;
+    for (int i = 0; i < HUFFMAN_SYMBOLS; i++) bits += freq[i] * lengths[i];
+    return (bits + 7) / 8;
 }
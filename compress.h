@@ -5,15 +5,47 @@
 #include <stdint.h> // For fixed-width integers
 
 #define MAX_TREE_HT 256
-#define HUFFMAN_MAGIC "HUFF"
+// Khung chung của mọi thuật toán: FrameHeader, các khối (FrameBlockHeader + dữ liệu),
+// rồi một FrameBlockHeader toàn 0 đánh dấu hết khung. Mọi tệp nén mới đều dùng khung này; ngoài khung
+// chỉ còn đọc được tệp HUFF và tệp RLE không có header của các phiên bản cũ.
+#define FRAME_MAGIC "TAFR"
+#define FRAME_VERSION 1
+#define FRAME_FLAG_SIZE_KNOWN 0x01 // original_size hợp lệ (đầu vào tua lại được khi nén)
+#define FRAME_FLAG_BLOCK_CRC  0x02 // Mỗi khối mang CRC32C của dữ liệu gốc
+#define FRAME_FLAG_SEEK_TABLE 0x04 // Sau khối kết thúc là bảng tra vị trí (SeekTableEntry...) và SeekTableFooter
+#define FRAME_KNOWN_FLAGS     (FRAME_FLAG_SIZE_KNOWN | FRAME_FLAG_BLOCK_CRC | FRAME_FLAG_SEEK_TABLE)
+#define SEEK_TABLE_MAGIC "TASK"
+#define HUFFMAN_MAGIC "HUFF"           // Định dạng cũ: bảng tần suất + cây dựng lại khi giải nén
+// Huffman theo khối: mỗi khối có bảng mã riêng (4 luồng bit), nén/giải nén song song
+#define HUFFMAN_BLOCK_SIZE (1 << 20)   // Kích thước khối mặc định khi nén
+#define BLOCK_MAX_SIZE (64 << 20)      // Kích thước khối lớn nhất chấp nhận khi giải nén khung
+// LZ77/LZSS: các khối độc lập, chuỗi khớp tìm bằng chuỗi băm trong cửa sổ 64 KB
+#define LZ77_BLOCK_SIZE (1 << 20)
+// LZ77 + Huffman (kiểu deflate): literal, độ dài và khoảng cách được mã hóa bằng bảng Huffman của từng khối
+#define LZH_BLOCK_SIZE (1 << 20)
+
+// RLE theo khối: dữ liệu mỗi khối 'rleb' trong khung là chuỗi các đoạn kiểu PackBits,
+// mỗi đoạn bắt đầu bằng một byte điều khiển h:
+//   h < 128:  h + 1 byte tiếp theo được chép nguyên văn (đoạn literal, 1..128 byte)
+//   h >= 128: byte tiếp theo lặp lại h - 128 + RLE_MIN_RUN lần (đoạn lặp, 3..130 byte)
+#define RLE_BLOCK_SIZE    (1 << 20) // Số byte gốc tối đa mỗi khối
+#define RLE_MIN_RUN       3
+#define RLE_MAX_RUN       (127 + RLE_MIN_RUN)
+#define RLE_MAX_LITERAL   128
 
 /**
  * @brief Enum để định danh các thuật toán nén.
  * Sử dụng enum giúp mã nguồn dễ đọc và an toàn hơn so với dùng số nguyên.
+ * Giá trị được ghi vào FrameHeader.codec nên không được đổi thứ tự; thuật toán mới thêm trước ALG_AUTO.
  */
 typedef enum {
     ALG_RLE,      // Thuật toán Run-Length Encoding
     ALG_HUFFMAN,  // Thuật toán Huffman Coding
+    ALG_RLE_BLOCK,// RLE theo khối với đoạn literal (kiểu PackBits)
+    ALG_HUFFMAN_BLOCK, // Huffman theo khối, mỗi khối một bảng mã (song song)
+    ALG_LZ77,     // LZ77/LZSS: tham chiếu ngược trong cửa sổ trượt
+    ALG_LZH,      // LZ77 + Huffman theo khối (kiểu deflate)
+    ALG_AUTO,     // Chỉ khi nén: chọn thuật toán bằng choose_compression_algorithm
     ALG_UNKNOWN
 } CompressionAlgorithm;
 
@@ -25,6 +57,58 @@ typedef struct {
     uint32_t frequency;
 } SymbolFreq;
 
+/**
+ * @brief Header của khung chung. Trên đĩa các trường được ghi liền nhau theo đúng thứ tự dưới đây,
+ * số nguyên theo little-endian (FRAME_HEADER_SIZE byte), không phụ thuộc cách trình biên dịch xếp struct.
+ */
+#define FRAME_HEADER_SIZE 19
+typedef struct {
+    char magic[4];          // "TAFR"
+    uint8_t version;        // FRAME_VERSION
+    uint8_t codec;          // CompressionAlgorithm đã dùng để nén các khối
+    uint8_t flags;          // Các bit FRAME_FLAG_*; bit không biết khiến tệp bị từ chối
+    uint32_t block_size;    // Số byte gốc tối đa mỗi khối
+    uint64_t original_size; // Kích thước dữ liệu gốc (chỉ khi có FRAME_FLAG_SIZE_KNOWN)
+} FrameHeader;
+
+/**
+ * @brief Header của mỗi khối trong khung. Dữ liệu theo sau do bộ mã của codec tạo ra, hoặc là byte gốc
+ * nếu stored = 1. Khối kết thúc khung có raw_size = 0 (các trường khác cũng bằng 0); thiếu khối này
+ * nghĩa là tệp bị cắt cụt. Ghi trên đĩa như FrameHeader: các trường liền nhau, little-endian
+ * (FRAME_BLOCK_HEADER_SIZE byte).
+ */
+#define FRAME_BLOCK_HEADER_SIZE 13
+typedef struct {
+    uint32_t raw_size;     // Số byte gốc của khối
+    uint32_t encoded_size; // Số byte dữ liệu theo sau header
+    uint8_t stored;        // 1 nếu khối không nén được và được lưu nguyên văn
+    uint32_t crc;          // CRC32C của dữ liệu gốc (khi có FRAME_FLAG_BLOCK_CRC)
+} FrameBlockHeader;
+
+/**
+ * @brief Một mục của bảng tra vị trí, theo thứ tự các khối. Cộng dồn frame_size cho vị trí của khối trong tệp nén,
+ * cộng dồn raw_size và line_count cho byte gốc và số dòng ở đầu khối, nên đọc một khoảng chỉ cần giải mã
+ * các khối phủ khoảng đó. Ghi trên đĩa như FrameHeader: các trường liền nhau, little-endian
+ * (SEEK_TABLE_ENTRY_SIZE byte).
+ */
+#define SEEK_TABLE_ENTRY_SIZE 12
+typedef struct {
+    uint32_t frame_size; // Số byte của khối trong tệp nén (FrameBlockHeader + dữ liệu)
+    uint32_t raw_size;   // Số byte gốc của khối
+    uint32_t line_count; // Số '\n' trong dữ liệu gốc của khối
+} SeekTableEntry;
+
+/**
+ * @brief Kết thúc bảng tra vị trí, nằm ở cuối tệp để tìm được bằng một lần tua từ cuối
+ * (SEEK_TABLE_FOOTER_SIZE byte, little-endian). CRC32C được tính trên các mục đã ghi ra đĩa.
+ */
+#define SEEK_TABLE_FOOTER_SIZE 12
+typedef struct {
+    uint32_t entry_count; // Số SeekTableEntry ngay trước footer (bằng số khối)
+    uint32_t crc;         // CRC32C của các SeekTableEntry
+    char magic[4];        // "TASK"
+} SeekTableFooter;
+
 /**
  * @brief Header cho file Huffman đã được tối ưu.
  * Cấu trúc này được đóng gói (packed) để đảm bảo không có byte đệm,
@@ -39,22 +123,98 @@ typedef struct {
 #pragma pack(pop)
 
 
+/**
+ * @brief Tùy chọn cho nén/giải nén.
+ */
+typedef struct {
+    int num_threads; // Số luồng cho các định dạng theo khối; <= 0 nghĩa là dùng số lõi CPU
+    int level;       // Mức nỗ lực khi nén LZ77/LZH (1..9); <= 0 nghĩa là mặc định
+    int seekable;    // Khi nén: ghi thêm bảng tra vị trí để đọc ngẫu nhiên bằng SeekableFile
+} CompressOptions;
+
+/**
+ * @brief Tệp nén có bảng tra vị trí, mở để đọc một khoảng dữ liệu gốc mà không giải nén từ đầu tệp.
+ */
+typedef struct SeekableFile SeekableFile;
+
 /**
  * @brief Nén một tệp sử dụng thuật toán được chỉ định.
  * @param input Con trỏ đến tệp đầu vào đã mở.
  * @param output Con trỏ đến tệp đầu ra đã mở.
- * @param algo Thuật toán nén để sử dụng (ALG_RLE hoặc ALG_HUFFMAN).
+ * Đầu ra là một khung (FrameHeader) ghi lại thuật toán, nên giải nén không cần biết thuật toán trước.
+ * @param algo Thuật toán nén để sử dụng (ALG_AUTO: chọn bằng choose_compression_algorithm).
+ * @param options Tùy chọn, hoặc NULL để dùng mặc định.
  * @return int Trả về 0 nếu thành công, -1 nếu thất bại.
  */
-int compress_file(FILE* input, FILE* output, CompressionAlgorithm algo);
+int compress_file(FILE* input, FILE* output, CompressionAlgorithm algo, const CompressOptions* options);
 
 /**
- * @brief Giải nén một tệp.
+ * @brief Chọn thuật toán nén cho phần còn lại của input bằng cách lấy mẫu vài đoạn rải đều trong tệp
+ * (khoảng 1/1024 dữ liệu, ít nhất 2 mẫu 16 KB). Kích thước đầu ra được ước lượng cho 'rleb' (mã hóa thật
+ * các mẫu), 'huffb' (bảng Huffman bậc 0 của mẫu) và 'lzh' (chuỗi lặp tìm bằng bảng băm, literal mã hóa Huffman);
+ * thuật toán nhanh hơn được ưu tiên khi kích thước gần bằng. Vị trí đọc của input được khôi phục.
+ * Thuật toán đã chọn được ghi trong header của khung.
+ * @return Thuật toán được chọn; ALG_LZH nếu input không tua lại được (pipe, stdin).
+ */
+CompressionAlgorithm choose_compression_algorithm(FILE* input);
+
+/**
+ * @brief Giải nén một tệp. Định dạng được nhận diện qua "số ma thuật": khung chung, rồi định dạng HUFF cũ.
+ * CRC32C của từng khối trong khung được kiểm tra trước khi ghi.
  * @param input Con trỏ đến tệp cần giải nén đã mở.
- * @param output Con trỏ đến tệp đầu ra đã mở.
- * @param algo Thuật toán đã được dùng để nén (ALG_RLE hoặc ALG_HUFFMAN).
+ * @param output Con trỏ đến tệp đầu ra đã mở, hoặc NULL để chỉ kiểm tra (giải mã và so CRC, không ghi gì);
+ * chỉ khung chung có CRC để kiểm tra.
+ * @param algo Gợi ý (theo đuôi tệp hoặc --algo), chỉ dùng cho RLE cũ vốn không có header; ALG_UNKNOWN nếu không có.
+ * @param options Tùy chọn, hoặc NULL để dùng mặc định.
+ * @param detected Nhận thuật toán của tệp khi nhận diện được, hoặc NULL.
  * @return int Trả về 0 nếu thành công, -1 nếu thất bại.
  */
-int decompress_file(FILE* input, FILE* output, CompressionAlgorithm algo);
+int decompress_file(FILE* input, FILE* output, CompressionAlgorithm algo, const CompressOptions* options,
+                    CompressionAlgorithm* detected);
+
+/**
+ * @brief Giải nén toàn bộ một tệp nén dạng khung vào bộ nhớ, không cần bảng tra vị trí hay kích thước gốc
+ * trong header: bộ đệm được nới rộng dần trong khi giải nén.
+ * @param input Tệp nén đã mở, đọc từ đầu khung.
+ * @param data Nhận bộ đệm (giải phóng bằng free), luôn dư ít nhất 1 byte sau dữ liệu.
+ * @param size Nhận số byte dữ liệu gốc.
+ * @return 0 nếu thành công, -1 (đã in lỗi) nếu tệp không phải dạng khung, bị hỏng hoặc không đủ bộ nhớ.
+ */
+int decompress_to_memory(FILE* input, const CompressOptions* options, unsigned char** data, size_t* size);
+
+/**
+ * @brief Mở tệp nén có bảng tra vị trí (nén với CompressOptions.seekable) để đọc ngẫu nhiên.
+ * Chỉ đọc header và bảng tra; input phải tua lại được và vẫn thuộc quyền người gọi.
+ * @param options Số luồng giải mã các khối của một lần đọc, hoặc NULL để dùng mặc định.
+ * @return Con trỏ cần giải phóng bằng seekable_close, hoặc NULL (đã in lỗi) nếu tệp không có bảng tra hoặc bị hỏng.
+ */
+SeekableFile* seekable_open(FILE* input, const CompressOptions* options);
+
+void seekable_close(SeekableFile* file);
+
+/**
+ * @brief Kích thước dữ liệu gốc (byte).
+ */
+uint64_t seekable_size(const SeekableFile* file);
+
+/**
+ * @brief Giải nén dữ liệu gốc [offset, offset + size) vào dst. Chỉ các khối phủ khoảng này được đọc,
+ * giải mã (song song) và kiểm tra CRC32C.
+ * @return 0 nếu thành công, -1 nếu khoảng vượt quá dữ liệu gốc hoặc tệp bị hỏng.
+ */
+int seekable_read(SeekableFile* file, uint64_t offset, size_t size, unsigned char* dst);
+
+/**
+ * @brief Vị trí (byte gốc) của đầu dòng thứ line, đếm từ 0; chỉ giải mã khối chứa dòng đó.
+ * @param offset Nhận vị trí; bằng kích thước dữ liệu gốc nếu dữ liệu có ít hơn line + 1 dòng.
+ * @return 0 nếu thành công, -1 nếu tệp bị hỏng.
+ */
+int seekable_line_start(SeekableFile* file, uint64_t line, uint64_t* offset);
+
+/**
+ * @brief Số '\n' trong dữ liệu gốc trước vị trí offset; chỉ giải mã khối chứa offset.
+ * @return 0 nếu thành công, -1 nếu offset vượt quá dữ liệu gốc hoặc tệp bị hỏng.
+ */
+int seekable_count_lines(SeekableFile* file, uint64_t offset, uint64_t* lines);
 
 #endif // COMPRESS_H
\ No newline at end of file
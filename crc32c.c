@@ -0,0 +1,103 @@
+#include <string.h>
+#include "crc32c.h"
+
+// Lệnh crc32 của SSE4.2 tính đúng CRC32C; chỉ dùng khi CPU lúc chạy hỗ trợ (kiểm tra trong crc32c_init)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define CRC32C_HAVE_SSE42 1
+#endif
+
+#define CRC32C_POLY 0x82F63B78u // Đa thức Castagnoli ở dạng đảo bit
+
+typedef uint32_t (*Crc32cImpl)(uint32_t crc, const unsigned char* p, size_t size);
+
+// crc_table[k][b]: CRC của byte b theo sau là k byte 0, để xử lý 8 byte mỗi bước (slice-by-8)
+static uint32_t crc_table[8][256];
+static Crc32cImpl crc_impl = NULL;
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static uint32_t crc32c_slice8(uint32_t crc, const unsigned char* p, size_t size);
+#ifdef CRC32C_HAVE_SSE42
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char* p, size_t size);
+#endif
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+void crc32c_init(void) {
+    if (crc_impl != NULL) return;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1)));
+        crc_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            crc_table[k][i] = (crc_table[k - 1][i] >> 8) ^ crc_table[0][crc_table[k - 1][i] & 0xFF];
+        }
+    }
+#ifdef CRC32C_HAVE_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        crc_impl = crc32c_sse42;
+        return;
+    }
+#endif
+    crc_impl = crc32c_slice8;
+}
+
+uint32_t crc32c_update(uint32_t crc, const void* data, size_t size) {
+    if (crc_impl == NULL) crc32c_init();
+    return ~crc_impl(~crc, (const unsigned char*)data, size);
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+/**
+ * @brief Cài đặt bằng bảng: mỗi bước gộp 8 byte bằng 8 phép tra độc lập (giả định little-endian).
+ */
+static uint32_t crc32c_slice8(uint32_t crc, const unsigned char* p, size_t size) {
+    while (size >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+              crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+              crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+              crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0) crc = (crc >> 8) ^ crc_table[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#ifdef CRC32C_HAVE_SSE42
+/**
+ * @brief Cài đặt bằng lệnh crc32 (8 byte mỗi lệnh trên x86-64), biên dịch riêng cho SSE4.2
+ * để phần còn lại của chương trình vẫn chạy được trên CPU cũ.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char* p, size_t size) {
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        size -= 8;
+    }
+    crc = (uint32_t)crc64;
+#endif
+    while (size >= 4) {
+        uint32_t word;
+        memcpy(&word, p, 4);
+        crc = _mm_crc32_u32(crc, word);
+        p += 4;
+        size -= 4;
+    }
+    while (size-- > 0) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+#endif
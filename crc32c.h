@@ -0,0 +1,20 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Chọn cài đặt CRC32C: lệnh crc32 của SSE4.2 nếu CPU hỗ trợ, nếu không thì bảng slice-by-8.
+ * crc32c_update tự gọi hàm này ở lần dùng đầu tiên; hãy gọi trước khi dùng từ nhiều luồng.
+ */
+void crc32c_init(void);
+
+/**
+ * @brief Cập nhật CRC32C (đa thức Castagnoli, như iSCSI/ext4) với size byte tiếp theo.
+ * @param crc Giá trị trả về của lần gọi trước, hoặc 0 cho dữ liệu mới.
+ * @return CRC32C của toàn bộ dữ liệu đã đưa vào (crc32c_update(0, "123456789", 9) = 0xE3069283).
+ */
+uint32_t crc32c_update(uint32_t crc, const void* data, size_t size);
+
+#endif // CRC32C_H
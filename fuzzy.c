@@ -0,0 +1,186 @@
+#include <string.h>
+#include "fuzzy.h"
+#include "search.h"
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static int stop_at_first_match(void* context, const char* match_end, int errors);
+static const char* next_candidate(const FuzzyPattern* fp, const char* p, const char* end);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+int fuzzy_compile(FuzzyPattern* fp, const char* pattern, size_t length, int max_errors, int case_sensitive) {
+    memset(fp, 0, sizeof(FuzzyPattern));
+    if (length == 0 || length > FUZZY_MAX_PATTERN) return -1;
+    if (max_errors < 0 || (size_t)max_errors >= length) return -1;
+
+    fp->length = (int)length;
+    fp->max_errors = max_errors;
+    fp->last_bit = (uint64_t)1 << (length - 1);
+
+    // Không phân biệt hoa/thường: mọi byte có cùng dạng chữ thường với ký tự của mẫu đều khớp
+    for (int c = 0; c < 256; c++) {
+        unsigned char key = case_sensitive ? (unsigned char)c : search_fold_table[c];
+        for (size_t i = 0; i < length; i++) {
+            unsigned char p = (unsigned char)pattern[i];
+            if ((case_sensitive ? p : search_fold_table[p]) != key) continue;
+            fp->peq[c] |= (uint64_t)1 << i;
+            fp->peq_reverse[c] |= (uint64_t)1 << (length - 1 - i);
+        }
+    }
+
+    int piece_count = max_errors + 1;
+    if (piece_count <= FUZZY_MAX_PIECES && length / piece_count >= FUZZY_MIN_PIECE) {
+        for (int i = 0; i < piece_count; i++) {
+            size_t from = length * i / piece_count;
+            size_t to = length * (i + 1) / piece_count;
+            if (search_compile(&fp->pieces[i], pattern + from, to - from, case_sensitive) != 0) {
+                fuzzy_free(fp);
+                return -1;
+            }
+            fp->piece_count++;
+        }
+    }
+    return 0;
+}
+
+void fuzzy_free(FuzzyPattern* fp) {
+    for (int i = 0; i < fp->piece_count; i++) search_free(&fp->pieces[i]);
+    fp->piece_count = 0;
+}
+
+int fuzzy_scan(const FuzzyPattern* fp, const char* begin, const char* end, FuzzyCallback callback, void* context) {
+    const uint64_t* peq = fp->peq;
+    const uint64_t last_bit = fp->last_bit;
+    const int max_errors = fp->max_errors;
+
+    // Pv/Mv: hiệu dọc +1/-1 giữa các hàng liên tiếp của cột hiện tại; score: giá trị ở hàng cuối
+    uint64_t pv = ~(uint64_t)0, mv = 0;
+    int score = fp->length;
+
+    for (const unsigned char* p = (const unsigned char*)begin; p < (const unsigned char*)end; p++) {
+        if (*p == '\n') {
+            // Chuỗi khớp không vượt qua dòng: bắt đầu lại cột đầu tiên
+            pv = ~(uint64_t)0;
+            mv = 0;
+            score = fp->length;
+            continue;
+        }
+        uint64_t eq = peq[*p];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last_bit) score++;
+        else if (mh & last_bit) score--;
+        // Hàng 0 luôn bằng 0 (chuỗi khớp có thể bắt đầu ở bất kỳ đâu) nên dịch vào bit 0
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score <= max_errors && callback(context, (const char*)p + 1, score) != 0) return 1;
+    }
+    return 0;
+}
+
+int fuzzy_find_line(const FuzzyPattern* fp, const char* begin, const char* end, const char** line_start, const char** line_end) {
+    const char* match_end = NULL;
+    if (fp->piece_count > 0) {
+        // Chỉ kiểm tra các dòng chứa một mảnh; dòng không khớp thì tìm mảnh tiếp từ dòng sau
+        const char* p = begin;
+        const char* candidate;
+        while (p < end && (candidate = next_candidate(fp, p, end)) != NULL) {
+            const char* ls = candidate;
+            while (ls > p && ls[-1] != '\n') ls--;
+            const char* newline = (const char*)memchr(candidate, '\n', end - candidate);
+            const char* le = newline != NULL ? newline : end;
+            if (fuzzy_scan(fp, ls, le, stop_at_first_match, (void*)&match_end)) {
+                *line_start = ls;
+                *line_end = le;
+                return 1;
+            }
+            p = le + 1;
+        }
+        return 0;
+    }
+
+    if (!fuzzy_scan(fp, begin, end, stop_at_first_match, (void*)&match_end)) return 0;
+
+    const char* ls = match_end - 1;
+    while (ls > begin && ls[-1] != '\n') ls--;
+    const char* newline = (const char*)memchr(match_end - 1, '\n', end - (match_end - 1));
+    *line_start = ls;
+    *line_end = newline != NULL ? newline : end;
+    return 1;
+}
+
+const char* fuzzy_match_start(const FuzzyPattern* fp, const char* line_start, const char* match_end) {
+    const uint64_t* peq = fp->peq_reverse;
+    const uint64_t last_bit = fp->last_bit;
+
+    // Quét ngược với mẫu đảo ngược, neo tại match_end: hàng 0 tăng 1 mỗi cột (bit 1 được dịch vào)
+    uint64_t pv = ~(uint64_t)0, mv = 0;
+    int score = fp->length;
+    int best_score = score;
+    const char* best_start = match_end;
+
+    const char* limit = match_end - (fp->length + fp->max_errors);
+    if (limit < line_start) limit = line_start;
+    for (const char* p = match_end; p > limit; ) {
+        p--;
+        uint64_t eq = peq[(unsigned char)*p];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last_bit) score++;
+        else if (mh & last_bit) score--;
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < best_score) {
+            best_score = score;
+            best_start = p;
+        }
+    }
+    return best_start;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+/**
+ * @brief Tìm vị trí sớm nhất trong [p, end) mà một mảnh của mẫu xuất hiện nguyên vẹn.
+ * Các mảnh được tìm trong một cửa sổ tăng gấp đôi sau mỗi lần không thấy, và mỗi mảnh sau chỉ tìm đến
+ * trước vị trí tốt nhất hiện có: một mảnh không bao giờ xuất hiện chỉ làm tốn thêm một phần nhỏ
+ * so với khoảng cách đến ứng viên, kể cả khi ứng viên dày đặc.
+ */
+static const char* next_candidate(const FuzzyPattern* fp, const char* p, const char* end) {
+    size_t window = FUZZY_FILTER_WINDOW;
+    for (;;) {
+        const char* window_end = (size_t)(end - p) > window ? p + window : end;
+        const char* best = NULL;
+        for (int i = 0; i < fp->piece_count; i++) {
+            // Mảnh phải bắt đầu trước window_end (hoặc best) nên được phép kéo dài qua đó length - 1 byte
+            const char* bound = best != NULL ? best : window_end;
+            size_t overhang = fp->pieces[i].length - 1;
+            const char* limit = (size_t)(end - bound) > overhang ? bound + overhang : end;
+            const char* hit = search_next(&fp->pieces[i], p, limit);
+            if (hit != NULL && hit < bound) best = hit;
+        }
+        if (best != NULL) return best;
+        if (window_end == end) return NULL;
+        p = window_end;
+        window *= 2;
+    }
+}
+
+/**
+ * @brief Callback của fuzzy_find_line: ghi lại kết quả đầu tiên rồi dừng quét.
+ */
+static int stop_at_first_match(void* context, const char* match_end, int errors) {
+    (void)errors;
+    *(const char**)context = match_end;
+    return 1;
+}
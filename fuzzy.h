@@ -0,0 +1,73 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "search.h"
+
+// Độ dài mẫu tối đa: mỗi vị trí của mẫu là một bit trong một từ máy 64 bit
+#define FUZZY_MAX_PATTERN 64
+// Bộ lọc theo nguyên lý chuồng bồ câu: chia mẫu thành (số lỗi + 1) mảnh, chuỗi khớp phải chứa nguyên vẹn
+// ít nhất một mảnh. Chỉ dùng khi số mảnh không quá ngưỡng này và mỗi mảnh đủ dài để hiếm gặp.
+#define FUZZY_MAX_PIECES     4
+#define FUZZY_MIN_PIECE      3
+// Cửa sổ tìm mảnh ban đầu (byte), nhân đôi mỗi khi không thấy mảnh nào
+#define FUZZY_FILTER_WINDOW  256
+
+/**
+ * @brief Mẫu tìm kiếm gần đúng (khoảng cách chỉnh sửa Levenshtein) đã được biên dịch.
+ * Dùng thuật toán bit song song của Myers: mỗi byte văn bản cập nhật cả cột ma trận quy hoạch động
+ * bằng vài phép toán trên một từ 64 bit. Chỉ đọc sau khi biên dịch nên dùng chung được giữa các luồng.
+ */
+typedef struct {
+    SearchPattern pieces[FUZZY_MAX_PIECES]; // Các mảnh của mẫu cho bộ lọc (piece_count = 0 nếu không lọc)
+    int piece_count;
+    uint64_t peq[256];         // peq[c]: bit i bật nếu ký tự i của mẫu khớp với byte c
+    uint64_t peq_reverse[256]; // Như peq nhưng cho mẫu đảo ngược (tìm điểm bắt đầu của chuỗi khớp)
+    uint64_t last_bit;         // Bit của ký tự cuối cùng trong mẫu
+    int length;
+    int max_errors;
+} FuzzyPattern;
+
+/**
+ * @brief Hàm nhận kết quả của fuzzy_scan.
+ * @param match_end Vị trí ngay sau byte cuối của chuỗi khớp.
+ * @param errors Số lỗi (thêm, xóa, thay) của chuỗi khớp tốt nhất kết thúc tại match_end.
+ * @return 0 để quét tiếp, khác 0 để dừng.
+ */
+typedef int (*FuzzyCallback)(void* context, const char* match_end, int errors);
+
+/**
+ * @brief Biên dịch mẫu tìm kiếm gần đúng.
+ * @param max_errors Số lỗi tối đa cho phép, phải nhỏ hơn độ dài mẫu.
+ * @return 0 nếu thành công, -1 nếu mẫu rỗng, dài hơn FUZZY_MAX_PATTERN hoặc max_errors không hợp lệ.
+ */
+int fuzzy_compile(FuzzyPattern* fp, const char* pattern, size_t length, int max_errors, int case_sensitive);
+
+void fuzzy_free(FuzzyPattern* fp);
+
+/**
+ * @brief Quét [begin, end) và báo mọi vị trí kết thúc của chuỗi có khoảng cách chỉnh sửa
+ * tới mẫu không quá max_errors. Chuỗi khớp không vượt qua '\n'; begin phải là đầu một dòng.
+ * @return 1 nếu callback yêu cầu dừng, 0 nếu đã quét hết.
+ */
+int fuzzy_scan(const FuzzyPattern* fp, const char* begin, const char* end, FuzzyCallback callback, void* context);
+
+/**
+ * @brief Tìm dòng tiếp theo trong [begin, end) có chuỗi khớp gần đúng, với begin là đầu một dòng.
+ * Nếu có bộ lọc, các mảnh được tìm chính xác bằng bộ tìm chuỗi con và chỉ những dòng chứa một mảnh
+ * mới được kiểm tra bằng thuật toán Myers.
+ * @param line_start, line_end Nhận biên của dòng khớp (line_end trỏ vào '\n' hoặc end).
+ * @return 1 nếu tìm thấy, 0 nếu không.
+ */
+int fuzzy_find_line(const FuzzyPattern* fp, const char* begin, const char* end, const char** line_start, const char** line_end);
+
+/**
+ * @brief Tìm điểm bắt đầu của chuỗi khớp kết thúc tại match_end (để tô sáng kết quả).
+ * Quét ngược với mẫu đảo ngược, chọn chuỗi ngắn nhất có số lỗi nhỏ nhất.
+ * @param line_start Giới hạn trái (không quét qua đầu dòng).
+ * @return Vị trí bắt đầu của chuỗi khớp.
+ */
+const char* fuzzy_match_start(const FuzzyPattern* fp, const char* line_start, const char* match_end);
+
+#endif // FUZZY_H
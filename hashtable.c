@@ -53,6 +53,49 @@ void ht_insert(HashTable* table, const char* word) {
     table->entries[index] = new_entry;
 }
 
+/**
+ * @brief Tìm một từ trong bảng băm mà không thay đổi bảng (an toàn khi nhiều luồng cùng đọc).
+ * @return Con trỏ đến mục tương ứng, hoặc NULL nếu không có.
+ */
+Entry* ht_lookup(const HashTable* table, const char* word) {
+    Entry* current = table->entries[hash(word, table->size)];
+    while (current != NULL && strcmp(current->word, word) != 0) {
+        current = current->next;
+    }
+    return current;
+}
+
+/**
+ * @brief Cộng delta vào số lần xuất hiện của một từ.
+ * Nếu từ chưa có và delta > 0, tạo mục mới. Nếu count giảm về <= 0, xóa mục khỏi bảng
+ * để bộ nhớ chỉ tỉ lệ với các từ còn được đếm.
+ */
+void ht_add(HashTable* table, const char* word, int delta) {
+    unsigned int index = hash(word, table->size);
+    Entry** link = &table->entries[index];
+
+    while (*link != NULL) {
+        Entry* current = *link;
+        if (strcmp(current->word, word) == 0) {
+            current->count += delta;
+            if (current->count <= 0) {
+                *link = current->next; // Gỡ khỏi chuỗi liên kết
+                free(current->word);
+                free(current);
+            }
+            return;
+        }
+        link = &current->next;
+    }
+
+    if (delta <= 0) return;
+    Entry* new_entry = malloc(sizeof(Entry));
+    new_entry->word = strdup(word);
+    new_entry->count = delta;
+    new_entry->next = table->entries[index];
+    table->entries[index] = new_entry;
+}
+
 /**
  * @brief Giải phóng bộ nhớ của bảng băm và các mục trong đó.
  * Giải phóng từng từ và mục trong chuỗi liên kết.
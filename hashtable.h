@@ -14,9 +14,17 @@ typedef struct {
     int size;
 } HashTable;
 
+// Cấu trúc dạng mảng của bảng băm, dùng để sắp xếp và xuất kết quả
+typedef struct {
+    char *word; // Con trỏ để lưu chuỗi (từ)
+    int count;  // Số lần xuất hiện
+} WordStats;
+
 unsigned int hash(const char* key, int table_size);
 HashTable* create_table(int size);
 void ht_insert(HashTable* table, const char* word);
+void ht_add(HashTable* table, const char* word, int delta);
+Entry* ht_lookup(const HashTable* table, const char* word);
 void free_table(HashTable* table);
 
 #endif // _HASHTABLE_H
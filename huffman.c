@@ -0,0 +1,755 @@
+#include <stdlib.h>
+#include <string.h>
+#include "huffman.h"
+
+// Node cho cây Huffman của định dạng cũ; mọi node nằm trong một vùng nhớ chung
+typedef struct HuffmanNode {
+    unsigned char data;
+    unsigned int freq;
+    struct HuffmanNode *left, *right;
+} HuffmanNode;
+
+typedef struct {
+    HuffmanNode nodes[2 * HUFFMAN_SYMBOLS]; // Tối đa 256 lá và 255 node nội
+    int count;
+} HuffmanNodePool;
+
+// Hàng đợi ưu tiên (Min-Heap)
+typedef struct {
+    unsigned int size;
+    HuffmanNode* array[HUFFMAN_SYMBOLS];
+} MinHeap;
+
+// Phần tử của package-merge: một lá (symbol >= 0) hoặc gói của hai phần tử first, first + 1 ở mức sâu hơn
+typedef struct {
+    uint64_t weight;
+    int16_t symbol;
+    int16_t first;
+} PackageItem;
+
+// Bộ đọc bit: bit kế tiếp nằm ở bit cao nhất của `bits`, được nạp lại 8 byte một lần
+typedef struct {
+    FILE* file;
+    unsigned char* buffer;
+    const unsigned char* pos;
+    const unsigned char* end;
+    uint64_t bits;
+    int count;      // Số bit hợp lệ trong `bits`
+    int eof;
+    size_t padding; // Số byte 0 giả đã nạp sau khi hết dữ liệu
+} BitReader;
+
+// Bộ ghi bit: mã được xếp vào bộ tích lũy 64 bit từ bit cao nhất xuống
+typedef struct {
+    uint64_t acc;
+    int bits; // Số bit đang chờ trong acc (luôn < 32 giữa các lần gọi)
+} BitWriter;
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static int compare_package_items(const void* a, const void* b);
+static void count_package_lengths(PackageItem* const lists[], int level, int index, uint8_t lengths[]);
+static HuffmanNode* create_node(HuffmanNodePool* pool, unsigned char data, unsigned int freq);
+static void min_heapify(MinHeap* minHeap, int idx);
+static HuffmanNode* extract_min(MinHeap* minHeap);
+static void insert_node(MinHeap* minHeap, HuffmanNode* node);
+static HuffmanNode* build_huffman_tree(HuffmanNodePool* pool, const unsigned int freq[]);
+static int huffman_tree_height(const HuffmanNode* node);
+static int huffman_decoder_fill(HuffmanDecoder* dec, size_t table, int table_bits, const HuffmanNode* node, int depth, uint32_t prefix);
+static void bit_reader_refill(BitReader* r);
+static size_t encode_symbols(BitWriter* w, const HuffmanCode codes[], const unsigned char* src, size_t size, unsigned char* out);
+static size_t flush_bits(BitWriter* w, unsigned char* out);
+static int decode_symbols(BitReader* r, const HuffmanDecoder* dec, unsigned char* out, size_t count, size_t* valid);
+static int decode_interleaved(BitReader readers[HUFFMAN_STREAMS], const HuffmanDecoder* dec, unsigned char* outs[HUFFMAN_STREAMS], size_t counts[HUFFMAN_STREAMS]);
+static size_t stream_begin(size_t segment, size_t size, int k);
+static void write_le32(unsigned char* p, uint32_t value);
+static uint32_t read_le32(const unsigned char* p);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+void huffman_build_lengths(const uint64_t freq[], int num_symbols, int max_length, uint8_t lengths[]) {
+    memset(lengths, 0, (size_t)num_symbols);
+
+    PackageItem leaves[HUFFMAN_MAX_SYMBOLS];
+    int n = 0;
+    for (int i = 0; i < num_symbols; i++) {
+        if (freq[i] > 0) {
+            leaves[n].weight = freq[i];
+            leaves[n].symbol = (int16_t)i;
+            leaves[n].first = -1;
+            n++;
+        }
+    }
+    if (n == 0) return;
+    if (n == 1) {
+        lengths[leaves[0].symbol] = 1;
+        return;
+    }
+    qsort(leaves, n, sizeof(PackageItem), compare_package_items);
+
+    // lists[d] là danh sách của mức d + 1 (mức sâu nhất chỉ có các lá). Mỗi mức nông hơn là các lá
+    // trộn với các cặp liên tiếp của mức sâu hơn, tất cả đều đã sắp theo trọng số.
+    PackageItem* lists[32];
+    int sizes[32];
+    PackageItem* storage = (PackageItem*)malloc((size_t)max_length * 2 * n * sizeof(PackageItem));
+    if (storage == NULL) {
+        // Không đủ bộ nhớ: dùng mã độ dài cố định (luôn hợp lệ vì n <= HUFFMAN_MAX_SYMBOLS <= 2^9)
+        int bits = 1;
+        while ((1 << bits) < n) bits++;
+        for (int i = 0; i < n; i++) lengths[leaves[i].symbol] = (uint8_t)bits;
+        return;
+    }
+    for (int d = 0; d < max_length; d++) lists[d] = storage + (size_t)d * 2 * n;
+
+    memcpy(lists[max_length - 1], leaves, n * sizeof(PackageItem));
+    sizes[max_length - 1] = n;
+    for (int d = max_length - 2; d >= 0; d--) {
+        const PackageItem* deeper = lists[d + 1];
+        int packages = sizes[d + 1] / 2;
+        int li = 0, pi = 0, size = 0;
+        while (li < n || pi < packages) {
+            uint64_t package_weight = pi < packages ? deeper[2 * pi].weight + deeper[2 * pi + 1].weight : 0;
+            if (pi >= packages || (li < n && leaves[li].weight <= package_weight)) {
+                lists[d][size++] = leaves[li++];
+            } else {
+                lists[d][size].weight = package_weight;
+                lists[d][size].symbol = -1;
+                lists[d][size].first = (int16_t)(2 * pi);
+                size++;
+                pi++;
+            }
+        }
+        sizes[d] = size;
+    }
+
+    // 2n - 2 phần tử nhẹ nhất của mức nông nhất: độ dài mã của một ký hiệu là số lần lá của nó được chọn
+    for (int i = 0; i < 2 * n - 2; i++) count_package_lengths(lists, 0, i, lengths);
+    free(storage);
+}
+
+void huffman_canonical_codes(const uint8_t lengths[], int num_symbols, HuffmanCode codes[]) {
+    int length_count[33] = {0};
+    for (int i = 0; i < num_symbols; i++) length_count[lengths[i]]++;
+    length_count[0] = 0;
+
+    uint32_t next_code[33];
+    uint32_t code = 0;
+    next_code[0] = 0;
+    for (int len = 1; len <= 32; len++) {
+        code = (code + length_count[len - 1]) << 1;
+        next_code[len] = code;
+    }
+
+    for (int i = 0; i < num_symbols; i++) {
+        codes[i].length = lengths[i];
+        codes[i].code = lengths[i] > 0 ? next_code[lengths[i]]++ : 0;
+    }
+}
+
+int huffman_decoder_from_lengths(HuffmanDecoder* dec, const uint8_t lengths[], int num_symbols) {
+    memset(dec, 0, sizeof(HuffmanDecoder));
+
+    // Bất đẳng thức Kraft: tổng 2^(L - len) không được vượt 2^L, nếu không mã không phải là mã tiền tố
+    uint32_t kraft = 0;
+    for (int i = 0; i < num_symbols; i++) {
+        if (lengths[i] > HUFFMAN_MAX_CODE_LENGTH) return -1;
+        if (lengths[i] == 0) continue;
+        kraft += (uint32_t)1 << (HUFFMAN_MAX_CODE_LENGTH - lengths[i]);
+        if (lengths[i] > dec->max_length) dec->max_length = lengths[i];
+    }
+    if (dec->max_length == 0 || kraft > ((uint32_t)1 << HUFFMAN_MAX_CODE_LENGTH)) return -1;
+
+    dec->root_bits = dec->max_length;
+    dec->count = dec->capacity = (size_t)1 << dec->root_bits;
+    dec->entries = (HuffmanDecodeEntry*)calloc(dec->capacity, sizeof(HuffmanDecodeEntry));
+    if (dec->entries == NULL) return -1;
+
+    HuffmanCode codes[HUFFMAN_MAX_SYMBOLS];
+    huffman_canonical_codes(lengths, num_symbols, codes);
+    for (int i = 0; i < num_symbols; i++) {
+        if (codes[i].length == 0) continue;
+        int spare = dec->root_bits - codes[i].length;
+        size_t first = (size_t)codes[i].code << spare;
+        for (size_t j = 0; j < ((size_t)1 << spare); j++) {
+            dec->entries[first + j].value = (uint32_t)i;
+            dec->entries[first + j].length = codes[i].length;
+            dec->entries[first + j].kind = HUFFMAN_ENTRY_LEAF;
+        }
+    }
+    return 0;
+}
+
+int huffman_decoder_from_frequencies(HuffmanDecoder* dec, const unsigned int freq[HUFFMAN_SYMBOLS]) {
+    memset(dec, 0, sizeof(HuffmanDecoder));
+    HuffmanNodePool* pool = (HuffmanNodePool*)malloc(sizeof(HuffmanNodePool));
+    if (pool == NULL) return -1;
+
+    HuffmanNode* root = build_huffman_tree(pool, freq);
+    dec->max_length = huffman_tree_height(root);
+    if (dec->max_length < 1 || dec->max_length > 56) {
+        free(pool);
+        return -1;
+    }
+
+    dec->root_bits = dec->max_length < HUFFMAN_TABLE_BITS ? dec->max_length : HUFFMAN_TABLE_BITS;
+    dec->capacity = (size_t)1 << dec->root_bits;
+    dec->count = dec->capacity;
+    dec->entries = (HuffmanDecodeEntry*)calloc(dec->capacity, sizeof(HuffmanDecodeEntry));
+    int result = dec->entries != NULL ? huffman_decoder_fill(dec, 0, dec->root_bits, root, 0, 0) : -1;
+    free(pool);
+    if (result != 0) huffman_decoder_free(dec);
+    return result;
+}
+
+void huffman_decoder_free(HuffmanDecoder* dec) {
+    free(dec->entries);
+    dec->entries = NULL;
+    dec->count = dec->capacity = 0;
+}
+
+size_t huffman_write_lengths(const uint8_t lengths[], int num_symbols, unsigned char* dst) {
+    size_t bitmap_size = ((size_t)num_symbols + 7) / 8;
+    memset(dst, 0, HUFFMAN_LENGTHS_SIZE(num_symbols));
+    size_t present = 0;
+    for (int i = 0; i < num_symbols; i++) {
+        if (lengths[i] == 0) continue;
+        dst[i / 8] |= (unsigned char)(1 << (i % 8));
+        dst[bitmap_size + present / 2] |= (unsigned char)(lengths[i] << (4 * (present % 2)));
+        present++;
+    }
+    return bitmap_size + (present + 1) / 2;
+}
+
+size_t huffman_lengths_size(const unsigned char* bitmap, int num_symbols) {
+    size_t bitmap_size = ((size_t)num_symbols + 7) / 8;
+    size_t present = 0;
+    for (size_t i = 0; i < bitmap_size; i++) present += (size_t)__builtin_popcount(bitmap[i]);
+    return bitmap_size + (present + 1) / 2;
+}
+
+size_t huffman_read_lengths(const unsigned char* src, size_t size, int num_symbols, uint8_t lengths[]) {
+    size_t bitmap_size = ((size_t)num_symbols + 7) / 8;
+    if (size < bitmap_size) return 0;
+    size_t table_size = huffman_lengths_size(src, num_symbols);
+    if (size < table_size) return 0;
+
+    size_t next = 0;
+    for (int i = 0; i < num_symbols; i++) {
+        lengths[i] = 0;
+        if (!((src[i / 8] >> (i % 8)) & 1)) continue;
+        lengths[i] = (src[bitmap_size + next / 2] >> (4 * (next % 2))) & 0x0F;
+        if (lengths[i] == 0) return 0; // Ký hiệu có mặt phải có mã
+        next++;
+    }
+    return table_size;
+}
+
+size_t huffman_encode_streams(const HuffmanCode codes[HUFFMAN_SYMBOLS], const unsigned char* src, size_t size, unsigned char* dst) {
+    size_t segment = (size + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    unsigned char* out = dst + HUFFMAN_JUMP_TABLE_SIZE;
+    for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t begin = stream_begin(segment, size, k);
+        size_t end = stream_begin(segment, size, k + 1);
+        unsigned char* stream = out;
+        BitWriter writer = {0, 0};
+        out += encode_symbols(&writer, codes, src + begin, end - begin, out);
+        out += flush_bits(&writer, out);
+        if (k < HUFFMAN_STREAMS - 1) write_le32(dst + 4 * k, (uint32_t)(out - stream));
+    }
+    return (size_t)(out - dst);
+}
+
+int huffman_decode_streams(const HuffmanDecoder* dec, const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size) {
+    if (size < HUFFMAN_JUMP_TABLE_SIZE) return -1;
+
+    // 1. Chia dữ liệu theo bảng nhảy; luồng cuối nhận phần còn lại
+    BitReader readers[HUFFMAN_STREAMS];
+    unsigned char* outs[HUFFMAN_STREAMS];
+    size_t counts[HUFFMAN_STREAMS];
+    size_t segment = (raw_size + HUFFMAN_STREAMS - 1) / HUFFMAN_STREAMS;
+    const unsigned char* pos = src + HUFFMAN_JUMP_TABLE_SIZE;
+    const unsigned char* end = src + size;
+    for (int k = 0; k < HUFFMAN_STREAMS; k++) {
+        size_t stream_size = k < HUFFMAN_STREAMS - 1 ? read_le32(src + 4 * k) : (size_t)(end - pos);
+        if (stream_size > (size_t)(end - pos)) return -1;
+        // Dữ liệu đã nằm trọn trong bộ nhớ: bộ đọc không có tệp, coi như đã hết tệp từ đầu
+        memset(&readers[k], 0, sizeof(BitReader));
+        readers[k].pos = pos;
+        readers[k].end = pos + stream_size;
+        readers[k].eof = 1;
+        pos += stream_size;
+        size_t begin = stream_begin(segment, raw_size, k);
+        outs[k] = dst + begin;
+        counts[k] = stream_begin(segment, raw_size, k + 1) - begin;
+    }
+
+    // 2. Giải mã xen kẽ cho đến khi một luồng gần hết dữ liệu, rồi giải mã phần còn lại của từng luồng
+    int result = decode_interleaved(readers, dec, outs, counts);
+    for (int k = 0; k < HUFFMAN_STREAMS && result == 0; k++) {
+        result = decode_symbols(&readers[k], dec, outs[k], counts[k], NULL);
+    }
+    return result;
+}
+
+size_t huffman_encode_block(const unsigned char* src, size_t size, unsigned char* dst) {
+    uint64_t freq[HUFFMAN_SYMBOLS] = {0};
+    for (size_t i = 0; i < size; i++) freq[src[i]]++;
+
+    uint8_t lengths[HUFFMAN_SYMBOLS];
+    huffman_build_lengths(freq, HUFFMAN_SYMBOLS, HUFFMAN_MAX_CODE_LENGTH, lengths);
+    size_t table_size = huffman_write_lengths(lengths, HUFFMAN_SYMBOLS, dst);
+
+    HuffmanCode codes[HUFFMAN_SYMBOLS];
+    huffman_canonical_codes(lengths, HUFFMAN_SYMBOLS, codes);
+    return table_size + huffman_encode_streams(codes, src, size, dst + table_size);
+}
+
+int huffman_decode_block(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size) {
+    uint8_t lengths[HUFFMAN_SYMBOLS];
+    size_t table_size = huffman_read_lengths(src, size, HUFFMAN_SYMBOLS, lengths);
+    if (table_size == 0) return -1;
+    if (raw_size == 0) return 0;
+
+    HuffmanDecoder dec;
+    if (huffman_decoder_from_lengths(&dec, lengths, HUFFMAN_SYMBOLS) != 0) return -1;
+    int result = huffman_decode_streams(&dec, src + table_size, size - table_size, dst, raw_size);
+    huffman_decoder_free(&dec);
+    return result;
+}
+
+int huffman_decode_stream(FILE* input, FILE* output, const HuffmanDecoder* dec, uint64_t count) {
+    BitReader reader;
+    memset(&reader, 0, sizeof(BitReader));
+    reader.file = input;
+    reader.buffer = (unsigned char*)malloc(HUFFMAN_IO_BUFFER);
+    reader.pos = reader.end = reader.buffer;
+    unsigned char* out_buffer = (unsigned char*)malloc(HUFFMAN_IO_BUFFER);
+    if (reader.buffer == NULL || out_buffer == NULL) {
+        free(reader.buffer);
+        free(out_buffer);
+        return -1;
+    }
+
+    uint64_t remaining = count;
+    int result = 0;
+    while (remaining > 0 && result == 0) {
+        size_t batch = remaining < HUFFMAN_IO_BUFFER ? (size_t)remaining : HUFFMAN_IO_BUFFER;
+        size_t valid;
+        result = decode_symbols(&reader, dec, out_buffer, batch, &valid);
+        // Tệp bị cắt cụt hoặc hỏng: chỉ ghi các ký hiệu giải mã từ dữ liệu thật rồi dừng,
+        // thay vì tiếp tục giải mã phần đệm 0 cho tới kích thước trong header
+        if (fwrite(out_buffer, 1, valid, output) != valid) result = -1;
+        remaining -= batch;
+    }
+
+    free(reader.buffer);
+    free(out_buffer);
+    return result;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+static int compare_package_items(const void* a, const void* b) {
+    const PackageItem* x = (const PackageItem*)a;
+    const PackageItem* y = (const PackageItem*)b;
+    if (x->weight != y->weight) return x->weight < y->weight ? -1 : 1;
+    return x->symbol - y->symbol;
+}
+
+/**
+ * @brief Mở một phần tử được chọn của package-merge: lá thì tăng độ dài mã, gói thì mở hai phần tử con.
+ */
+static void count_package_lengths(PackageItem* const lists[], int level, int index, uint8_t lengths[]) {
+    const PackageItem* item = &lists[level][index];
+    if (item->symbol >= 0) {
+        lengths[item->symbol]++;
+        return;
+    }
+    count_package_lengths(lists, level + 1, item->first, lengths);
+    count_package_lengths(lists, level + 1, item->first + 1, lengths);
+}
+
+static HuffmanNode* create_node(HuffmanNodePool* pool, unsigned char data, unsigned int freq) {
+    HuffmanNode* node = &pool->nodes[pool->count++];
+    node->left = node->right = NULL;
+    node->data = data;
+    node->freq = freq;
+    return node;
+}
+
+static void min_heapify(MinHeap* minHeap, int idx) {
+    int smallest = idx;
+    unsigned int left = 2 * idx + 1;
+    unsigned int right = 2 * idx + 2;
+    // Kiểm tra khoảng bên trái và phải có vượt quá kích thước không và so sánh tần số
+    // của các node con với node hiện tại
+    if (left < minHeap->size && minHeap->array[left]->freq < minHeap->array[smallest]->freq)
+        smallest = left;
+    if (right < minHeap->size && minHeap->array[right]->freq < minHeap->array[smallest]->freq)
+        smallest = right;
+
+    // Nếu node hiện tại không phải là nhỏ nhất, hoán đổi và tiếp tục heapify
+    if (smallest != idx) {
+        HuffmanNode* t = minHeap->array[smallest];
+        minHeap->array[smallest] = minHeap->array[idx];
+        minHeap->array[idx] = t;
+        min_heapify(minHeap, smallest);
+    }
+}
+
+static HuffmanNode* extract_min(MinHeap* minHeap) {
+    HuffmanNode* temp = minHeap->array[0];
+    minHeap->array[0] = minHeap->array[minHeap->size - 1];
+    --minHeap->size;
+    min_heapify(minHeap, 0);
+    return temp;
+}
+
+static void insert_node(MinHeap* minHeap, HuffmanNode* node) {
+    ++minHeap->size;
+    int i = minHeap->size - 1;
+    while (i && node->freq < minHeap->array[(i - 1) / 2]->freq) {
+        minHeap->array[i] = minHeap->array[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    minHeap->array[i] = node;
+}
+
+/**
+ * @brief Dựng lại cây của định dạng cũ. Thứ tự lấy/chèn min-heap phải giữ nguyên như bộ nén cũ
+ * vì hình dạng cây (và do đó mã) phụ thuộc vào cách phân xử các tần suất bằng nhau.
+ * @return Gốc của cây, hoặc NULL nếu không có ký hiệu nào.
+ */
+static HuffmanNode* build_huffman_tree(HuffmanNodePool* pool, const unsigned int freq[]) {
+    MinHeap minHeap;
+    minHeap.size = 0;
+    pool->count = 0;
+    for (int i = 0; i < HUFFMAN_SYMBOLS; ++i) {
+        if (freq[i]) {
+            insert_node(&minHeap, create_node(pool, (unsigned char)i, freq[i]));
+        }
+    }
+    if (minHeap.size == 0) return NULL;
+
+    // Trường hợp đặc biệt: chỉ có 1 ký tự duy nhất
+    if (minHeap.size == 1) {
+        HuffmanNode* single_node = extract_min(&minHeap);
+        // Tạo một root giả với node đó làm con trái
+        HuffmanNode* root = create_node(pool, '$', single_node->freq);
+        root->left = single_node;
+        root->right = NULL;
+        return root;
+    }
+
+    while (minHeap.size > 1) {
+        HuffmanNode* left = extract_min(&minHeap);
+        HuffmanNode* right = extract_min(&minHeap);
+
+        // Tạo node nội, data có thể là ký tự đặc biệt như '$'
+        HuffmanNode* top = create_node(pool, '$', left->freq + right->freq);
+        top->left = left;
+        top->right = right;
+        insert_node(&minHeap, top);
+    }
+
+    return extract_min(&minHeap);
+}
+
+/**
+ * @brief Chiều cao cây (độ dài mã dài nhất trong cây con).
+ */
+static int huffman_tree_height(const HuffmanNode* node) {
+    if (node == NULL || (node->left == NULL && node->right == NULL)) return 0;
+    int left = huffman_tree_height(node->left);
+    int right = huffman_tree_height(node->right);
+    return 1 + (left > right ? left : right);
+}
+
+/**
+ * @brief Ghi các ô của cây con `node` (đã đọc `depth` bit với giá trị `prefix`) vào bảng bắt đầu tại `table`.
+ */
+static int huffman_decoder_fill(HuffmanDecoder* dec, size_t table, int table_bits, const HuffmanNode* node, int depth, uint32_t prefix) {
+    if (node == NULL) return 0; // Nhánh trống (cây một ký hiệu): các ô giữ giá trị không hợp lệ
+
+    if (node->left == NULL && node->right == NULL) {
+        size_t first = table + ((size_t)prefix << (table_bits - depth));
+        size_t span = (size_t)1 << (table_bits - depth);
+        for (size_t i = 0; i < span; i++) {
+            dec->entries[first + i].value = node->data;
+            dec->entries[first + i].length = (uint8_t)depth;
+            dec->entries[first + i].kind = HUFFMAN_ENTRY_LEAF;
+        }
+        return 0;
+    }
+
+    if (depth == table_bits) {
+        // Đã hết bit của bảng này: tạo bảng con cho phần còn lại của cây con
+        int height = huffman_tree_height(node);
+        int sub_bits = height < HUFFMAN_TABLE_BITS ? height : HUFFMAN_TABLE_BITS;
+        size_t sub = dec->count;
+        size_t needed = sub + ((size_t)1 << sub_bits);
+        if (needed > dec->capacity) {
+            size_t capacity = dec->capacity * 2 > needed ? dec->capacity * 2 : needed;
+            HuffmanDecodeEntry* grown = (HuffmanDecodeEntry*)realloc(dec->entries, capacity * sizeof(HuffmanDecodeEntry));
+            if (grown == NULL) return -1;
+            memset(grown + dec->capacity, 0, (capacity - dec->capacity) * sizeof(HuffmanDecodeEntry));
+            dec->entries = grown;
+            dec->capacity = capacity;
+        }
+        dec->count = needed;
+
+        HuffmanDecodeEntry* link = &dec->entries[table + prefix];
+        link->value = (uint32_t)sub;
+        link->length = (uint8_t)table_bits;
+        link->sub_bits = (uint8_t)sub_bits;
+        link->kind = HUFFMAN_ENTRY_LINK;
+        return huffman_decoder_fill(dec, sub, sub_bits, node, 0, 0);
+    }
+
+    if (huffman_decoder_fill(dec, table, table_bits, node->left, depth + 1, prefix << 1) != 0) return -1;
+    return huffman_decoder_fill(dec, table, table_bits, node->right, depth + 1, (prefix << 1) | 1);
+}
+
+/**
+ * @brief Nạp bit cho đến khi có ít nhất 56 bit hợp lệ.
+ * Khi còn từ 8 byte trở lên trong bộ đệm, nạp bằng một lần đọc 64 bit; các bit thừa phía dưới
+ * chính là các bit kế tiếp nên lần nạp sau ghi đè lên chúng bằng cùng giá trị. Hết dữ liệu thì nạp byte 0.
+ */
+static void bit_reader_refill(BitReader* r) {
+    if (r->end - r->pos < 8 && !r->eof) {
+        size_t left = (size_t)(r->end - r->pos);
+        memmove(r->buffer, r->pos, left);
+        size_t got = fread(r->buffer + left, 1, HUFFMAN_IO_BUFFER - left, r->file);
+        if (got == 0) r->eof = 1;
+        r->pos = r->buffer;
+        r->end = r->buffer + left + got;
+    }
+
+    if (r->end - r->pos >= 8) {
+        uint64_t word;
+        memcpy(&word, r->pos, 8);
+        r->bits |= __builtin_bswap64(word) >> r->count;
+        r->pos += (63 - r->count) >> 3;
+        r->count |= 56;
+        return;
+    }
+
+    while (r->count <= 56) {
+        uint64_t byte = 0;
+        if (r->pos < r->end) byte = *r->pos++;
+        else r->padding++;
+        r->bits |= byte << (56 - r->count);
+        r->count += 8;
+    }
+}
+
+/**
+ * @brief Mã hóa size ký hiệu vào out; đủ 32 bit thì ghi nguyên một từ (big-endian).
+ * out cần ít nhất size * HUFFMAN_MAX_CODE_LENGTH / 8 + 4 byte.
+ * @return Số byte đã ghi; các bit lẻ còn lại nằm trong w cho lần gọi sau.
+ */
+static size_t encode_symbols(BitWriter* w, const HuffmanCode codes[], const unsigned char* src, size_t size, unsigned char* out) {
+    uint64_t acc = w->acc;
+    int acc_bits = w->bits;
+    unsigned char* start = out;
+    for (size_t i = 0; i < size; i++) {
+        const HuffmanCode* hc = &codes[src[i]];
+        acc |= (uint64_t)hc->code << (64 - acc_bits - hc->length);
+        acc_bits += hc->length;
+        if (acc_bits >= 32) {
+            uint32_t word = __builtin_bswap32((uint32_t)(acc >> 32));
+            memcpy(out, &word, 4);
+            out += 4;
+            acc <<= 32;
+            acc_bits -= 32;
+        }
+    }
+    w->acc = acc;
+    w->bits = acc_bits;
+    return (size_t)(out - start);
+}
+
+/**
+ * @brief Ghi các bit còn chờ, đệm bit 0 cho đủ byte.
+ * @return Số byte đã ghi (0..4).
+ */
+static size_t flush_bits(BitWriter* w, unsigned char* out) {
+    size_t written = 0;
+    while (w->bits > 0) {
+        out[written++] = (unsigned char)(w->acc >> 56);
+        w->acc <<= 8;
+        w->bits -= 8;
+    }
+    w->acc = 0;
+    w->bits = 0;
+    return written;
+}
+
+/**
+ * @brief Giải mã đúng count ký hiệu vào out, chỉ nạp lại khi số bit còn lại có thể không đủ cho mã dài nhất.
+ * Trạng thái bộ đọc được giữ trong biến cục bộ: ghi qua con trỏ byte khiến trình biên dịch
+ * phải đọc lại mọi thứ nằm trong bộ nhớ sau mỗi ký hiệu.
+ * Các bit đã dùng không được vượt quá dữ liệu thật (phần đệm 0 giả chỉ để đọc trước); điều này được kiểm tra
+ * ở mỗi lần nạp lại nên dữ liệu cắt cụt bị phát hiện ngay, không phải sau khi đã giải mã đủ count ký hiệu.
+ * @param valid Nhận số ký hiệu đầu của out chắc chắn được giải mã từ dữ liệu thật (bằng count nếu thành công), hoặc NULL.
+ * @return 0 nếu thành công, -1 nếu gặp mã không hợp lệ hoặc đọc quá dữ liệu thật.
+ */
+static int decode_symbols(BitReader* r, const HuffmanDecoder* dec, unsigned char* out, size_t count, size_t* valid) {
+    const HuffmanDecodeEntry* table = dec->entries;
+    const int root_shift = 64 - dec->root_bits;
+    const int max_length = dec->max_length;
+    uint64_t bits = r->bits;
+    int bit_count = r->count;
+    unsigned char* start = out;
+    unsigned char* checked = out; // Mọi ký hiệu trước vị trí này chỉ dùng bit của dữ liệu thật
+    unsigned char* out_end = out + count;
+    int result = 0;
+    while (out < out_end) {
+        if (bit_count < max_length) {
+            if (r->padding * 8 > (size_t)bit_count) {
+                result = -1;
+                break;
+            }
+            checked = out;
+            r->bits = bits;
+            r->count = bit_count;
+            bit_reader_refill(r);
+            bits = r->bits;
+            bit_count = r->count;
+        }
+        const HuffmanDecodeEntry* e = &table[bits >> root_shift];
+        while (e->kind == HUFFMAN_ENTRY_LINK) {
+            int sub_bits = e->sub_bits;
+            bits <<= e->length;
+            bit_count -= e->length;
+            e = &table[e->value + (bits >> (64 - sub_bits))];
+        }
+        if (e->kind != HUFFMAN_ENTRY_LEAF) {
+            result = -1;
+            break;
+        }
+        bits <<= e->length;
+        bit_count -= e->length;
+        *out++ = (unsigned char)e->value;
+    }
+    if (result == 0 && r->padding * 8 > (size_t)bit_count) result = -1;
+    if (result == 0) checked = out;
+    r->bits = bits;
+    r->count = bit_count;
+    if (valid != NULL) *valid = (size_t)(checked - start);
+    return result;
+}
+
+/**
+ * @brief Giải mã HUFFMAN_STREAMS (= 4) luồng trong cùng một vòng lặp, mỗi vòng 4 ký hiệu từ mỗi luồng.
+ * Mỗi luồng nạp lại 8 byte một lần nên có ít nhất 56 bit, đủ cho 4 mã dài tối đa HUFFMAN_MAX_CODE_LENGTH bit:
+ * trong vòng lặp không có nhánh nào phụ thuộc dữ liệu. Mã không hợp lệ (ô rỗng, độ dài 0) chỉ được ghi nhận
+ * vào `valid` thay vì rẽ nhánh. Vòng lặp dừng khi một luồng còn dưới 8 byte hoặc dưới 4 ký hiệu;
+ * trạng thái được ghi lại vào readers, outs, counts để decode_symbols làm nốt.
+ * @return 0 nếu thành công, -1 nếu gặp mã không hợp lệ.
+ */
+static int decode_interleaved(BitReader readers[HUFFMAN_STREAMS], const HuffmanDecoder* dec, unsigned char* outs[HUFFMAN_STREAMS], size_t counts[HUFFMAN_STREAMS]) {
+    if (dec->root_bits != dec->max_length || dec->max_length * 4 > 56) return 0;
+
+    const HuffmanDecodeEntry* table = dec->entries;
+    const int shift = 64 - dec->root_bits;
+    BitReader* r0 = &readers[0];
+    BitReader* r1 = &readers[1];
+    BitReader* r2 = &readers[2];
+    BitReader* r3 = &readers[3];
+    const unsigned char *p0 = r0->pos, *p1 = r1->pos, *p2 = r2->pos, *p3 = r3->pos;
+    uint64_t b0 = r0->bits, b1 = r1->bits, b2 = r2->bits, b3 = r3->bits;
+    int c0 = r0->count, c1 = r1->count, c2 = r2->count, c3 = r3->count;
+    unsigned char *o0 = outs[0], *o1 = outs[1], *o2 = outs[2], *o3 = outs[3];
+
+    // Số vòng bị chặn bởi luồng ít ký hiệu nhất (luồng cuối)
+    size_t rounds = counts[HUFFMAN_STREAMS - 1];
+    for (int k = 0; k < HUFFMAN_STREAMS - 1; k++) {
+        if (counts[k] < rounds) rounds = counts[k];
+    }
+    rounds /= 4;
+
+    unsigned int valid = HUFFMAN_ENTRY_LEAF;
+    size_t done = 0;
+    for (; done < rounds; done++) {
+        if (r0->end - p0 < 8 || r1->end - p1 < 8 || r2->end - p2 < 8 || r3->end - p3 < 8) break;
+        uint64_t w0, w1, w2, w3;
+        memcpy(&w0, p0, 8);
+        memcpy(&w1, p1, 8);
+        memcpy(&w2, p2, 8);
+        memcpy(&w3, p3, 8);
+        b0 |= __builtin_bswap64(w0) >> c0;
+        b1 |= __builtin_bswap64(w1) >> c1;
+        b2 |= __builtin_bswap64(w2) >> c2;
+        b3 |= __builtin_bswap64(w3) >> c3;
+        p0 += (63 - c0) >> 3;
+        p1 += (63 - c1) >> 3;
+        p2 += (63 - c2) >> 3;
+        p3 += (63 - c3) >> 3;
+        c0 |= 56;
+        c1 |= 56;
+        c2 |= 56;
+        c3 |= 56;
+
+        for (int j = 0; j < 4; j++) {
+            const HuffmanDecodeEntry* e0 = &table[b0 >> shift];
+            const HuffmanDecodeEntry* e1 = &table[b1 >> shift];
+            const HuffmanDecodeEntry* e2 = &table[b2 >> shift];
+            const HuffmanDecodeEntry* e3 = &table[b3 >> shift];
+            valid &= e0->kind & e1->kind & e2->kind & e3->kind;
+            b0 <<= e0->length;
+            b1 <<= e1->length;
+            b2 <<= e2->length;
+            b3 <<= e3->length;
+            c0 -= e0->length;
+            c1 -= e1->length;
+            c2 -= e2->length;
+            c3 -= e3->length;
+            o0[j] = (unsigned char)e0->value;
+            o1[j] = (unsigned char)e1->value;
+            o2[j] = (unsigned char)e2->value;
+            o3[j] = (unsigned char)e3->value;
+        }
+        o0 += 4;
+        o1 += 4;
+        o2 += 4;
+        o3 += 4;
+    }
+
+    r0->pos = p0;
+    r0->bits = b0;
+    r0->count = c0;
+    r1->pos = p1;
+    r1->bits = b1;
+    r1->count = c1;
+    r2->pos = p2;
+    r2->bits = b2;
+    r2->count = c2;
+    r3->pos = p3;
+    r3->bits = b3;
+    r3->count = c3;
+    outs[0] = o0;
+    outs[1] = o1;
+    outs[2] = o2;
+    outs[3] = o3;
+    for (int k = 0; k < HUFFMAN_STREAMS; k++) counts[k] -= done * 4;
+    return valid == HUFFMAN_ENTRY_LEAF ? 0 : -1;
+}
+
+/**
+ * @brief Vị trí ký hiệu đầu tiên của luồng k khi chia size ký hiệu thành các đoạn segment ký hiệu.
+ */
+static size_t stream_begin(size_t segment, size_t size, int k) {
+    size_t begin = segment * (size_t)k;
+    return begin < size ? begin : size;
+}
+
+static void write_le32(unsigned char* p, uint32_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+static uint32_t read_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
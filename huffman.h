@@ -0,0 +1,143 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HUFFMAN_SYMBOLS          256
+// Số ký hiệu tối đa của một bảng mã (bảng literal/độ dài của LZH có nhiều hơn 256 ký hiệu)
+#define HUFFMAN_MAX_SYMBOLS      512
+// Độ dài mã tối đa của định dạng chuẩn tắc: bảng giải mã chỉ cần một mức 2^12 ô
+#define HUFFMAN_MAX_CODE_LENGTH  12
+// Số bit tra ở bảng chính khi dựng bảng giải mã từ cây (định dạng cũ, mã có thể dài tùy ý)
+#define HUFFMAN_TABLE_BITS       11
+#define HUFFMAN_IO_BUFFER        (1 << 20)
+// Kích thước tối đa của bảng độ dài mã đã tuần tự hóa cho n ký hiệu: bitmap + 4 bit cho mỗi ký hiệu
+#define HUFFMAN_LENGTHS_SIZE(n)  (((size_t)(n) + 7) / 8 + ((size_t)(n) + 1) / 2)
+#define HUFFMAN_LENGTHS_MAX_SIZE HUFFMAN_LENGTHS_SIZE(HUFFMAN_SYMBOLS)
+// Số luồng bit độc lập của một khối: bộ giải mã đọc xen kẽ cả 4 luồng trong cùng một vòng lặp
+#define HUFFMAN_STREAMS          4
+// Bảng nhảy: kích thước (byte) của HUFFMAN_STREAMS - 1 luồng đầu, mỗi giá trị 4 byte little-endian
+#define HUFFMAN_JUMP_TABLE_SIZE  (4 * (HUFFMAN_STREAMS - 1))
+// Dung lượng đích cần cho huffman_encode_streams với n byte đầu vào (mỗi luồng đệm tối đa 1 byte)
+#define HUFFMAN_STREAMS_BOUND(n) (HUFFMAN_JUMP_TABLE_SIZE + ((size_t)(n) * HUFFMAN_MAX_CODE_LENGTH + 7) / 8 + HUFFMAN_STREAMS + 4)
+// Dung lượng đích cần cho huffman_encode_block với n byte đầu vào
+#define HUFFMAN_BLOCK_BOUND(n)   (HUFFMAN_LENGTHS_MAX_SIZE + HUFFMAN_STREAMS_BOUND(n))
+
+/**
+ * @brief Mã của một ký hiệu: `length` bit thấp của `code`, bit đầu tiên của mã là bit cao nhất trong số đó.
+ */
+typedef struct {
+    uint32_t code;
+    uint8_t length;
+} HuffmanCode;
+
+enum { HUFFMAN_ENTRY_INVALID, HUFFMAN_ENTRY_LEAF, HUFFMAN_ENTRY_LINK };
+
+typedef struct {
+    uint32_t value;   // Ký hiệu (lá) hoặc vị trí bắt đầu của bảng con (liên kết)
+    uint8_t length;   // Số bit tiêu thụ ở bảng này
+    uint8_t sub_bits; // Số bit chỉ mục của bảng con (chỉ dùng cho liên kết)
+    uint8_t kind;
+} HuffmanDecodeEntry;
+
+/**
+ * @brief Bảng giải mã nhiều bit: ô của bảng chính ứng với root_bits bit tiếp theo của dữ liệu.
+ * Mã ngắn chiếm mọi ô có cùng tiền tố, mã dài hơn bảng chính đi tiếp qua bảng con.
+ */
+typedef struct {
+    HuffmanDecodeEntry* entries; // Bảng chính ở đầu, các bảng con nối tiếp phía sau
+    size_t count;
+    size_t capacity;
+    int root_bits;
+    int max_length; // Độ dài mã dài nhất
+} HuffmanDecoder;
+
+/**
+ * @brief Tính độ dài mã tối ưu với giới hạn max_length bằng thuật toán package-merge.
+ * @param num_symbols Số ký hiệu của bảng (tối đa HUFFMAN_MAX_SYMBOLS).
+ * @param max_length Độ dài tối đa (9..32, để mọi ký hiệu luôn có mã).
+ * @param lengths Nhận độ dài mã của từng ký hiệu (0 nếu không xuất hiện; 1 nếu chỉ có một ký hiệu).
+ */
+void huffman_build_lengths(const uint64_t freq[], int num_symbols, int max_length, uint8_t lengths[]);
+
+/**
+ * @brief Gán mã chuẩn tắc: mã tăng dần theo (độ dài, ký hiệu), nên chỉ cần lưu độ dài để dựng lại.
+ */
+void huffman_canonical_codes(const uint8_t lengths[], int num_symbols, HuffmanCode codes[]);
+
+/**
+ * @brief Dựng bảng giải mã một mức từ độ dài mã chuẩn tắc.
+ * @return 0 nếu thành công, -1 nếu độ dài vượt HUFFMAN_MAX_CODE_LENGTH, vi phạm bất đẳng thức Kraft,
+ * không có ký hiệu nào hoặc hết bộ nhớ.
+ */
+int huffman_decoder_from_lengths(HuffmanDecoder* dec, const uint8_t lengths[], int num_symbols);
+
+/**
+ * @brief Dựng bảng giải mã cho định dạng "HUFF" cũ: cây được tạo lại từ bảng tần suất
+ * theo đúng thứ tự min-heap của bộ nén cũ.
+ * @return 0 nếu thành công, -1 nếu không có ký hiệu nào, mã dài hơn 56 bit hoặc hết bộ nhớ.
+ */
+int huffman_decoder_from_frequencies(HuffmanDecoder* dec, const unsigned int freq[HUFFMAN_SYMBOLS]);
+
+void huffman_decoder_free(HuffmanDecoder* dec);
+
+/**
+ * @brief Tuần tự hóa độ dài mã: bitmap (num_symbols + 7) / 8 byte các ký hiệu có mặt (bit i % 8 của byte i / 8),
+ * rồi độ dài của các ký hiệu đó theo thứ tự tăng dần, mỗi độ dài 4 bit (4 bit thấp trước).
+ * @param dst Cần ít nhất HUFFMAN_LENGTHS_SIZE(num_symbols) byte.
+ * @return Số byte đã ghi.
+ */
+size_t huffman_write_lengths(const uint8_t lengths[], int num_symbols, unsigned char* dst);
+
+/**
+ * @brief Kích thước của bảng độ dài mã, tính từ bitmap ở đầu bảng.
+ */
+size_t huffman_lengths_size(const unsigned char* bitmap, int num_symbols);
+
+/**
+ * @brief Đọc bảng độ dài mã do huffman_write_lengths ghi.
+ * @return Số byte đã đọc, hoặc 0 nếu bảng bị cắt cụt hoặc có ký hiệu mang độ dài 0.
+ */
+size_t huffman_read_lengths(const unsigned char* src, size_t size, int num_symbols, uint8_t lengths[]);
+
+/**
+ * @brief Mã hóa size ký hiệu thành HUFFMAN_STREAMS luồng bit độc lập: luồng k chứa đoạn thứ k
+ * (mỗi đoạn (size + 3) / 4 ký hiệu liên tiếp, đoạn cuối nhận phần còn lại), mỗi luồng đệm 0 cho đủ byte.
+ * Dữ liệu gồm bảng nhảy (HUFFMAN_JUMP_TABLE_SIZE byte) rồi các luồng nối tiếp nhau.
+ * @param dst Cần ít nhất HUFFMAN_STREAMS_BOUND(size) byte.
+ * @return Số byte đã ghi.
+ */
+size_t huffman_encode_streams(const HuffmanCode codes[HUFFMAN_SYMBOLS], const unsigned char* src, size_t size, unsigned char* dst);
+
+/**
+ * @brief Giải mã dữ liệu do huffman_encode_streams tạo ra. Phần lớn ký hiệu được giải mã xen kẽ:
+ * các luồng không phụ thuộc nhau nên CPU xử lý song song 4 chuỗi tra bảng thay vì chờ từng ký hiệu.
+ * @param dec Bảng giải mã một mức (huffman_decoder_from_lengths).
+ * @param raw_size Số ký hiệu cần giải mã.
+ * @return 0 nếu thành công, -1 nếu dữ liệu hỏng.
+ */
+int huffman_decode_streams(const HuffmanDecoder* dec, const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+
+/**
+ * @brief Nén một khối trong bộ nhớ với bảng mã riêng: bảng độ dài mã rồi dữ liệu của huffman_encode_streams.
+ * @param dst Cần ít nhất HUFFMAN_BLOCK_BOUND(size) byte.
+ * @return Số byte đã ghi.
+ */
+size_t huffman_encode_block(const unsigned char* src, size_t size, unsigned char* dst);
+
+/**
+ * @brief Giải nén một khối do huffman_encode_block tạo ra.
+ * @param raw_size Số byte gốc của khối (được lưu riêng bởi định dạng chứa khối).
+ * @return 0 nếu thành công, -1 nếu dữ liệu hỏng hoặc hết bộ nhớ.
+ */
+int huffman_decode_block(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+
+/**
+ * @brief Giải mã đúng `count` ký hiệu từ một luồng bit duy nhất của input (định dạng HUFF) và ghi ra output.
+ * @return 0 nếu thành công, -1 nếu dữ liệu hỏng, thiếu hoặc lỗi ghi.
+ */
+int huffman_decode_stream(FILE* input, FILE* output, const HuffmanDecoder* dec, uint64_t count);
+
+#endif // HUFFMAN_H
@@ -0,0 +1,412 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "invindex.h"
+#include "hashtable.h"
+#include "report.h"
+#include "search.h"
+#include "tokenizer.h"
+
+#define INDEX_HEADER_SIZE 48
+#define INDEX_DIRECTORY_ENTRY_SIZE 32
+#define INDEX_VOCABULARY_TABLE_SIZE 65521
+
+// Danh sách vị trí của một từ trong lúc tạo chỉ mục
+typedef struct {
+    unsigned char* data;   // Các bộ ba (thứ tự từ, dòng, byte) đã mã hóa hiệu số + varint
+    size_t size;
+    size_t capacity;
+    uint32_t occurrences;
+    uint64_t last_position;
+    uint64_t last_line;
+    uint64_t last_offset;
+} TermPostings;
+
+// Một từ trong từ điển, dùng để sắp xếp trước khi ghi
+typedef struct {
+    const char* word;
+    uint32_t id;
+} IndexTerm;
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static size_t encode_varint(unsigned char* out, uint64_t value);
+static const unsigned char* decode_varint(const unsigned char* p, const unsigned char* end, uint64_t* value);
+static int postings_append(TermPostings* postings, uint64_t position, uint64_t line, uint64_t offset);
+static int compare_index_terms(const void* a, const void* b);
+static uint32_t read_u32le(const unsigned char* p);
+static uint64_t read_u64le(const unsigned char* p);
+static const unsigned char* lookup_term(const InvertedIndex* index, const char* term, size_t length);
+static Posting* decode_postings(const InvertedIndex* index, const unsigned char* entry, size_t* count);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+int index_build(const char* source_filename, const char* index_filename, int case_sensitive, IndexBuildStats* stats) {
+    struct stat source_stat;
+    MappedFile source;
+    if (stat(source_filename, &source_stat) != 0 || map_file(source_filename, &source) != 0) return -1;
+
+    HashTable* vocabulary = create_table(INDEX_VOCABULARY_TABLE_SIZE);
+    TermPostings* terms = NULL;
+    uint32_t term_count = 0, term_capacity = 0;
+    char* word = NULL;
+    size_t word_capacity = 0;
+    int result = 0;
+
+    // --- Tách từ và ghi lại vị trí; số dòng được đếm trên các đoạn phân tách giữa hai từ ---
+    const char* data = source.data;
+    const char* end = source.data + source.size;
+    const char* cursor = data;
+    const char* counted_upto = data;
+    uint64_t line = 1, position = 0;
+    size_t length;
+    const char* token;
+    while (result == 0 && (token = next_token_span(&cursor, end, &length)) != NULL) {
+        line += count_newlines(counted_upto, token);
+        counted_upto = token;
+
+        if (length + 1 > word_capacity) {
+            word_capacity = (length + 1) * 2;
+            char* grown = (char*)realloc(word, word_capacity);
+            if (grown == NULL) { result = -1; break; }
+            word = grown;
+        }
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = (unsigned char)token[i];
+            word[i] = (char)(case_sensitive ? c : search_fold_table[c]);
+        }
+        word[length] = '\0';
+
+        // Bảng băm từ vựng ánh xạ từ -> mã số từ + 1 (lưu trong trường count)
+        uint32_t id;
+        Entry* entry = ht_lookup(vocabulary, word);
+        if (entry != NULL) {
+            id = (uint32_t)(entry->count - 1);
+        } else {
+            if (term_count == term_capacity) {
+                term_capacity = term_capacity == 0 ? 1024 : term_capacity * 2;
+                TermPostings* grown = (TermPostings*)realloc(terms, term_capacity * sizeof(TermPostings));
+                if (grown == NULL) { result = -1; break; }
+                terms = grown;
+            }
+            id = term_count++;
+            memset(&terms[id], 0, sizeof(TermPostings));
+            ht_add(vocabulary, word, (int)id + 1);
+        }
+
+        if (postings_append(&terms[id], position, line, (uint64_t)(token - data)) != 0) result = -1;
+        position++;
+    }
+    free(word);
+
+    // --- Sắp xếp từ điển để tra cứu bằng tìm kiếm nhị phân ---
+    IndexTerm* sorted = NULL;
+    if (result == 0) {
+        sorted = (IndexTerm*)malloc((term_count > 0 ? term_count : 1) * sizeof(IndexTerm));
+        if (sorted == NULL) result = -1;
+    }
+    if (result == 0) {
+        uint32_t n = 0;
+        for (int i = 0; i < vocabulary->size; i++) {
+            for (Entry* entry = vocabulary->entries[i]; entry != NULL; entry = entry->next) {
+                sorted[n].word = entry->word;
+                sorted[n].id = (uint32_t)(entry->count - 1);
+                n++;
+            }
+        }
+        qsort(sorted, term_count, sizeof(IndexTerm), compare_index_terms);
+    }
+
+    // --- Ghi tệp: tiêu đề | thư mục từ | chuỗi các từ | danh sách vị trí ---
+    FILE* output = NULL;
+    if (result == 0) {
+        output = fopen(index_filename, "wb");
+        if (output == NULL) result = -1;
+    }
+    if (result == 0) {
+        uint64_t pool_size = 0, postings_size = 0;
+        for (uint32_t i = 0; i < term_count; i++) {
+            pool_size += strlen(sorted[i].word);
+            postings_size += terms[sorted[i].id].size;
+        }
+
+        ReportWriter writer;
+        if (report_writer_init(&writer, output, REPORT_BUFFER_SIZE) != 0) {
+            result = -1;
+        } else {
+            report_write_bytes(&writer, INDEX_MAGIC, 4);
+            report_write_u32le(&writer, case_sensitive ? INDEX_FLAG_CASE_SENSITIVE : 0);
+            report_write_u64le(&writer, (uint64_t)source_stat.st_size);
+            report_write_u64le(&writer, (uint64_t)(int64_t)source_stat.st_mtime);
+            report_write_u32le(&writer, term_count);
+            report_write_u32le(&writer, 0); // Dự phòng
+            report_write_u64le(&writer, pool_size);
+            report_write_u64le(&writer, postings_size);
+
+            // Bản ghi thư mục: u64 vị trí danh sách | u64 kích thước | u32 vị trí từ | u32 độ dài từ | u32 số lần xuất hiện | u32 dự phòng
+            uint64_t pool_offset = 0, postings_offset = 0;
+            for (uint32_t i = 0; i < term_count; i++) {
+                const TermPostings* postings = &terms[sorted[i].id];
+                size_t word_length = strlen(sorted[i].word);
+                report_write_u64le(&writer, postings_offset);
+                report_write_u64le(&writer, postings->size);
+                report_write_u32le(&writer, (uint32_t)pool_offset);
+                report_write_u32le(&writer, (uint32_t)word_length);
+                report_write_u32le(&writer, postings->occurrences);
+                report_write_u32le(&writer, 0);
+                pool_offset += word_length;
+                postings_offset += postings->size;
+            }
+            for (uint32_t i = 0; i < term_count; i++) {
+                report_write_str(&writer, sorted[i].word);
+            }
+            for (uint32_t i = 0; i < term_count; i++) {
+                report_write_bytes(&writer, terms[sorted[i].id].data, terms[sorted[i].id].size);
+            }
+            if (report_writer_close(&writer) != 0) result = -1;
+
+            if (stats != NULL) {
+                stats->token_count = position;
+                stats->term_count = term_count;
+                stats->index_size = INDEX_HEADER_SIZE + (uint64_t)term_count * INDEX_DIRECTORY_ENTRY_SIZE + pool_size + postings_size;
+            }
+        }
+        fclose(output);
+    }
+
+    for (uint32_t i = 0; i < term_count; i++) free(terms[i].data);
+    free(terms);
+    free(sorted);
+    free_table(vocabulary);
+    unmap_file(&source);
+    return result;
+}
+
+int index_open(InvertedIndex* index, const char* index_filename) {
+    memset(index, 0, sizeof(InvertedIndex));
+    if (map_file(index_filename, &index->file) != 0) return -1;
+
+    const unsigned char* data = (const unsigned char*)index->file.data;
+    size_t size = index->file.size;
+    if (size < INDEX_HEADER_SIZE || memcmp(data, INDEX_MAGIC, 4) != 0) {
+        index_close(index);
+        return -1;
+    }
+    index->flags = read_u32le(data + 4);
+    index->source_size = read_u64le(data + 8);
+    index->source_mtime = (int64_t)read_u64le(data + 16);
+    index->term_count = read_u32le(data + 24);
+    uint64_t pool_size = read_u64le(data + 32);
+    index->postings_size = read_u64le(data + 40);
+
+    uint64_t directory_size = (uint64_t)index->term_count * INDEX_DIRECTORY_ENTRY_SIZE;
+    if (directory_size > size - INDEX_HEADER_SIZE || pool_size > size - INDEX_HEADER_SIZE - directory_size ||
+        index->postings_size != size - INDEX_HEADER_SIZE - directory_size - pool_size) {
+        index_close(index);
+        return -1;
+    }
+    index->directory = data + INDEX_HEADER_SIZE;
+    index->pool = index->directory + directory_size;
+    index->postings = index->pool + pool_size;
+    return 0;
+}
+
+void index_close(InvertedIndex* index) {
+    unmap_file(&index->file);
+    memset(index, 0, sizeof(InvertedIndex));
+}
+
+int index_is_stale(const InvertedIndex* index, const char* source_filename) {
+    struct stat source_stat;
+    if (stat(source_filename, &source_stat) != 0) return 1;
+    return (uint64_t)source_stat.st_size != index->source_size || (int64_t)source_stat.st_mtime != index->source_mtime;
+}
+
+int index_find_phrase(const InvertedIndex* index, const char* const* terms, const size_t* lengths, int term_count,
+                      Posting** results, size_t* result_count) {
+    *results = NULL;
+    *result_count = 0;
+    if (term_count <= 0) return -1;
+
+    // Tra thư mục cho mọi từ; chỉ cần một từ vắng mặt là không có kết quả
+    const unsigned char** entries = (const unsigned char**)malloc(term_count * sizeof(const unsigned char*));
+    if (entries == NULL) return -1;
+    int rarest = 0;
+    for (int i = 0; i < term_count; i++) {
+        entries[i] = lookup_term(index, terms[i], lengths[i]);
+        if (entries[i] == NULL) {
+            free(entries);
+            return 0;
+        }
+        if (read_u32le(entries[i] + 24) < read_u32le(entries[rarest] + 24)) rarest = i;
+    }
+
+    // Ứng viên là vị trí bắt đầu cụm từ, lấy từ danh sách ngắn nhất
+    size_t candidate_count;
+    Posting* candidates = decode_postings(index, entries[rarest], &candidate_count);
+    if (candidates == NULL) {
+        free(entries);
+        return -1;
+    }
+    size_t kept = 0;
+    for (size_t k = 0; k < candidate_count; k++) {
+        if (candidates[k].position >= (uint64_t)rarest) {
+            candidates[kept] = candidates[k];
+            candidates[kept].position -= (uint64_t)rarest;
+            kept++;
+        }
+    }
+    candidate_count = kept;
+
+    // Giao lần lượt với các từ còn lại: giữ ứng viên p nếu từ thứ i có mặt ở vị trí p + i.
+    // Từ đầu tiên được giao sau cùng để lấy dòng và vị trí byte của nơi bắt đầu cụm từ.
+    for (int step = 0; step < term_count && candidate_count > 0; step++) {
+        int i = (step + 1) % term_count;
+        if (i == rarest) continue; // Đã là nguồn ứng viên
+        size_t posting_count;
+        Posting* postings = decode_postings(index, entries[i], &posting_count);
+        if (postings == NULL) {
+            free(candidates);
+            free(entries);
+            return -1;
+        }
+        size_t a = 0, b = 0;
+        kept = 0;
+        while (a < candidate_count && b < posting_count) {
+            uint64_t wanted = candidates[a].position + (uint64_t)i;
+            if (postings[b].position < wanted) b++;
+            else if (postings[b].position > wanted) a++;
+            else {
+                candidates[kept++] = i == 0 ? postings[b] : candidates[a];
+                a++;
+                b++;
+            }
+        }
+        candidate_count = kept;
+        free(postings);
+    }
+
+    free(entries);
+    if (candidate_count == 0) {
+        free(candidates);
+        return 0;
+    }
+    *results = candidates;
+    *result_count = candidate_count;
+    return 0;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+/**
+ * @brief Mã hóa số nguyên không dấu dạng varint (7 bit mỗi byte, bit cao = còn byte tiếp theo).
+ * @return Số byte đã ghi (tối đa 10).
+ */
+static size_t encode_varint(unsigned char* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+static const unsigned char* decode_varint(const unsigned char* p, const unsigned char* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char byte = *p++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return p;
+        }
+    }
+    return NULL; // Dữ liệu bị cắt cụt hoặc hỏng
+}
+
+static int postings_append(TermPostings* postings, uint64_t position, uint64_t line, uint64_t offset) {
+    if (postings->size + 30 > postings->capacity) {
+        size_t capacity = postings->capacity == 0 ? 32 : postings->capacity * 2;
+        unsigned char* grown = (unsigned char*)realloc(postings->data, capacity);
+        if (grown == NULL) return -1;
+        postings->data = grown;
+        postings->capacity = capacity;
+    }
+    unsigned char* out = postings->data + postings->size;
+    out += encode_varint(out, position - postings->last_position);
+    out += encode_varint(out, line - postings->last_line);
+    out += encode_varint(out, offset - postings->last_offset);
+    postings->size = (size_t)(out - postings->data);
+    postings->last_position = position;
+    postings->last_line = line;
+    postings->last_offset = offset;
+    postings->occurrences++;
+    return 0;
+}
+
+static int compare_index_terms(const void* a, const void* b) {
+    return strcmp(((const IndexTerm*)a)->word, ((const IndexTerm*)b)->word);
+}
+
+static uint32_t read_u32le(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t read_u64le(const unsigned char* p) {
+    return (uint64_t)read_u32le(p) | ((uint64_t)read_u32le(p + 4) << 32);
+}
+
+/**
+ * @brief Tìm nhị phân một từ trong thư mục (cùng thứ tự với strcmp).
+ * @return Con trỏ đến bản ghi thư mục, hoặc NULL nếu không có.
+ */
+static const unsigned char* lookup_term(const InvertedIndex* index, const char* term, size_t length) {
+    uint32_t low = 0, high = index->term_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const unsigned char* entry = index->directory + (size_t)mid * INDEX_DIRECTORY_ENTRY_SIZE;
+        const unsigned char* word = index->pool + read_u32le(entry + 16);
+        size_t word_length = read_u32le(entry + 20);
+
+        int cmp = memcmp(word, term, word_length < length ? word_length : length);
+        if (cmp == 0) cmp = word_length < length ? -1 : (word_length > length ? 1 : 0);
+        if (cmp == 0) return entry;
+        if (cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Giải nén toàn bộ danh sách vị trí của một từ.
+ * @return Mảng vị trí (người gọi giải phóng), hoặc NULL nếu lỗi.
+ */
+static Posting* decode_postings(const InvertedIndex* index, const unsigned char* entry, size_t* count) {
+    uint64_t offset = read_u64le(entry);
+    uint64_t size = read_u64le(entry + 8);
+    uint32_t occurrences = read_u32le(entry + 24);
+    if (offset > index->postings_size || size > index->postings_size - offset) return NULL;
+
+    Posting* postings = (Posting*)malloc((occurrences > 0 ? occurrences : 1) * sizeof(Posting));
+    if (postings == NULL) return NULL;
+
+    const unsigned char* p = index->postings + offset;
+    const unsigned char* end = p + size;
+    Posting current = {0, 0, 0};
+    for (uint32_t i = 0; i < occurrences; i++) {
+        uint64_t delta_position, delta_line, delta_offset;
+        if ((p = decode_varint(p, end, &delta_position)) == NULL ||
+            (p = decode_varint(p, end, &delta_line)) == NULL ||
+            (p = decode_varint(p, end, &delta_offset)) == NULL) {
+            free(postings);
+            return NULL;
+        }
+        current.position += delta_position;
+        current.line += delta_line;
+        current.offset += delta_offset;
+        postings[i] = current;
+    }
+    *count = occurrences;
+    return postings;
+}
@@ -0,0 +1,78 @@
+#ifndef INVINDEX_H
+#define INVINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mapped_file.h"
+
+#define INDEX_MAGIC "TAI1"           // "Số ma thuật" cho tệp chỉ mục
+#define INDEX_FLAG_CASE_SENSITIVE 1u // Từ được lưu nguyên dạng (không chuyển chữ thường)
+
+/**
+ * @brief Một vị trí xuất hiện của từ trong tệp nguồn.
+ */
+typedef struct {
+    uint64_t position; // Thứ tự của từ trong tệp (bắt đầu từ 0)
+    uint64_t line;     // Số dòng (bắt đầu từ 1)
+    uint64_t offset;   // Vị trí byte của từ trong tệp
+} Posting;
+
+/**
+ * @brief Số liệu sau khi tạo chỉ mục.
+ */
+typedef struct {
+    uint64_t token_count;
+    uint32_t term_count;
+    uint64_t index_size; // Kích thước tệp chỉ mục (byte)
+} IndexBuildStats;
+
+/**
+ * @brief Chỉ mục đảo đã mở (ánh xạ tệp chỉ mục vào bộ nhớ, không đọc toàn bộ).
+ */
+typedef struct {
+    MappedFile file;
+    uint32_t flags;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint32_t term_count;
+    const unsigned char* directory; // term_count bản ghi cố định, sắp xếp theo từ
+    const unsigned char* pool;      // Chuỗi các từ nối liền nhau
+    const unsigned char* postings;  // Danh sách vị trí đã nén
+    uint64_t postings_size;
+} InvertedIndex;
+
+/**
+ * @brief Tạo chỉ mục đảo có vị trí cho một tệp văn bản.
+ * Tách từ theo cùng quy tắc với 'analyst'; mỗi vị trí (thứ tự từ, dòng, byte) được lưu dưới dạng
+ * hiệu số so với vị trí trước đó của cùng từ và mã hóa varint.
+ * @param case_sensitive 0 để chuyển mọi từ về chữ thường trước khi lập chỉ mục.
+ * @param stats Nhận số liệu (có thể NULL).
+ * @return 0 nếu thành công, -1 nếu thất bại.
+ */
+int index_build(const char* source_filename, const char* index_filename, int case_sensitive, IndexBuildStats* stats);
+
+/**
+ * @brief Mở tệp chỉ mục.
+ * @return 0 nếu thành công, -1 nếu không mở được hoặc tệp không phải chỉ mục hợp lệ.
+ */
+int index_open(InvertedIndex* index, const char* index_filename);
+
+void index_close(InvertedIndex* index);
+
+/**
+ * @brief Kiểm tra chỉ mục còn khớp với tệp nguồn (so sánh kích thước và thời điểm sửa đổi).
+ * @return 1 nếu chỉ mục đã cũ hoặc không đọc được tệp nguồn, 0 nếu còn dùng được.
+ */
+int index_is_stale(const InvertedIndex* index, const char* source_filename);
+
+/**
+ * @brief Tìm một cụm từ (một hoặc nhiều từ liên tiếp) bằng cách giao các danh sách vị trí.
+ * Các từ phải đã được chuyển chữ thường nếu chỉ mục không phân biệt hoa/thường.
+ * @param results Nhận mảng vị trí của từ đầu tiên trong mỗi lần khớp, tăng dần (người gọi giải phóng bằng free).
+ * @param result_count Nhận số phần tử của results.
+ * @return 0 nếu thành công (kể cả khi không có kết quả), -1 nếu lỗi.
+ */
+int index_find_phrase(const InvertedIndex* index, const char* const* terms, const size_t* lengths, int term_count,
+                      Posting** results, size_t* result_count);
+
+#endif // INVINDEX_H
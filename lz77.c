@@ -0,0 +1,303 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lz77.h"
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static uint32_t read32(const unsigned char* p);
+static uint32_t hash4(const unsigned char* p);
+static void insert_position(Lz77Matcher* m, const unsigned char* src, size_t pos);
+static size_t match_length(const unsigned char* ref, const unsigned char* cur, const unsigned char* end);
+static size_t find_match(const Lz77Matcher* m, const unsigned char* src, size_t pos, size_t size, size_t* offset);
+static unsigned char* write_length(unsigned char* out, size_t length);
+static unsigned char* write_sequence(unsigned char* out, const unsigned char* literals, size_t literal_count, size_t offset, size_t match_len);
+static int read_length(const unsigned char** ip, const unsigned char* iend, size_t* length);
+
+// Tham số của từng mức nỗ lực (chỉ số 0 không dùng)
+static const struct {
+    int max_chain;
+    int nice_length;
+    int lazy;
+} level_params[LZ77_MAX_LEVEL + 1] = {
+    { 0, 0, 0 },
+    { 4, 16, 0 },
+    { 8, 32, 0 },
+    { 16, 32, 0 },
+    { 16, 64, 1 },
+    { 32, 64, 1 },
+    { 64, 128, 1 },
+    { 256, 256, 1 },
+    { 1024, 1024, 1 },
+    { 4096, 4096, 1 },
+};
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+int lz77_matcher_init(Lz77Matcher* m, int level, size_t max_block_size) {
+    if (level < LZ77_MIN_LEVEL) level = LZ77_MIN_LEVEL;
+    if (level > LZ77_MAX_LEVEL) level = LZ77_MAX_LEVEL;
+    m->max_chain = level_params[level].max_chain;
+    m->nice_length = level_params[level].nice_length;
+    m->lazy = level_params[level].lazy;
+    m->head = (int32_t*)malloc(sizeof(int32_t) << LZ77_HASH_BITS);
+    m->prev = (int32_t*)malloc(sizeof(int32_t) * LZ77_WINDOW_SIZE);
+    m->sequences = (Lz77Sequence*)malloc(sizeof(Lz77Sequence) * LZ77_MAX_SEQUENCES(max_block_size));
+    m->max_block_size = max_block_size;
+    if (m->head == NULL || m->prev == NULL || m->sequences == NULL) {
+        lz77_matcher_free(m);
+        return -1;
+    }
+    return 0;
+}
+
+void lz77_matcher_free(Lz77Matcher* m) {
+    free(m->head);
+    free(m->prev);
+    free(m->sequences);
+    m->head = NULL;
+    m->prev = NULL;
+    m->sequences = NULL;
+}
+
+size_t lz77_parse_block(Lz77Matcher* m, const unsigned char* src, size_t size) {
+    // Khối độc lập: xóa bảng băm (-1 = chưa có vị trí); prev chỉ được đọc qua head nên không cần xóa
+    memset(m->head, 0xFF, sizeof(int32_t) << LZ77_HASH_BITS);
+
+    Lz77Sequence* seq = m->sequences;
+    size_t anchor = 0; // Đầu phần literal chưa xuất
+    size_t pos = 0;
+    while (pos + LZ77_MIN_MATCH <= size) {
+        size_t offset = 0;
+        size_t len = find_match(m, src, pos, size, &offset);
+        insert_position(m, src, pos);
+        if (len == 0) {
+            pos++;
+            continue;
+        }
+
+        // Lazy matching: nếu vị trí kế tiếp khớp dài hơn, byte hiện tại thành literal
+        while (m->lazy && len < (size_t)m->nice_length && pos + 1 + LZ77_MIN_MATCH <= size) {
+            size_t next_offset = 0;
+            size_t next_len = find_match(m, src, pos + 1, size, &next_offset);
+            if (next_len <= len) break;
+            pos++;
+            insert_position(m, src, pos);
+            len = next_len;
+            offset = next_offset;
+        }
+
+        seq->literal_count = (uint32_t)(pos - anchor);
+        seq->match_length = (uint32_t)len;
+        seq->offset = (uint32_t)offset;
+        seq++;
+
+        // Chèn các vị trí bên trong chuỗi khớp để các chuỗi sau có thể tham chiếu tới
+        size_t match_end = pos + len;
+        size_t insert_end = match_end + LZ77_MIN_MATCH <= size ? match_end : size - LZ77_MIN_MATCH + 1;
+        for (pos++; pos < insert_end; pos++) insert_position(m, src, pos);
+        pos = match_end;
+        anchor = pos;
+    }
+
+    // Chuỗi cuối chỉ gồm các literal còn lại
+    seq->literal_count = (uint32_t)(size - anchor);
+    seq->match_length = 0;
+    seq->offset = 0;
+    seq++;
+    return (size_t)(seq - m->sequences);
+}
+
+size_t lz77_encode_block(Lz77Matcher* m, const unsigned char* src, size_t size, unsigned char* dst) {
+    size_t count = lz77_parse_block(m, src, size);
+    unsigned char* out = dst;
+    for (size_t i = 0; i < count; i++) {
+        const Lz77Sequence* seq = &m->sequences[i];
+        out = write_sequence(out, src, seq->literal_count, seq->offset, seq->match_length);
+        src += seq->literal_count + seq->match_length;
+    }
+    return (size_t)(out - dst);
+}
+
+int lz77_decode_block(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size) {
+    const unsigned char* ip = src;
+    const unsigned char* iend = src + size;
+    unsigned char* op = dst;
+    unsigned char* oend = dst + raw_size;
+
+    for (;;) {
+        if (ip >= iend) return -1;
+        unsigned int token = *ip++;
+
+        // 1. Literal: chuỗi ngắn được chép nguyên 16 byte một lần khi hai phía còn đủ chỗ
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && read_length(&ip, iend, &literal_count) != 0) return -1;
+        if (literal_count > (size_t)(iend - ip) || literal_count > (size_t)(oend - op)) return -1;
+        if (literal_count <= 16 && iend - ip >= 16 && oend - op >= 16) {
+            memcpy(op, ip, 16);
+        } else {
+            memcpy(op, ip, literal_count);
+        }
+        op += literal_count;
+        ip += literal_count;
+        if (ip == iend) break; // Chuỗi cuối không có phần khớp
+
+        // 2. Chuỗi khớp
+        if (iend - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 15;
+        if (match_len == 15 && read_length(&ip, iend, &match_len) != 0) return -1;
+        match_len += LZ77_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - dst) || match_len > (size_t)(oend - op)) return -1;
+        lz77_copy_match(op, offset, match_len, oend);
+        op += match_len;
+    }
+    return op == oend ? 0 : -1;
+}
+
+void lz77_copy_match(unsigned char* op, size_t offset, size_t length, const unsigned char* oend) {
+    const unsigned char* match = op - offset;
+    unsigned char* end = op + length;
+
+    if (offset == 1) {
+        memset(op, *match, length);
+        return;
+    }
+    size_t distance = offset;
+    if (offset < 8) {
+        distance = offset * ((8 + offset - 1) / offset);
+        size_t head = length < distance ? length : distance;
+        for (size_t i = 0; i < head; i++) op[i] = match[i];
+        op += head;
+        match = op - distance;
+    }
+
+    if (distance >= 16 && oend - end >= 16) {
+        while (op < end) {
+            memcpy(op, match, 16);
+            op += 16;
+            match += 16;
+        }
+    } else if (oend - end >= 8) {
+        while (op < end) {
+            memcpy(op, match, 8);
+            op += 8;
+            match += 8;
+        }
+    } else {
+        while (op < end) *op++ = *match++;
+    }
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+static uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash4(const unsigned char* p) {
+    return (read32(p) * 2654435761u) >> (32 - LZ77_HASH_BITS);
+}
+
+static void insert_position(Lz77Matcher* m, const unsigned char* src, size_t pos) {
+    uint32_t h = hash4(src + pos);
+    m->prev[pos & (LZ77_WINDOW_SIZE - 1)] = m->head[h];
+    m->head[h] = (int32_t)pos;
+}
+
+/**
+ * @brief Độ dài phần chung của ref và cur (ref đứng trước cur), không vượt end.
+ * So 8 byte mỗi lần, byte khác đầu tiên lấy từ số bit 0 ở cuối của phép XOR (little-endian).
+ */
+static size_t match_length(const unsigned char* ref, const unsigned char* cur, const unsigned char* end) {
+    const unsigned char* start = cur;
+    while (end - cur >= 8) {
+        uint64_t a, b;
+        memcpy(&a, ref, 8);
+        memcpy(&b, cur, 8);
+        uint64_t diff = a ^ b;
+        if (diff != 0) return (size_t)(cur - start) + ((size_t)__builtin_ctzll(diff) >> 3);
+        ref += 8;
+        cur += 8;
+    }
+    while (cur < end && *ref == *cur) {
+        ref++;
+        cur++;
+    }
+    return (size_t)(cur - start);
+}
+
+/**
+ * @brief Tìm chuỗi khớp dài nhất cho vị trí pos theo chuỗi băm (pos chưa được chèn).
+ * @return Độ dài chuỗi khớp (offset nhận khoảng cách), hoặc 0 nếu không có chuỗi nào dài ít nhất LZ77_MIN_MATCH.
+ */
+static size_t find_match(const Lz77Matcher* m, const unsigned char* src, size_t pos, size_t size, size_t* offset) {
+    const unsigned char* cur = src + pos;
+    const unsigned char* end = src + size;
+    size_t max_len = size - pos;
+    size_t nice_length = (size_t)m->nice_length < max_len ? (size_t)m->nice_length : max_len;
+    size_t best = LZ77_MIN_MATCH - 1;
+    uint32_t first = read32(cur);
+
+    int chain = m->max_chain;
+    int32_t candidate = m->head[hash4(cur)];
+    while (candidate >= 0 && pos - (size_t)candidate <= LZ77_MAX_OFFSET && chain-- > 0) {
+        const unsigned char* ref = src + candidate;
+        // Byte ở vị trí best phải khớp thì ứng viên mới có thể dài hơn: loại nhanh trước khi so cả chuỗi
+        if (ref[best] == cur[best] && read32(ref) == first) {
+            size_t len = match_length(ref, cur, end);
+            if (len > best) {
+                best = len;
+                *offset = pos - (size_t)candidate;
+                if (len >= nice_length) break;
+            }
+        }
+        candidate = m->prev[candidate & (LZ77_WINDOW_SIZE - 1)];
+    }
+    return best >= LZ77_MIN_MATCH ? best : 0;
+}
+
+static unsigned char* write_length(unsigned char* out, size_t length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+/**
+ * @brief Ghi một chuỗi: token, literal, rồi khoảng cách và độ dài khớp (bỏ qua nếu match_len = 0).
+ */
+static unsigned char* write_sequence(unsigned char* out, const unsigned char* literals, size_t literal_count, size_t offset, size_t match_len) {
+    unsigned char* token = out++;
+    size_t match_code = match_len > 0 ? match_len - LZ77_MIN_MATCH : 0;
+    *token = (unsigned char)(((literal_count < 15 ? literal_count : 15) << 4) | (match_code < 15 ? match_code : 15));
+    if (literal_count >= 15) out = write_length(out, literal_count - 15);
+    memcpy(out, literals, literal_count);
+    out += literal_count;
+    if (match_len == 0) return out;
+
+    out[0] = (unsigned char)(offset & 0xFF);
+    out[1] = (unsigned char)(offset >> 8);
+    out += 2;
+    if (match_code >= 15) out = write_length(out, match_code - 15);
+    return out;
+}
+
+/**
+ * @brief Cộng phần nối dài (các byte 255 và một byte cuối) vào length.
+ * @return 0 nếu thành công, -1 nếu dữ liệu bị cắt cụt.
+ */
+static int read_length(const unsigned char** ip, const unsigned char* iend, size_t* length) {
+    const unsigned char* p = *ip;
+    unsigned int b;
+    do {
+        if (p >= iend) return -1;
+        b = *p++;
+        *length += b;
+    } while (b == 255);
+    *ip = p;
+    return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef LZ77_H
+#define LZ77_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Cửa sổ trượt: khoảng cách tham chiếu được lưu bằng 2 byte
+#define LZ77_WINDOW_SIZE   (1 << 16)
+#define LZ77_MAX_OFFSET    (LZ77_WINDOW_SIZE - 1)
+#define LZ77_MIN_MATCH     4
+#define LZ77_HASH_BITS     16
+#define LZ77_MIN_LEVEL     1
+#define LZ77_MAX_LEVEL     9
+#define LZ77_DEFAULT_LEVEL 6
+// Dung lượng đích cần cho lz77_encode_block với n byte đầu vào (trường hợp toàn literal)
+#define LZ77_BLOCK_BOUND(n) ((size_t)(n) + (size_t)(n) / 255 + 16)
+// Số chuỗi tối đa khi phân tích n byte: mỗi chuỗi (trừ chuỗi cuối) chiếm ít nhất LZ77_MIN_MATCH byte
+#define LZ77_MAX_SEQUENCES(n) ((size_t)(n) / LZ77_MIN_MATCH + 1)
+
+/**
+ * @brief Một chuỗi của kết quả phân tích: literal_count byte nguyên văn, rồi match_length byte
+ * chép từ offset byte trước đó. Chuỗi cuối của khối có match_length = 0.
+ */
+typedef struct {
+    uint32_t literal_count;
+    uint32_t match_length;
+    uint32_t offset;
+} Lz77Sequence;
+
+/**
+ * @brief Bộ tìm chuỗi khớp theo chuỗi băm: head[h] là vị trí gần nhất có băm h của 4 byte,
+ * prev[pos % cửa sổ] là vị trí trước đó có cùng băm. Tái sử dụng được cho nhiều khối.
+ */
+typedef struct {
+    int32_t* head;
+    int32_t* prev;
+    int max_chain;   // Số ứng viên tối đa được thử ở mỗi vị trí
+    int nice_length; // Dừng tìm khi đã có chuỗi khớp dài ít nhất chừng này
+    int lazy;        // Thử vị trí kế tiếp trước khi nhận chuỗi khớp (lazy matching)
+    Lz77Sequence* sequences; // Kết quả của lz77_parse_block
+    size_t max_block_size;
+} Lz77Matcher;
+
+/**
+ * @brief Khởi tạo bộ tìm chuỗi khớp.
+ * @param level Mức nỗ lực LZ77_MIN_LEVEL..LZ77_MAX_LEVEL (ngoài khoảng sẽ bị kẹp lại):
+ * mức cao thử nhiều ứng viên hơn, nén tốt hơn nhưng chậm hơn. Tốc độ giải nén không phụ thuộc mức.
+ * @param max_block_size Kích thước lớn nhất của khối sẽ được phân tích.
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ.
+ */
+int lz77_matcher_init(Lz77Matcher* m, int level, size_t max_block_size);
+
+void lz77_matcher_free(Lz77Matcher* m);
+
+/**
+ * @brief Phân tích một khối độc lập (chỉ tham chiếu bên trong khối) thành các chuỗi trong m->sequences.
+ * @param size Không vượt max_block_size.
+ * @return Số chuỗi (ít nhất 1).
+ */
+size_t lz77_parse_block(Lz77Matcher* m, const unsigned char* src, size_t size);
+
+/**
+ * @brief Nén một khối độc lập theo kết quả của lz77_parse_block.
+ * Khối là dãy chuỗi (sequence): byte token (4 bit cao: số literal, 4 bit thấp: độ dài khớp - LZ77_MIN_MATCH,
+ * giá trị 15 được nối dài bằng các byte 255 và một byte cuối < 255), các literal, khoảng cách 2 byte
+ * little-endian, rồi phần nối dài của độ dài khớp. Chuỗi cuối cùng chỉ có literal.
+ * @param dst Cần ít nhất LZ77_BLOCK_BOUND(size) byte.
+ * @return Số byte đã ghi.
+ */
+size_t lz77_encode_block(Lz77Matcher* m, const unsigned char* src, size_t size, unsigned char* dst);
+
+/**
+ * @brief Giải nén một khối do lz77_encode_block tạo ra.
+ * @param raw_size Số byte gốc của khối (được lưu riêng bởi định dạng chứa khối).
+ * @return 0 nếu thành công, -1 nếu dữ liệu hỏng.
+ */
+int lz77_decode_block(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+
+/**
+ * @brief Chép chuỗi khớp có thể chồng lấn (offset < length) vào op, dùng chung cho các bộ giải nén họ LZ.
+ * Khoảng cách ngắn được nhân mẫu lên bội số >= 8 của offset trước, sau đó chép từng 16 hoặc 8 byte:
+ * mỗi lần chép không chồng lấn chính nó nên memcpy an toàn. Lần chép cuối có thể ghi lố,
+ * nên chỉ dùng khi còn đủ chỗ trước oend.
+ * @param offset Khoảng cách (1..op - đầu vùng đã giải nén), length <= oend - op.
+ */
+void lz77_copy_match(unsigned char* op, size_t offset, size_t length, const unsigned char* oend);
+
+#endif // LZ77_H
@@ -0,0 +1,259 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lzh.h"
+
+// Bộ ghi bit trong bộ nhớ: bit được xếp vào bộ tích lũy 64 bit từ bit cao nhất xuống
+typedef struct {
+    uint64_t acc;
+    int bits; // Số bit đang chờ trong acc (luôn < 32 giữa các lần gọi)
+    unsigned char* out;
+} LzhBitWriter;
+
+// Bộ đọc bit trong bộ nhớ: bit kế tiếp nằm ở bit cao nhất của `bits`
+typedef struct {
+    const unsigned char* pos;
+    const unsigned char* end;
+    uint64_t bits;
+    int count;      // Số bit hợp lệ trong `bits`
+    size_t padding; // Số byte 0 giả đã nạp sau khi hết dữ liệu
+} LzhBitReader;
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static int value_code(uint32_t value, int* extra_bits);
+static void put_bits(LzhBitWriter* w, uint32_t value, int count);
+static void put_value(LzhBitWriter* w, const HuffmanCode codes[], int base, uint32_t value);
+static void bit_reader_refill(LzhBitReader* r);
+static uint32_t take_bits(LzhBitReader* r, int count);
+static int read_value(LzhBitReader* r, int code, uint32_t* value);
+static int lengths_present(const uint8_t lengths[], int num_symbols);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+size_t lzh_encode_block(Lz77Matcher* m, const unsigned char* src, size_t size, unsigned char* dst) {
+    size_t count = lz77_parse_block(m, src, size);
+    const Lz77Sequence* sequences = m->sequences;
+
+    // 1. Đếm tần suất ký hiệu của cả hai bảng
+    uint64_t litlen_freq[LZH_LITLEN_SYMBOLS] = {0};
+    uint64_t distance_freq[LZH_DISTANCE_SYMBOLS] = {0};
+    const unsigned char* p = src;
+    for (size_t i = 0; i < count; i++) {
+        const Lz77Sequence* seq = &sequences[i];
+        for (uint32_t j = 0; j < seq->literal_count; j++) litlen_freq[p[j]]++;
+        p += seq->literal_count;
+        if (seq->match_length == 0) continue;
+        int extra;
+        litlen_freq[LZH_LITERALS + value_code(seq->match_length - LZ77_MIN_MATCH, &extra)]++;
+        distance_freq[value_code(seq->offset - 1, &extra)]++;
+        p += seq->match_length;
+    }
+
+    // 2. Bảng mã của khối
+    uint8_t litlen_lengths[LZH_LITLEN_SYMBOLS];
+    uint8_t distance_lengths[LZH_DISTANCE_SYMBOLS];
+    huffman_build_lengths(litlen_freq, LZH_LITLEN_SYMBOLS, HUFFMAN_MAX_CODE_LENGTH, litlen_lengths);
+    huffman_build_lengths(distance_freq, LZH_DISTANCE_SYMBOLS, HUFFMAN_MAX_CODE_LENGTH, distance_lengths);
+    unsigned char* out = dst;
+    out += huffman_write_lengths(litlen_lengths, LZH_LITLEN_SYMBOLS, out);
+    out += huffman_write_lengths(distance_lengths, LZH_DISTANCE_SYMBOLS, out);
+
+    HuffmanCode litlen_codes[LZH_LITLEN_SYMBOLS];
+    HuffmanCode distance_codes[LZH_DISTANCE_SYMBOLS];
+    huffman_canonical_codes(litlen_lengths, LZH_LITLEN_SYMBOLS, litlen_codes);
+    huffman_canonical_codes(distance_lengths, LZH_DISTANCE_SYMBOLS, distance_codes);
+
+    // 3. Luồng bit
+    LzhBitWriter w = {0, 0, out};
+    p = src;
+    for (size_t i = 0; i < count; i++) {
+        const Lz77Sequence* seq = &sequences[i];
+        for (uint32_t j = 0; j < seq->literal_count; j++) {
+            const HuffmanCode* hc = &litlen_codes[p[j]];
+            put_bits(&w, hc->code, hc->length);
+        }
+        p += seq->literal_count;
+        if (seq->match_length == 0) continue;
+        put_value(&w, litlen_codes, LZH_LITERALS, seq->match_length - LZ77_MIN_MATCH);
+        put_value(&w, distance_codes, 0, seq->offset - 1);
+        p += seq->match_length;
+    }
+    // Ghi các bit còn chờ, đệm bit 0 cho đủ byte
+    while (w.bits > 0) {
+        *w.out++ = (unsigned char)(w.acc >> 56);
+        w.acc <<= 8;
+        w.bits -= 8;
+    }
+    return (size_t)(w.out - dst);
+}
+
+int lzh_decode_block(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size) {
+    uint8_t litlen_lengths[LZH_LITLEN_SYMBOLS];
+    uint8_t distance_lengths[LZH_DISTANCE_SYMBOLS];
+    size_t litlen_size = huffman_read_lengths(src, size, LZH_LITLEN_SYMBOLS, litlen_lengths);
+    if (litlen_size == 0) return -1;
+    size_t distance_size = huffman_read_lengths(src + litlen_size, size - litlen_size, LZH_DISTANCE_SYMBOLS, distance_lengths);
+    if (distance_size == 0) return -1;
+    if (raw_size == 0) return 0;
+
+    // Khối không có chuỗi khớp nào thì bảng khoảng cách rỗng
+    HuffmanDecoder litlen, distance;
+    memset(&distance, 0, sizeof(HuffmanDecoder));
+    if (huffman_decoder_from_lengths(&litlen, litlen_lengths, LZH_LITLEN_SYMBOLS) != 0) return -1;
+    if (lengths_present(distance_lengths, LZH_DISTANCE_SYMBOLS) &&
+        huffman_decoder_from_lengths(&distance, distance_lengths, LZH_DISTANCE_SYMBOLS) != 0) {
+        huffman_decoder_free(&litlen);
+        return -1;
+    }
+
+    LzhBitReader r;
+    memset(&r, 0, sizeof(LzhBitReader));
+    r.pos = src + litlen_size + distance_size;
+    r.end = src + size;
+
+    const HuffmanDecodeEntry* litlen_table = litlen.entries;
+    const int litlen_shift = 64 - litlen.root_bits;
+    const HuffmanDecodeEntry* distance_table = distance.entries;
+    const int distance_shift = 64 - distance.root_bits;
+    unsigned char* op = dst;
+    unsigned char* oend = dst + raw_size;
+    int result = 0;
+    while (op < oend) {
+        // Mỗi trường (mã hoặc bit phụ) dài không quá 24 bit: nạp lại khi còn dưới 32 bit
+        if (r.count < 32) bit_reader_refill(&r);
+        const HuffmanDecodeEntry* e = &litlen_table[r.bits >> litlen_shift];
+        if (e->kind != HUFFMAN_ENTRY_LEAF) {
+            result = -1;
+            break;
+        }
+        r.bits <<= e->length;
+        r.count -= e->length;
+        if (e->value < LZH_LITERALS) {
+            *op++ = (unsigned char)e->value;
+            continue;
+        }
+
+        uint32_t length, offset;
+        if (read_value(&r, (int)e->value - LZH_LITERALS, &length) != 0 || distance_table == NULL) {
+            result = -1;
+            break;
+        }
+        length += LZ77_MIN_MATCH;
+        if (r.count < 32) bit_reader_refill(&r);
+        e = &distance_table[r.bits >> distance_shift];
+        if (e->kind != HUFFMAN_ENTRY_LEAF) {
+            result = -1;
+            break;
+        }
+        r.bits <<= e->length;
+        r.count -= e->length;
+        if (read_value(&r, (int)e->value, &offset) != 0) {
+            result = -1;
+            break;
+        }
+        offset += 1;
+        if (offset > (size_t)(op - dst) || length > (size_t)(oend - op)) {
+            result = -1;
+            break;
+        }
+        lz77_copy_match(op, offset, length, oend);
+        op += length;
+    }
+    // Các bit đã dùng không được vượt quá dữ liệu thật (phần đệm 0 giả chỉ để đọc trước)
+    if (result == 0 && r.padding * 8 > (size_t)r.count) result = -1;
+
+    huffman_decoder_free(&litlen);
+    huffman_decoder_free(&distance);
+    return result;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+/**
+ * @brief Mã của một giá trị: v < 16 là chính nó; v lớn hơn với bit cao nhất ở vị trí n được chia thành
+ * hai mã theo bit kế tiếp, n - 1 bit còn lại là bit phụ.
+ */
+static int value_code(uint32_t value, int* extra_bits) {
+    if (value < 16) {
+        *extra_bits = 0;
+        return (int)value;
+    }
+    int n = 31 - __builtin_clz(value);
+    *extra_bits = n - 1;
+    return 16 + 2 * (n - 4) + (int)((value >> (n - 1)) & 1);
+}
+
+/**
+ * @brief Ghi count bit thấp của value (1 <= count <= 32); đủ 32 bit thì ghi nguyên một từ (big-endian).
+ */
+static void put_bits(LzhBitWriter* w, uint32_t value, int count) {
+    w->acc |= (uint64_t)value << (64 - w->bits - count);
+    w->bits += count;
+    if (w->bits >= 32) {
+        uint32_t word = __builtin_bswap32((uint32_t)(w->acc >> 32));
+        memcpy(w->out, &word, 4);
+        w->out += 4;
+        w->acc <<= 32;
+        w->bits -= 32;
+    }
+}
+
+/**
+ * @brief Ghi mã của value trong bảng codes (bắt đầu từ ký hiệu base) rồi các bit phụ.
+ */
+static void put_value(LzhBitWriter* w, const HuffmanCode codes[], int base, uint32_t value) {
+    int extra_bits;
+    const HuffmanCode* hc = &codes[base + value_code(value, &extra_bits)];
+    put_bits(w, hc->code, hc->length);
+    if (extra_bits > 0) put_bits(w, value & (((uint32_t)1 << extra_bits) - 1), extra_bits);
+}
+
+/**
+ * @brief Nạp bit cho đến khi có ít nhất 56 bit hợp lệ; hết dữ liệu thì nạp byte 0.
+ */
+static void bit_reader_refill(LzhBitReader* r) {
+    if (r->end - r->pos >= 8) {
+        uint64_t word;
+        memcpy(&word, r->pos, 8);
+        r->bits |= __builtin_bswap64(word) >> r->count;
+        r->pos += (63 - r->count) >> 3;
+        r->count |= 56;
+        return;
+    }
+    while (r->count <= 56) {
+        uint64_t byte = 0;
+        if (r->pos < r->end) byte = *r->pos++;
+        else r->padding++;
+        r->bits |= byte << (56 - r->count);
+        r->count += 8;
+    }
+}
+
+static uint32_t take_bits(LzhBitReader* r, int count) {
+    uint32_t value = (uint32_t)(r->bits >> (64 - count));
+    r->bits <<= count;
+    r->count -= count;
+    return value;
+}
+
+/**
+ * @brief Dựng lại giá trị từ mã (ngược với value_code), đọc thêm bit phụ nếu cần.
+ * @return 0 nếu thành công, -1 nếu mã nằm ngoài bảng.
+ */
+static int read_value(LzhBitReader* r, int code, uint32_t* value) {
+    if (code < 16) {
+        *value = (uint32_t)code;
+        return 0;
+    }
+    int extra_bits = (code - 16) / 2 + 3;
+    if (extra_bits > 24) return -1;
+    if (r->count < extra_bits) bit_reader_refill(r);
+    *value = ((uint32_t)(2 | ((code - 16) & 1)) << extra_bits) | take_bits(r, extra_bits);
+    return 0;
+}
+
+static int lengths_present(const uint8_t lengths[], int num_symbols) {
+    for (int i = 0; i < num_symbols; i++) {
+        if (lengths[i] != 0) return 1;
+    }
+    return 0;
+}
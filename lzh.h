@@ -0,0 +1,39 @@
+#ifndef LZH_H
+#define LZH_H
+
+#include <stddef.h>
+#include "huffman.h"
+#include "lz77.h"
+
+// Bảng literal/độ dài: 256 literal, sau đó là mã của (độ dài khớp - LZ77_MIN_MATCH).
+// Giá trị v < 16 có mã riêng; v lớn hơn dùng 2 mã cho mỗi lũy thừa 2, phần còn lại là bit phụ.
+#define LZH_LITERALS         256
+#define LZH_LENGTH_CODES     60 // Đủ cho độ dài khớp tới 2^26 byte
+#define LZH_LITLEN_SYMBOLS   (LZH_LITERALS + LZH_LENGTH_CODES)
+// Bảng khoảng cách: mã của (khoảng cách - 1) theo cùng cách chia, khoảng cách tối đa LZ77_MAX_OFFSET
+#define LZH_DISTANCE_SYMBOLS 40
+// Mức nỗ lực mặc định của bộ tìm chuỗi khớp: bảng Huffman bù lại phần lớn chênh lệch so với các mức cao
+#define LZH_DEFAULT_LEVEL    4
+// Dung lượng đích cần cho lzh_encode_block với n byte đầu vào: mỗi byte tốn không quá
+// HUFFMAN_MAX_CODE_LENGTH bit, kể cả khi nằm trong chuỗi khớp ngắn nhất
+#define LZH_BLOCK_BOUND(n) (HUFFMAN_LENGTHS_SIZE(LZH_LITLEN_SYMBOLS) + HUFFMAN_LENGTHS_SIZE(LZH_DISTANCE_SYMBOLS) + \
+                            ((size_t)(n) * HUFFMAN_MAX_CODE_LENGTH + 7) / 8 + 16)
+
+/**
+ * @brief Nén một khối kiểu deflate: phân tích LZ77, rồi mã hóa literal/độ dài và khoảng cách
+ * bằng hai bảng Huffman chuẩn tắc riêng của khối.
+ * Khối gồm bảng độ dài mã literal/độ dài, bảng độ dài mã khoảng cách (huffman_write_lengths),
+ * rồi luồng bit: mỗi literal là một mã; mỗi chuỗi khớp là mã độ dài + bit phụ, mã khoảng cách + bit phụ.
+ * @param dst Cần ít nhất LZH_BLOCK_BOUND(size) byte.
+ * @return Số byte đã ghi.
+ */
+size_t lzh_encode_block(Lz77Matcher* m, const unsigned char* src, size_t size, unsigned char* dst);
+
+/**
+ * @brief Giải nén một khối do lzh_encode_block tạo ra.
+ * @param raw_size Số byte gốc của khối (được lưu riêng bởi định dạng chứa khối).
+ * @return 0 nếu thành công, -1 nếu dữ liệu hỏng hoặc hết bộ nhớ.
+ */
+int lzh_decode_block(const unsigned char* src, size_t size, unsigned char* dst, size_t raw_size);
+
+#endif // LZH_H
@@ -2,6 +2,7 @@
 #include <windows.h>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 #include <cctype>
@@ -24,6 +25,13 @@
 extern "C" {
 #include "core_logic/compress.h"
 #include "core_logic/hashtable.h"
+#include "core_logic/report.h"
+#include "core_logic/stopwords.h"
+#include "core_logic/mapped_file.h"
+#include "core_logic/search.h"
+#include "core_logic/multisearch.h"
+#include "core_logic/tokenizer.h"
+#include "core_logic/fuzzy.h"
 }
 
 using namespace std;
@@ -38,12 +46,6 @@ using namespace ImGui;
 #define SORT_FREQ_DEC 5
 #define HASH_TABLE_SIZE 10007
 
-// Cấu trúc để lưu trữ thống kê từ
-typedef struct {
-    char *word;
-    int count;
-} WordStats;
-
 // Cấu trúc để lưu trữ kết quả phân tích
 typedef struct {
     long char_count;
@@ -54,24 +56,30 @@ typedef struct {
     bool is_analyzed;
 } AnalysisResult;
 
-// Struct để lưu vị trí (bắt đầu, kết thúc) của một từ khóa được tìm thấy
+// Struct để lưu vị trí (bắt đầu, kết thúc) của một từ khóa được tìm thấy, tính từ đầu dòng
 struct MatchPosition {
     int start;
     int end;
 };
 
-// Struct để lưu thông tin của một dòng có chứa kết quả
+// Một dòng có chứa kết quả: chỉ lưu vị trí trong tệp đã ánh xạ, nội dung được đọc khi hiển thị
 struct FoundLine {
+    size_t offset;        // Vị trí đầu dòng trong tệp
+    int length;           // Độ dài dòng (không gồm "\r\n")
     int line_number;
-    string line_content;
-    vector<MatchPosition> matches; // Danh sách các vị trí của từ khóa trong dòng
+    size_t first_match;   // Chỉ số đoạn khớp đầu tiên trong SearchResult::matches
+    int match_count;
 };
 
 // Cấu trúc để lưu trữ kết quả tìm kiếm
 typedef struct {
+    MappedFile mapped;             // Tệp được giữ ánh xạ đến lần tìm tiếp theo để hiển thị các dòng
     vector<FoundLine> found_lines;
+    vector<MatchPosition> matches; // Đoạn khớp của mọi dòng, xếp liên tiếp theo thứ tự dòng
     int total_matches;
+    int matched_lines;
     bool is_searched;
+    bool count_only; // Chỉ đếm, không lưu dòng
 } SearchResult;
 
 // Biến toàn cục để lưu trữ kết quả
@@ -95,14 +103,18 @@ int compare_len_asc(const void *a, const void *b);
 int compare_freq_asc(const void *a, const void *b);
 int compare_freq_dec(const void *a, const void *b);
 WordStats* ht_to_array(HashTable* table, int* count);
-void perform_analysis_gui(const char* filename, int case_sensitive, int sort_mode);
-void perform_find_gui(const char* filename, const char* keyword, int case_sensitive, int exact_match);
+void perform_analysis_gui(const char* filename, int case_sensitive, int sort_mode, const StopWordSet* stopwords);
+void perform_find_gui(const char* filename, const char* keyword, int case_sensitive, int exact_match, int count_only, int max_lines);
+void perform_find_patterns_gui(const char* filename, const char* patterns_filename, int case_sensitive, int exact_match);
+void perform_find_fuzzy_gui(const char* filename, const char* keyword, int case_sensitive, int max_errors, int count_only, int max_lines);
+void perform_export_gui(const char* filename, ReportFormat format);
 long long perform_compress_gui(const char* input_filename, const char* full_output_filename, CompressionAlgorithm algo);
 long long perform_decompress_gui(const char* input_filename, const char* output_filename, CompressionAlgorithm algo);
 // Các hàm phụ trợ
 CompressionAlgorithm get_algo_from_string(const char* str);
 const char* get_string_from_algo(CompressionAlgorithm algo);
 CompressionAlgorithm get_algo_from_filename(const char* filename);
+CompressionAlgorithm choose_algo_for_file(const char* filename);
 long long get_file_size(const char* filename);
 void format_file_size(long long size, char* buffer, size_t buffer_size);
 
@@ -399,12 +411,66 @@ void cleanup_analysis_result() {
 }
 
 void cleanup_search_result() {
+    unmap_file(&g_search_result.mapped);
     g_search_result.found_lines.clear();
+    g_search_result.found_lines.shrink_to_fit();
+    g_search_result.matches.clear();
+    g_search_result.matches.shrink_to_fit();
     g_search_result.total_matches = 0;
+    g_search_result.matched_lines = 0;
     g_search_result.is_searched = false;
+    g_search_result.count_only = false;
 }
 
-void perform_analysis_gui(const char* filename, int case_sensitive, int sort_mode) {
+/**
+ * @brief Thêm một dòng kết quả (chưa có đoạn khớp) vào g_search_result.
+ */
+static void begin_found_line(const char* line_start, const char* line_end, int line_number) {
+    const char* content_end = (line_end > line_start && line_end[-1] == '\r') ? line_end - 1 : line_end;
+    FoundLine found_line;
+    found_line.offset = (size_t)(line_start - g_search_result.mapped.data);
+    found_line.length = (int)(content_end - line_start);
+    found_line.line_number = line_number;
+    found_line.first_match = g_search_result.matches.size();
+    found_line.match_count = 0;
+    g_search_result.found_lines.push_back(found_line);
+}
+
+/**
+ * @brief Thêm một đoạn khớp vào dòng kết quả cuối cùng (bỏ phần '\r' cuối dòng đã bị cắt khỏi độ dài dòng).
+ */
+static void add_found_match(int start, int end) {
+    FoundLine& found_line = g_search_result.found_lines.back();
+    g_search_result.matches.push_back({start, min(end, found_line.length)});
+    found_line.match_count++;
+    g_search_result.total_matches++;
+}
+
+/**
+ * @brief Sắp xếp và gộp các đoạn khớp chồng lấn của dòng kết quả cuối cùng
+ * (nhiều mẫu hoặc nhiều điểm kết thúc gần đúng có thể khớp cùng một chỗ).
+ */
+static void merge_found_matches() {
+    if (g_search_result.found_lines.empty()) return;
+    FoundLine& found_line = g_search_result.found_lines.back();
+    if (found_line.match_count < 2) return;
+    vector<MatchPosition>::iterator first = g_search_result.matches.begin() + found_line.first_match;
+    sort(first, g_search_result.matches.end(),
+         [](const MatchPosition& a, const MatchPosition& b) { return a.start < b.start; });
+    size_t merged = found_line.first_match;
+    for (size_t i = merged + 1; i < g_search_result.matches.size(); i++) {
+        MatchPosition& last = g_search_result.matches[merged];
+        if (g_search_result.matches[i].start <= last.end) {
+            last.end = max(last.end, g_search_result.matches[i].end);
+        } else {
+            g_search_result.matches[++merged] = g_search_result.matches[i];
+        }
+    }
+    g_search_result.matches.resize(merged + 1);
+    found_line.match_count = (int)(merged + 1 - found_line.first_match);
+}
+
+void perform_analysis_gui(const char* filename, int case_sensitive, int sort_mode, const StopWordSet* stopwords) {
     cleanup_analysis_result();
     snprintf(g_status_message, sizeof(g_status_message), "%s", "Đang phân tích...");
 
@@ -436,7 +502,9 @@ void perform_analysis_gui(const char* filename, int case_sensitive, int sort_mod
             if (!case_sensitive) {
                 to_lowercase(token);
             }
-            ht_insert(hash_table, token);
+            if (stopwords == NULL || !stopwords_contains(stopwords, token, strlen(token))) {
+                ht_insert(hash_table, token);
+            }
             token = strtok(NULL, " \t\n\r,.;:!?\"()");
         }
     }
@@ -462,68 +530,285 @@ void perform_analysis_gui(const char* filename, int case_sensitive, int sort_mod
     snprintf(g_status_message, sizeof(g_status_message), "%s", "Phân tích hoàn thành");
 }
 
-void perform_find_gui(const char* filename, const char* keyword, int case_sensitive, int exact_match) {
-    g_search_result = SearchResult();
-    snprintf(g_status_message, sizeof(g_status_message), "%s", "Đang tìm kiếm...");
+void perform_export_gui(const char* filename, ReportFormat format) {
+    if (!g_analysis_result.is_analyzed) {
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Chưa có kết quả phân tích để xuất");
+        return;
+    }
 
-    FILE* file = fopen(filename, "r");
+    FILE* file = fopen(filename, format == REPORT_BIN ? "wb" : "w");
     if (file == NULL) {
-        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể mở tệp");
+        snprintf(g_status_message, sizeof(g_status_message), "Lỗi: Không thể tạo tệp '%s'", filename);
         return;
     }
 
-    string keyword_str(keyword);
-    if (!case_sensitive) {to_lowercase_string(keyword_str);}
-    size_t keyword_len = keyword_str.length();
+    ReportSummary summary = {g_analysis_result.char_count, g_analysis_result.total_word_count,
+                             g_analysis_result.unique_word_count, g_analysis_result.line_count};
+    int result = write_analysis_report(file, format, &summary, g_analysis_result.word_list, g_analysis_result.unique_word_count);
+    fclose(file);
+
+    if (result == 0) {
+        snprintf(g_status_message, sizeof(g_status_message), "Đã xuất kết quả: %s", filename);
+    } else {
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Xuất kết quả thất bại");
+    }
+}
+
+/**
+ * @brief Tìm từ khóa trong tệp và lưu kết quả cho tab tìm kiếm.
+ * @param count_only Chỉ đếm số kết quả và số dòng, không sao chép nội dung dòng.
+ * @param max_lines Dừng quét sau khi có đủ số dòng khớp này (0 = không giới hạn).
+ */
+void perform_find_gui(const char* filename, const char* keyword, int case_sensitive, int exact_match, int count_only, int max_lines) {
+    cleanup_search_result();
+    snprintf(g_status_message, sizeof(g_status_message), "%s", "Đang tìm kiếm...");
+
+    size_t keyword_len = strlen(keyword);
     if (keyword_len == 0) {
-        fclose(file);
         snprintf(g_status_message, sizeof(g_status_message), "%s", "Từ khóa không được để trống");
         return;
     }
 
-    char line_buffer[4096];
-    int line_number = 0;
-    while (fgets(line_buffer, sizeof(line_buffer), file) != NULL) {
-        line_number++;
-        string original_line(line_buffer);
-        string line_to_search = original_line;
-        if (!case_sensitive) to_lowercase_string(line_to_search);
-
-        FoundLine current_found_line;
-        current_found_line.line_number = line_number;
-        current_found_line.line_content = original_line;
-
-        size_t start_pos = 0;
-        while ((start_pos = line_to_search.find(keyword_str, start_pos)) != string::npos) {
-            // Logic cho "Chỉ khớp toàn bộ từ"
-            if (exact_match) {
-                bool is_word_boundary_before = (start_pos == 0) || !isalnum(line_to_search[start_pos - 1]);
-                bool is_word_boundary_after = (start_pos + keyword_len == line_to_search.length()) || !isalnum(line_to_search[start_pos + keyword_len]);
-                if (!is_word_boundary_before || !is_word_boundary_after) {
-                    start_pos += 1; // Không phải toàn bộ từ, tìm tiếp
-                    continue;
-                }
+    MappedFile& mapped = g_search_result.mapped;
+    if (map_file(filename, &mapped) != 0) {
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể mở tệp");
+        return;
+    }
+
+    SearchPattern pattern;
+    if (search_compile(&pattern, keyword, keyword_len, case_sensitive) != 0) {
+        unmap_file(&mapped);
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể tạo mẫu tìm kiếm");
+        return;
+    }
+
+    // Quét thẳng trên vùng nhớ ánh xạ; mỗi dòng có kết quả chỉ được ghi lại vị trí, không sao chép
+    const char* data = mapped.data;
+    const char* end = data + mapped.size;
+    const char* pos = data;
+    const char* line_start = data; // Đầu dòng đang xét
+    const char* line_end = NULL;   // Cuối dòng đang xét (NULL nếu chưa xác định)
+    int line_number = 1;
+
+    g_search_result.count_only = count_only != 0;
+    const char* hit;
+    while ((hit = search_next(&pattern, pos, end)) != NULL) {
+        // Logic cho "Chỉ khớp toàn bộ từ": hai bên phải là ký tự phân tách của tokenizer, như lệnh 'find --match'
+        // ('\n' là ký tự phân tách nên không cần biết dòng)
+        if (exact_match) {
+            bool is_word_boundary_before = (hit == data) || is_token_delimiter(hit[-1]);
+            bool is_word_boundary_after = (hit + keyword_len >= end) || is_token_delimiter(hit[keyword_len]);
+            if (!is_word_boundary_before || !is_word_boundary_after) {
+                pos = hit + 1; // Không phải toàn bộ từ, tìm tiếp
+                continue;
             }
-            
-            // Tìm thấy một kết quả hợp lệ, lưu lại vị trí
-            current_found_line.matches.push_back({(int)start_pos, (int)(start_pos + keyword_len)});
+        }
+
+        // Chuyển sang dòng chứa hit nếu nó nằm sau dòng đang xét
+        if (line_end == NULL || hit > line_end) {
+            if (max_lines > 0 && g_search_result.matched_lines == max_lines) break; // Đã đủ số dòng yêu cầu
+            g_search_result.matched_lines++;
+            if (count_only) {
+                // Chỉ cần biết cuối dòng để đếm mỗi dòng một lần; không đếm số dòng, không sao chép
+                const char* newline = (const char*)memchr(hit, '\n', end - hit);
+                line_end = newline != NULL ? newline : end;
+                g_search_result.total_matches++;
+                pos = hit + keyword_len;
+                continue;
+            }
+            const char* new_line_start = hit;
+            while (new_line_start > line_start && new_line_start[-1] != '\n') new_line_start--;
+            line_number += (int)count_newlines(line_start, new_line_start);
+            line_start = new_line_start;
+            const char* newline = (const char*)memchr(hit, '\n', end - hit);
+            line_end = newline != NULL ? newline : end;
+            begin_found_line(line_start, line_end, line_number);
+        } else if (count_only) {
             g_search_result.total_matches++;
-            
-            // Di chuyển vị trí tìm kiếm đến sau từ vừa tìm thấy
-            start_pos += keyword_len;
+            pos = hit + keyword_len;
+            continue;
         }
 
-        // Nếu dòng này có chứa kết quả, thêm nó vào danh sách
-        if (!current_found_line.matches.empty()) {
-            g_search_result.found_lines.push_back(current_found_line);
+        // Tìm thấy một kết quả hợp lệ, lưu lại vị trí
+        add_found_match((int)(hit - line_start), (int)(hit - line_start + keyword_len));
+
+        // Di chuyển vị trí tìm kiếm đến sau từ vừa tìm thấy
+        pos = hit + keyword_len;
+    }
+
+    search_free(&pattern);
+    if (g_search_result.found_lines.empty()) unmap_file(&mapped); // Không có dòng nào cần hiển thị
+    g_search_result.is_searched = true;
+
+    if (g_search_result.total_matches > 0) {
+        snprintf(g_status_message, sizeof(g_status_message), "Tìm thấy %d kết quả trong %d dòng", g_search_result.total_matches, g_search_result.matched_lines);
+    } else {
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Không tìm thấy kết quả nào");
+    }
+}
+
+// Trạng thái tìm kiếm nhiều mẫu (automaton Aho-Corasick) hoặc tìm gần đúng khi nhận từng kết quả
+struct PatternFindState {
+    const char* data;
+    const char* end;
+    int exact_match;
+    const FuzzyPattern* fuzzy; // Chỉ dùng khi tìm gần đúng
+    const char* line_start; // Dòng chứa kết quả gần nhất (line_end == NULL nếu chưa có)
+    const char* line_end;
+    int line_number;
+};
+
+/**
+ * @brief Chuyển sang dòng chứa vị trí position nếu nó nằm sau dòng đang xét (kết quả đến theo thứ tự tăng dần).
+ */
+static void advance_found_line(PatternFindState* state, const char* position) {
+    if (state->line_end == NULL || position > state->line_end) {
+        merge_found_matches();
+        const char* new_line_start = position;
+        while (new_line_start > state->line_start && new_line_start[-1] != '\n') new_line_start--;
+        state->line_number += (int)count_newlines(state->line_start, new_line_start);
+        state->line_start = new_line_start;
+        const char* newline = (const char*)memchr(position, '\n', state->end - position);
+        state->line_end = newline != NULL ? newline : state->end;
+        begin_found_line(state->line_start, state->line_end, state->line_number);
+    }
+}
+
+static int collect_pattern_hit(void* context, int pattern_index, const char* match_start, const char* match_end) {
+    (void)pattern_index;
+    PatternFindState* state = (PatternFindState*)context;
+
+    // "Chỉ khớp toàn bộ từ": hai bên kết quả phải là ký tự phân tách
+    if (state->exact_match) {
+        if (match_start > state->data && !is_token_delimiter(match_start[-1])) return 0;
+        if (match_end < state->end && !is_token_delimiter(*match_end)) return 0;
+    }
+
+    advance_found_line(state, match_start);
+    add_found_match((int)(match_start - state->line_start), (int)(match_end - state->line_start));
+    return 0;
+}
+
+/**
+ * @brief Nhận vị trí kết thúc của một chuỗi khớp gần đúng; điểm bắt đầu được tìm bằng quét ngược.
+ * Các vị trí kết thúc liền nhau của cùng một chỗ khớp chồng lấn nhau và được gộp khi lưu dòng.
+ */
+static int collect_fuzzy_hit(void* context, const char* match_end, int errors) {
+    (void)errors;
+    PatternFindState* state = (PatternFindState*)context;
+    advance_found_line(state, match_end - 1);
+    const char* match_start = fuzzy_match_start(state->fuzzy, state->line_start, match_end);
+    add_found_match((int)(match_start - state->line_start), (int)(match_end - state->line_start));
+    return 0;
+}
+
+void perform_find_patterns_gui(const char* filename, const char* patterns_filename, int case_sensitive, int exact_match) {
+    cleanup_search_result();
+    snprintf(g_status_message, sizeof(g_status_message), "%s", "Đang tìm kiếm...");
+
+    PatternList patterns;
+    if (pattern_list_load(&patterns, patterns_filename) != 0) {
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể đọc tệp danh sách mẫu");
+        return;
+    }
+    MultiSearch automaton;
+    if (multisearch_compile(&automaton, patterns.patterns, patterns.lengths, patterns.count, case_sensitive) != 0) {
+        pattern_list_free(&patterns);
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Tệp danh sách mẫu không có mẫu hợp lệ");
+        return;
+    }
+    MappedFile& mapped = g_search_result.mapped;
+    if (map_file(filename, &mapped) != 0) {
+        multisearch_free(&automaton);
+        pattern_list_free(&patterns);
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể mở tệp");
+        return;
+    }
+
+    PatternFindState state;
+    state.data = mapped.data;
+    state.end = mapped.data + mapped.size;
+    state.exact_match = exact_match;
+    state.fuzzy = NULL;
+    state.line_start = mapped.data;
+    state.line_end = NULL;
+    state.line_number = 1;
+
+    multisearch_scan(&automaton, state.data, state.end, collect_pattern_hit, &state);
+    merge_found_matches();
+
+    if (g_search_result.found_lines.empty()) unmap_file(&mapped);
+    multisearch_free(&automaton);
+    g_search_result.is_searched = true;
+
+    if (g_search_result.total_matches > 0) {
+        snprintf(g_status_message, sizeof(g_status_message), "Tìm thấy %d kết quả (%d mẫu)", g_search_result.total_matches, patterns.count);
+    } else {
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Không tìm thấy kết quả nào");
+    }
+    pattern_list_free(&patterns);
+}
+
+/**
+ * @brief Tìm gần đúng (tối đa max_errors lỗi thêm/xóa/thay) và tô sáng các chuỗi khớp.
+ * Bộ lọc của fuzzy_find_line tìm nhanh các dòng có kết quả, sau đó chỉ những dòng đó được quét
+ * lại để lấy từng chuỗi khớp.
+ * @param count_only Chỉ đếm số kết quả và số dòng, không giữ lại các dòng.
+ * @param max_lines Dừng quét sau khi có đủ số dòng khớp này (0 = không giới hạn).
+ */
+void perform_find_fuzzy_gui(const char* filename, const char* keyword, int case_sensitive, int max_errors, int count_only, int max_lines) {
+    cleanup_search_result();
+    snprintf(g_status_message, sizeof(g_status_message), "%s", "Đang tìm kiếm...");
+
+    FuzzyPattern fuzzy;
+    if (fuzzy_compile(&fuzzy, keyword, strlen(keyword), max_errors, case_sensitive) != 0) {
+        snprintf(g_status_message, sizeof(g_status_message), "Lỗi: Từ khóa phải dài 1-%d ký tự và dài hơn số lỗi cho phép", FUZZY_MAX_PATTERN);
+        return;
+    }
+    MappedFile& mapped = g_search_result.mapped;
+    if (map_file(filename, &mapped) != 0) {
+        fuzzy_free(&fuzzy);
+        snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể mở tệp");
+        return;
+    }
+
+    PatternFindState state;
+    state.data = mapped.data;
+    state.end = mapped.data + mapped.size;
+    state.exact_match = 0;
+    state.fuzzy = &fuzzy;
+    state.line_start = mapped.data;
+    state.line_end = NULL;
+    state.line_number = 1;
+
+    g_search_result.count_only = count_only != 0;
+    int total_matches = 0; // Số chuỗi khớp sau khi gộp các điểm kết thúc chồng lấn
+    const char* p = state.data;
+    const char* line_start;
+    const char* line_end;
+    while (p < state.end && fuzzy_find_line(&fuzzy, p, state.end, &line_start, &line_end)) {
+        if (max_lines > 0 && g_search_result.matched_lines == max_lines) break; // Đã đủ số dòng yêu cầu
+        size_t line_count = g_search_result.found_lines.size();
+        fuzzy_scan(&fuzzy, line_start, line_end, collect_fuzzy_hit, &state);
+        p = line_end + 1;
+        if (g_search_result.found_lines.size() == line_count) continue;
+        merge_found_matches();
+        g_search_result.matched_lines++;
+        total_matches += g_search_result.found_lines.back().match_count;
+        if (count_only) {
+            // Chỉ cần số chuỗi khớp của dòng; bỏ dòng vừa dựng để không giữ lại kết quả
+            g_search_result.matches.resize(g_search_result.found_lines.back().first_match);
+            g_search_result.found_lines.pop_back();
         }
     }
+    g_search_result.total_matches = total_matches; // add_found_match đếm cả các điểm kết thúc đã được gộp
 
-    fclose(file);
+    if (g_search_result.found_lines.empty()) unmap_file(&mapped);
+    fuzzy_free(&fuzzy);
     g_search_result.is_searched = true;
 
     if (g_search_result.total_matches > 0) {
-        snprintf(g_status_message, sizeof(g_status_message), "Tìm thấy %d kết quả", g_search_result.total_matches);
+        snprintf(g_status_message, sizeof(g_status_message), "Tìm thấy %d kết quả trong %d dòng (tối đa %d lỗi)", g_search_result.total_matches, g_search_result.matched_lines, max_errors);
     } else {
         snprintf(g_status_message, sizeof(g_status_message), "%s", "Không tìm thấy kết quả nào");
     }
@@ -533,6 +818,10 @@ CompressionAlgorithm get_algo_from_string(const char* str) {
     if (str == NULL) return ALG_UNKNOWN;
     if (strcmp(str, "rle") == 0) return ALG_RLE;
     if (strcmp(str, "huff") == 0) return ALG_HUFFMAN;
+    if (strcmp(str, "rleb") == 0) return ALG_RLE_BLOCK;
+    if (strcmp(str, "huffb") == 0) return ALG_HUFFMAN_BLOCK;
+    if (strcmp(str, "lz77") == 0) return ALG_LZ77;
+    if (strcmp(str, "lzh") == 0) return ALG_LZH;
     return ALG_UNKNOWN;
 }
 
@@ -540,6 +829,10 @@ const char* get_string_from_algo(CompressionAlgorithm algo) {
     switch(algo) {
         case ALG_RLE: return "rle";
         case ALG_HUFFMAN: return "huff";
+        case ALG_RLE_BLOCK: return "rleb";
+        case ALG_HUFFMAN_BLOCK: return "huffb";
+        case ALG_LZ77: return "lz77";
+        case ALG_LZH: return "lzh";
         default: return "unknown";
     }
 }
@@ -550,10 +843,23 @@ CompressionAlgorithm get_algo_from_filename(const char* filename) {
     if (ext != NULL) {
         if (strcmp(ext, ".rle") == 0) return ALG_RLE;
         if (strcmp(ext, ".huff") == 0) return ALG_HUFFMAN;
+        if (strcmp(ext, ".rleb") == 0) return ALG_RLE_BLOCK;
+        if (strcmp(ext, ".huffb") == 0) return ALG_HUFFMAN_BLOCK;
+        if (strcmp(ext, ".lz77") == 0) return ALG_LZ77;
+        if (strcmp(ext, ".lzh") == 0) return ALG_LZH;
     }
     return ALG_UNKNOWN;
 }
 
+// Chế độ nén tự động: lấy mẫu tệp đầu vào để chọn thuật toán (và đuôi tệp) trước khi nén
+CompressionAlgorithm choose_algo_for_file(const char* filename) {
+    FILE* input_file = fopen(filename, "rb");
+    if (input_file == NULL) return ALG_LZH; // perform_compress_gui sẽ báo lỗi mở tệp
+    CompressionAlgorithm algo = choose_compression_algorithm(input_file);
+    fclose(input_file);
+    return algo;
+}
+
 long long perform_compress_gui(const char* input_filename, const char* full_output_filename, CompressionAlgorithm algo) {
     snprintf(g_status_message, sizeof(g_status_message), "%s", "Đang nén...");
 
@@ -570,7 +876,7 @@ long long perform_compress_gui(const char* input_filename, const char* full_outp
         return -1;
     }
 
-    int result = compress_file(input_file, output_file, algo);
+    int result = compress_file(input_file, output_file, algo, NULL);
     fclose(input_file);
     fclose(output_file);
 
@@ -599,12 +905,14 @@ long long perform_decompress_gui(const char* input_filename, const char* output_
         return -1;
     }
 
-    int result = decompress_file(input_file, output_file, algo);
+    // Thuật toán được nhận diện qua header; algo chỉ là gợi ý cho RLE cũ không có header
+    CompressionAlgorithm detected = ALG_UNKNOWN;
+    int result = decompress_file(input_file, output_file, algo, NULL, &detected);
     fclose(input_file);
     fclose(output_file);
 
     if (result == 0) {
-        snprintf(g_status_message, sizeof(g_status_message), "Giải nén thành công: %s", output_filename);
+        snprintf(g_status_message, sizeof(g_status_message), "Giải nén thành công (%s): %s", get_string_from_algo(detected), output_filename);
         return get_file_size(output_filename);
     } else {
         snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Giải nén thất bại");
@@ -680,16 +988,55 @@ void RenderAnalysisTab(char* selectedFile) {
         RadioButton(u8"tần suất (giảm)", &sort_mode, 4);
         RadioButton(u8"tần suất (tăng)", &sort_mode, 5);
 
+        static int stopword_mode = 0; // 0: Không lọc, 1: Tiếng Anh, 2: Tiếng Việt, 3: Từ tệp
+        static char stopword_path[MAX_PATH] = "";
+        Text(u8"Lọc từ dừng:");
+        RadioButton(u8"Không", &stopword_mode, 0); SameLine();
+        RadioButton(u8"Anh", &stopword_mode, 1); SameLine();
+        RadioButton(u8"Việt", &stopword_mode, 2); SameLine();
+        RadioButton(u8"Tệp", &stopword_mode, 3);
+        if (stopword_mode == 3) {
+            InputText(u8"Tệp từ dừng", stopword_path, MAX_PATH);
+        }
+
         Dummy(ImVec2(0.0f, 20.0f));
 
         if (Button(u8"Bắt đầu phân tích", ImVec2(-FLT_MIN, 40))) {
             if (strlen(selectedFile) > 0 && strcmp(selectedFile, "Chưa chọn tệp nào") != 0) {
-                perform_analysis_gui(selectedFile, case_sensitive, sort_mode);
+                const char* stopword_sources[] = {NULL, "en", "vi", stopword_path};
+                StopWordSet* stopwords = NULL;
+                if (stopword_mode != 0) {
+                    stopwords = stopwords_create(stopword_sources[stopword_mode]);
+                }
+                if (stopword_mode != 0 && stopwords == NULL) {
+                    snprintf(g_status_message, sizeof(g_status_message), "%s", "Lỗi: Không thể tải danh sách từ dừng");
+                } else {
+                    perform_analysis_gui(selectedFile, case_sensitive, sort_mode, stopwords);
+                }
+                stopwords_free(stopwords);
             } else {
                 snprintf(g_status_message, sizeof(g_status_message), "%s", "Vui lòng chọn tệp trước");
             }
         }
 
+        // --- Xuất kết quả dạng máy đọc ---
+        Dummy(ImVec2(0.0f, 10.0f));
+        Text(u8"Xuất kết quả:");
+        static int export_format = 0; // 0: JSON, 1: CSV, 2: Nhị phân
+        RadioButton("JSON", &export_format, 0); SameLine();
+        RadioButton("CSV", &export_format, 1); SameLine();
+        RadioButton("BIN", &export_format, 2);
+        static char export_path[MAX_PATH] = "report.json";
+        InputText(u8"Tên tệp", export_path, MAX_PATH);
+        if (Button(u8"Xuất", ImVec2(-FLT_MIN, 0))) {
+            const ReportFormat formats[] = {REPORT_JSON, REPORT_CSV, REPORT_BIN};
+            if (strlen(export_path) > 0) {
+                perform_export_gui(export_path, formats[export_format]);
+            } else {
+                snprintf(g_status_message, sizeof(g_status_message), "%s", "Vui lòng nhập tên tệp xuất");
+            }
+        }
+
         Separator();
         TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), u8"Trạng thái: %s", g_status_message);
 
@@ -875,17 +1222,27 @@ void RenderCompressTab(char* selectedFile) {
         SameLine();
         if (RadioButton(u8"Giải nén tệp", &operation, 1)) { output_file_size = -1; }
 
+        // Các thuật toán hiển thị trên giao diện; chế độ tự động (nén và giải nén) nằm sau thuật toán cuối cùng
+        static const CompressionAlgorithm algo_choices[] = { ALG_RLE, ALG_HUFFMAN, ALG_RLE_BLOCK, ALG_HUFFMAN_BLOCK, ALG_LZ77, ALG_LZH };
+        static const char* compress_labels[] = { "RLE##compress", "Huffman##compress", u8"RLE khối##compress", u8"Huffman khối##compress", "LZ77##compress", "LZH##compress" };
+        static const char* decompress_labels[] = { "RLE##decompress", "Huffman##decompress", u8"RLE khối##decompress", u8"Huffman khối##decompress", "LZ77##decompress", "LZH##decompress" };
+        const int num_algo_choices = (int)(sizeof(algo_choices) / sizeof(algo_choices[0]));
         static int compress_algo = 0;
-        static int decompress_mode = 2; // Mặc định là Tự động
+        static int decompress_mode = num_algo_choices; // Mặc định là Tự động
         
         Text(u8"Chọn thuật toán:");
         if (operation == 0) { // Giao diện khi Nén
-            RadioButton("RLE##compress", &compress_algo, 0); SameLine();
-            RadioButton("Huffman##compress", &compress_algo, 1);
+            for (int i = 0; i < num_algo_choices; i++) {
+                if (i > 0) SameLine();
+                RadioButton(compress_labels[i], &compress_algo, i);
+            }
+            SameLine();
+            RadioButton(u8"Tự động chọn##compress", &compress_algo, num_algo_choices);
         } else { // Giao diện khi Giải nén
-            RadioButton("RLE##decompress", &decompress_mode, 0); SameLine();
-            RadioButton("Huffman##decompress", &decompress_mode, 1); SameLine();
-            RadioButton(u8"Tự động nhận diện", &decompress_mode, 2);
+            for (int i = 0; i < num_algo_choices; i++) {
+                RadioButton(decompress_labels[i], &decompress_mode, i); SameLine();
+            }
+            RadioButton(u8"Tự động nhận diện", &decompress_mode, num_algo_choices);
         }
 
         static char output_path[MAX_PATH] = "output"; // Tên tệp đầu ra mặc định
@@ -906,7 +1263,11 @@ void RenderCompressTab(char* selectedFile) {
                     CompressionAlgorithm algo_to_use;
 
                     if (operation == 0) { // Nén
-                        algo_to_use = (compress_algo == 0) ? ALG_RLE : ALG_HUFFMAN;
+                        if (compress_algo == num_algo_choices) {
+                            algo_to_use = choose_algo_for_file(selectedFile);
+                        } else {
+                            algo_to_use = algo_choices[compress_algo];
+                        }
                         const char* extension = get_string_from_algo(algo_to_use);
                         snprintf(final_output_name, sizeof(final_output_name), "%s.%s", output_path, extension);
                     } else { // Giải nén
@@ -927,18 +1288,13 @@ void RenderCompressTab(char* selectedFile) {
                     if (operation == 0) { // Nén
                         output_file_size = perform_compress_gui(selectedFile, final_output_name, algo_to_use);
                     } else { // Giải nén
-                        if (decompress_mode == 2) {
+                        if (decompress_mode == num_algo_choices) {
                             algo_to_use = get_algo_from_filename(selectedFile);
                         } else {
-                            algo_to_use = (decompress_mode == 0) ? ALG_RLE : ALG_HUFFMAN;
+                            algo_to_use = algo_choices[decompress_mode];
                         }
 
-                        if (algo_to_use != ALG_UNKNOWN) {
-                            output_file_size = perform_decompress_gui(selectedFile, final_output_name, algo_to_use);
-                        } else {
-                            snprintf(g_status_message, sizeof(g_status_message), "Lỗi: Không nhận diện được định dạng tệp nén");
-                            output_file_size = -1;
-                        }
+                        output_file_size = perform_decompress_gui(selectedFile, final_output_name, algo_to_use);
                     }
 
                 } else { /* Lỗi thiếu tên tệp đầu ra */ 
@@ -991,8 +1347,16 @@ void RenderFindTab(char* selectedFile, int theme_choice) {
     if (BeginTabItem(u8"Tìm kiếm")) {
         RenderFileSelector(selectedFile, MAX_PATH);
 
+        static bool use_pattern_list = false;
+        Checkbox(u8"Tìm theo danh sách mẫu (mỗi dòng một mẫu)", &use_pattern_list);
+
         static char keyword_input[256] = "";
-        InputText(u8"Nhập từ khóa", keyword_input, 256);
+        static char patterns_path[MAX_PATH] = "";
+        if (use_pattern_list) {
+            InputText(u8"Tệp danh sách mẫu", patterns_path, MAX_PATH);
+        } else {
+            InputText(u8"Nhập từ khóa", keyword_input, 256);
+        }
 
         static bool find_exact_match = false;
         Checkbox(u8"Khớp chính xác toàn bộ từ", &find_exact_match);
@@ -1000,10 +1364,36 @@ void RenderFindTab(char* selectedFile, int theme_choice) {
         static bool case_sensitive_find = false;
         Checkbox(u8"Phân biệt hoa/thường", &case_sensitive_find);
 
+        static bool find_fuzzy = false;
+        static int find_max_errors = 1;
+        static bool find_count_only = false;
+        static int find_max_lines = 0;
+        if (!use_pattern_list) {
+            Checkbox(u8"Tìm gần đúng (chấp nhận lỗi chính tả)", &find_fuzzy);
+            if (find_fuzzy) {
+                SameLine();
+                SetNextItemWidth(100);
+                InputInt(u8"Số lỗi cho phép", &find_max_errors);
+                if (find_max_errors < 0) find_max_errors = 0;
+            }
+            Checkbox(u8"Chỉ đếm số kết quả (không hiển thị dòng)", &find_count_only);
+            SetNextItemWidth(120);
+            InputInt(u8"Số dòng tối đa (0 = không giới hạn)", &find_max_lines);
+            if (find_max_lines < 0) find_max_lines = 0;
+        }
+
         if (Button(u8"Tìm kiếm", ImVec2(120, 0))) {
             if (strlen(selectedFile) > 0 && strcmp(selectedFile, "Chưa chọn tệp nào") != 0) {
-                if (strlen(keyword_input) > 0) {
-                    perform_find_gui(selectedFile, keyword_input, case_sensitive_find, find_exact_match);
+                if (use_pattern_list) {
+                    if (strlen(patterns_path) > 0) {
+                        perform_find_patterns_gui(selectedFile, patterns_path, case_sensitive_find, find_exact_match);
+                    } else {
+                        snprintf(g_status_message, sizeof(g_status_message), "%s", "Vui lòng nhập tệp danh sách mẫu");
+                    }
+                } else if (strlen(keyword_input) > 0 && find_fuzzy) {
+                    perform_find_fuzzy_gui(selectedFile, keyword_input, case_sensitive_find, find_max_errors, find_count_only, find_max_lines);
+                } else if (strlen(keyword_input) > 0) {
+                    perform_find_gui(selectedFile, keyword_input, case_sensitive_find, find_exact_match, find_count_only, find_max_lines);
                 } else {
                     snprintf(g_status_message, sizeof(g_status_message), "%s", "Vui lòng nhập từ khóa");
                 }
@@ -1023,6 +1413,9 @@ void RenderFindTab(char* selectedFile, int theme_choice) {
             // --- LOGIC HIỂN THỊ ĐÃ ĐƯỢC SỬA LẠI ĐỂ TRÁNH THOÁT SỚM ---
             if (!g_search_result.is_searched) {
                 Text(u8"Chưa có kết quả tìm kiếm.");
+            } else if (g_search_result.count_only) {
+                Text(u8"Số kết quả: %d", g_search_result.total_matches);
+                Text(u8"Số dòng khớp: %d", g_search_result.matched_lines);
             } else if (g_search_result.found_lines.empty()) {
                 Text(u8"Không tìm thấy từ khóa trong tệp.");
             } else {
@@ -1034,33 +1427,41 @@ void RenderFindTab(char* selectedFile, int theme_choice) {
                     highlight_color = ImVec4(0.39f, 0.58f, 0.93f, 1.0f);
                 }
                 
-                for (const auto& found_line : g_search_result.found_lines) {
-                    TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Dòng %d:", found_line.line_number);
-                    SameLine();
-
-                    const char* line_start = found_line.line_content.c_str();
-                    int last_pos = 0;
-
-                    for (const auto& match : found_line.matches) {
-                        if (match.start > last_pos) {
-                            TextUnformatted(line_start + last_pos, line_start + match.start);
+                // Chỉ dựng các dòng đang nằm trong vùng nhìn thấy; nội dung đọc thẳng từ tệp đã ánh xạ
+                ImGuiListClipper clipper;
+                clipper.Begin((int)g_search_result.found_lines.size());
+                while (clipper.Step()) {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                        const FoundLine& found_line = g_search_result.found_lines[row];
+                        TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Dòng %d:", found_line.line_number);
+                        SameLine();
+
+                        const char* line_start = g_search_result.mapped.data + found_line.offset;
+                        int last_pos = 0;
+
+                        for (int i = 0; i < found_line.match_count; i++) {
+                            const MatchPosition& match = g_search_result.matches[found_line.first_match + i];
+                            if (match.start > last_pos) {
+                                TextUnformatted(line_start + last_pos, line_start + match.start);
+                                SameLine(0, 0);
+                            }
+
+                            PushStyleColor(ImGuiCol_Text, highlight_color);
+                            TextUnformatted(line_start + match.start, line_start + match.end);
+                            PopStyleColor();
                             SameLine(0, 0);
-                        }
 
-                        PushStyleColor(ImGuiCol_Text, highlight_color);
-                        TextUnformatted(line_start + match.start, line_start + match.end);
-                        PopStyleColor();
-                        SameLine(0, 0);
-                        
-                        last_pos = match.end;
-                    }
+                            last_pos = match.end;
+                        }
 
-                    if (last_pos < (int)found_line.line_content.length()) {
-                        TextUnformatted(line_start + last_pos);
-                    } else {
-                        NewLine();
+                        if (last_pos < found_line.length) {
+                            TextUnformatted(line_start + last_pos, line_start + found_line.length);
+                        } else {
+                            NewLine();
+                        }
                     }
                 }
+                clipper.End();
             }
         }
         // Đóng vùng chứa kết quả
@@ -0,0 +1,80 @@
+#include <string.h>
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+int map_file(const char* filename, MappedFile* mapped) {
+    memset(mapped, 0, sizeof(MappedFile));
+
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return -1;
+    }
+    mapped->file_handle = file;
+    mapped->size = (size_t)size.QuadPart;
+    if (mapped->size == 0) return 0; // Không thể ánh xạ tệp rỗng, nhưng đây không phải lỗi
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        unmap_file(mapped);
+        return -1;
+    }
+    mapped->mapping_handle = mapping;
+    mapped->data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (mapped->data == NULL) {
+        unmap_file(mapped);
+        return -1;
+    }
+    return 0;
+}
+
+void unmap_file(MappedFile* mapped) {
+    if (mapped->data != NULL) UnmapViewOfFile((LPCVOID)mapped->data);
+    if (mapped->mapping_handle != NULL) CloseHandle((HANDLE)mapped->mapping_handle);
+    if (mapped->file_handle != NULL) CloseHandle((HANDLE)mapped->file_handle);
+    memset(mapped, 0, sizeof(MappedFile));
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int map_file(const char* filename, MappedFile* mapped) {
+    memset(mapped, 0, sizeof(MappedFile));
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -1;
+    }
+    mapped->size = (size_t)info.st_size;
+    if (mapped->size > 0) {
+        void* data = mmap(NULL, mapped->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            mapped->size = 0;
+            return -1;
+        }
+        madvise(data, mapped->size, MADV_SEQUENTIAL);
+        mapped->data = (const char*)data;
+    }
+    close(fd); // Vùng ánh xạ vẫn hợp lệ sau khi đóng fd
+    return 0;
+}
+
+void unmap_file(MappedFile* mapped) {
+    if (mapped->data != NULL) munmap((void*)mapped->data, mapped->size);
+    memset(mapped, 0, sizeof(MappedFile));
+}
+#endif
@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Một tệp được ánh xạ chỉ-đọc vào bộ nhớ.
+ * Dữ liệu KHÔNG kết thúc bằng '\0'; luôn dùng kèm size.
+ */
+typedef struct {
+    const char* data; // NULL nếu tệp rỗng
+    size_t size;
+    void* file_handle;    // HANDLE của tệp (Windows)
+    void* mapping_handle; // HANDLE của vùng ánh xạ (Windows)
+} MappedFile;
+
+/**
+ * @brief Ánh xạ toàn bộ tệp vào bộ nhớ để đọc.
+ * @param filename Đường dẫn tệp.
+ * @param mapped Cấu trúc nhận kết quả.
+ * @return 0 nếu thành công, -1 nếu thất bại.
+ */
+int map_file(const char* filename, MappedFile* mapped);
+
+/**
+ * @brief Hủy ánh xạ và đóng tệp. An toàn khi gọi nhiều lần.
+ */
+void unmap_file(MappedFile* mapped);
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "multisearch.h"
+#include "search.h"
+
+// Bit cao của mỗi ô trong bảng chuyển: trạng thái đích có mẫu kết thúc tại đó
+#define MULTISEARCH_MATCH_FLAG 0x80000000u
+#define MULTISEARCH_STATE_MASK 0x7FFFFFFFu
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static void build_byte_classes(MultiSearch* ms, const char* const* patterns, const size_t* lengths, int count);
+static int build_failure_links(MultiSearch* ms);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+int pattern_list_load(PatternList* list, const char* filename) {
+    memset(list, 0, sizeof(PatternList));
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) return -1;
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (file_size < 0) {
+        fclose(file);
+        return -1;
+    }
+
+    list->storage = (char*)malloc((size_t)file_size + 1);
+    if (list->storage == NULL) {
+        fclose(file);
+        return -1;
+    }
+    size_t size = fread(list->storage, 1, (size_t)file_size, file);
+    fclose(file);
+    list->storage[size] = '\0';
+
+    // Số mẫu tối đa bằng số dòng
+    size_t max_patterns = count_newlines(list->storage, list->storage + size) + 1;
+    list->patterns = (const char**)malloc(max_patterns * sizeof(const char*));
+    list->lengths = (size_t*)malloc(max_patterns * sizeof(size_t));
+    if (list->patterns == NULL || list->lengths == NULL) {
+        pattern_list_free(list);
+        return -1;
+    }
+
+    char* line = list->storage;
+    char* end = list->storage + size;
+    while (line < end) {
+        char* newline = (char*)memchr(line, '\n', end - line);
+        char* line_end = newline != NULL ? newline : end;
+        *line_end = '\0';
+        if (line_end > line && line_end[-1] == '\r') *--line_end = '\0';
+        if (line_end > line) {
+            list->patterns[list->count] = line;
+            list->lengths[list->count] = (size_t)(line_end - line);
+            list->count++;
+        }
+        line = (newline != NULL ? newline : end) + 1;
+    }
+    return 0;
+}
+
+void pattern_list_free(PatternList* list) {
+    free(list->storage);
+    free((void*)list->patterns);
+    free(list->lengths);
+    memset(list, 0, sizeof(PatternList));
+}
+
+int multisearch_compile(MultiSearch* ms, const char* const* patterns, const size_t* lengths, int count, int case_sensitive) {
+    memset(ms, 0, sizeof(MultiSearch));
+    ms->case_sensitive = case_sensitive;
+
+    size_t total_length = 0;
+    for (int i = 0; i < count; i++) total_length += lengths[i];
+    if (total_length == 0) return -1;
+
+    build_byte_classes(ms, patterns, lengths, count);
+    size_t num_classes = (size_t)ms->num_classes;
+
+    // Số trạng thái tối đa của cây trie là tổng độ dài các mẫu + 1 (gốc)
+    size_t max_states = total_length + 1;
+    if (max_states > MULTISEARCH_STATE_MASK / num_classes) return -1;
+    ms->transitions = (uint32_t*)calloc(max_states * num_classes, sizeof(uint32_t));
+    ms->terminal = (int32_t*)malloc(max_states * sizeof(int32_t));
+    ms->dict_link = (int32_t*)malloc(max_states * sizeof(int32_t));
+    ms->pattern_lengths = (size_t*)malloc(count * sizeof(size_t));
+    if (ms->transitions == NULL || ms->terminal == NULL || ms->dict_link == NULL || ms->pattern_lengths == NULL) {
+        multisearch_free(ms);
+        return -1;
+    }
+    memcpy(ms->pattern_lengths, lengths, count * sizeof(size_t));
+    ms->pattern_count = count;
+    ms->terminal[0] = -1;
+    ms->dict_link[0] = -1;
+    ms->num_states = 1;
+
+    // Dựng cây trie; mỗi ô lưu vị trí đầu hàng của trạng thái con (0 = chưa có, vì gốc không là con của ai)
+    for (int i = 0; i < count; i++) {
+        if (lengths[i] == 0) continue;
+        uint32_t state = 0;
+        for (size_t j = 0; j < lengths[i]; j++) {
+            uint32_t* cell = &ms->transitions[state + ms->byte_class[(unsigned char)patterns[i][j]]];
+            if (*cell == 0) {
+                *cell = (uint32_t)(ms->num_states * num_classes);
+                ms->terminal[ms->num_states] = -1;
+                ms->num_states++;
+            }
+            state = *cell;
+        }
+        int32_t id = (int32_t)(state / num_classes);
+        if (ms->terminal[id] < 0) ms->terminal[id] = i; // Mẫu trùng chỉ giữ chỉ số đầu tiên
+    }
+
+    if (build_failure_links(ms) != 0) {
+        multisearch_free(ms);
+        return -1;
+    }
+
+    // Trả lại phần bộ nhớ dự phòng cho các trạng thái không dùng đến
+    uint32_t* shrunk = (uint32_t*)realloc(ms->transitions, (size_t)ms->num_states * num_classes * sizeof(uint32_t));
+    if (shrunk != NULL) ms->transitions = shrunk;
+    return 0;
+}
+
+void multisearch_free(MultiSearch* ms) {
+    free(ms->transitions);
+    free(ms->terminal);
+    free(ms->dict_link);
+    free(ms->pattern_lengths);
+    memset(ms, 0, sizeof(MultiSearch));
+}
+
+int multisearch_scan(const MultiSearch* ms, const char* begin, const char* end, MultiSearchCallback callback, void* context) {
+    const uint32_t* transitions = ms->transitions;
+    const unsigned char* byte_class = ms->byte_class;
+    uint32_t num_classes = (uint32_t)ms->num_classes;
+    uint32_t state = 0;
+
+    for (const unsigned char* p = (const unsigned char*)begin; p < (const unsigned char*)end; p++) {
+        uint32_t next = transitions[state + byte_class[*p]];
+        state = next & MULTISEARCH_STATE_MASK;
+        if (!(next & MULTISEARCH_MATCH_FLAG)) continue;
+
+        // Liệt kê mọi mẫu kết thúc tại đây: mẫu của chính trạng thái rồi theo chuỗi dict_link
+        int32_t id = (int32_t)(state / num_classes);
+        if (ms->terminal[id] < 0) id = ms->dict_link[id];
+        while (id >= 0) {
+            int pattern_index = ms->terminal[id];
+            const char* match_end = (const char*)p + 1;
+            if (callback(context, pattern_index, match_end - ms->pattern_lengths[pattern_index], match_end) != 0) return 1;
+            id = ms->dict_link[id];
+        }
+    }
+    return 0;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+/**
+ * @brief Gom các byte thành lớp tương đương: mỗi byte xuất hiện trong mẫu (sau khi gộp hoa/thường)
+ * có một lớp riêng, mọi byte còn lại dùng chung lớp 0.
+ */
+static void build_byte_classes(MultiSearch* ms, const char* const* patterns, const size_t* lengths, int count) {
+    int class_of[256] = {0};
+    for (int i = 0; i < count; i++) {
+        for (size_t j = 0; j < lengths[i]; j++) {
+            unsigned char c = (unsigned char)patterns[i][j];
+            class_of[ms->case_sensitive ? c : search_fold_table[c]] = 1;
+        }
+    }
+
+    int used = 0;
+    for (int c = 0; c < 256; c++) {
+        if (class_of[c]) class_of[c] = ++used;
+    }
+    // Khi mọi byte đều xuất hiện trong mẫu thì không cần lớp 0
+    int shift = used == 256 ? 1 : 0;
+    ms->num_classes = used + 1 - shift;
+    for (int c = 0; c < 256; c++) {
+        int key = ms->case_sensitive ? c : search_fold_table[c];
+        ms->byte_class[c] = (unsigned char)(class_of[key] > 0 ? class_of[key] - shift : 0);
+    }
+}
+
+/**
+ * @brief Duyệt BFS để tính liên kết lỗi và điền các ô còn trống, biến cây trie thành DFA đầy đủ.
+ * Sau đó đánh dấu bit MULTISEARCH_MATCH_FLAG cho các ô dẫn tới trạng thái có kết quả.
+ */
+static int build_failure_links(MultiSearch* ms) {
+    size_t num_classes = (size_t)ms->num_classes;
+    int32_t* queue = (int32_t*)malloc(ms->num_states * sizeof(int32_t));
+    int32_t* fail = (int32_t*)malloc(ms->num_states * sizeof(int32_t));
+    if (queue == NULL || fail == NULL) {
+        free(queue);
+        free(fail);
+        return -1;
+    }
+
+    int head = 0, tail = 0;
+    for (size_t c = 0; c < num_classes; c++) {
+        uint32_t child = ms->transitions[c];
+        if (child != 0) {
+            int32_t id = (int32_t)(child / num_classes);
+            fail[id] = 0;
+            ms->dict_link[id] = -1;
+            queue[tail++] = id;
+        }
+    }
+
+    while (head < tail) {
+        int32_t u = queue[head++];
+        uint32_t* row = &ms->transitions[(size_t)u * num_classes];
+        const uint32_t* fail_row = &ms->transitions[(size_t)fail[u] * num_classes];
+        for (size_t c = 0; c < num_classes; c++) {
+            if (row[c] == 0) {
+                // Không có cạnh trong trie: đi theo hàng của trạng thái lỗi (đã hoàn chỉnh vì nông hơn)
+                row[c] = fail_row[c];
+                continue;
+            }
+            int32_t v = (int32_t)(row[c] / num_classes);
+            int32_t f = (int32_t)(fail_row[c] / num_classes);
+            fail[v] = f;
+            ms->dict_link[v] = ms->terminal[f] >= 0 ? f : ms->dict_link[f];
+            queue[tail++] = v;
+        }
+    }
+
+    size_t cell_count = (size_t)ms->num_states * num_classes;
+    for (size_t i = 0; i < cell_count; i++) {
+        int32_t id = (int32_t)(ms->transitions[i] / num_classes);
+        if (ms->terminal[id] >= 0 || ms->dict_link[id] >= 0) ms->transitions[i] |= MULTISEARCH_MATCH_FLAG;
+    }
+
+    free(queue);
+    free(fail);
+    return 0;
+}
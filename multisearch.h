@@ -0,0 +1,67 @@
+#ifndef MULTISEARCH_H
+#define MULTISEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Danh sách mẫu đọc từ tệp: mỗi dòng không rỗng là một mẫu.
+ * Các mẫu trỏ thẳng vào bộ đệm chứa nội dung tệp và đều kết thúc bằng '\0'.
+ */
+typedef struct {
+    char* storage;          // Nội dung tệp
+    const char** patterns;
+    size_t* lengths;
+    int count;
+} PatternList;
+
+/**
+ * @brief Đọc danh sách mẫu từ tệp (bỏ '\r' cuối dòng và các dòng rỗng).
+ * @return 0 nếu thành công, -1 nếu không mở được tệp hoặc không cấp phát được bộ nhớ.
+ */
+int pattern_list_load(PatternList* list, const char* filename);
+
+void pattern_list_free(PatternList* list);
+
+/**
+ * @brief Automaton Aho-Corasick đã được biên dịch.
+ * Bảng chuyển trạng thái đầy đủ (không cần đi theo liên kết lỗi khi quét), mỗi trạng thái
+ * là một hàng liên tục gồm num_classes ô; các byte được gom thành lớp tương đương
+ * (byte không xuất hiện trong mẫu nào thuộc lớp 0) để hàng ngắn và vừa trong cache.
+ */
+typedef struct {
+    unsigned char byte_class[256]; // Byte -> lớp tương đương (đã gộp hoa/thường nếu cần)
+    int num_classes;
+    int num_states;
+    uint32_t* transitions;   // num_states * num_classes ô: vị trí đầu hàng của trạng thái kế, bit cao = có kết quả
+    int32_t* terminal;       // Mẫu kết thúc đúng tại trạng thái, -1 nếu không có
+    int32_t* dict_link;      // Trạng thái gần nhất trên chuỗi liên kết lỗi có terminal, -1 nếu không có
+    size_t* pattern_lengths;
+    int pattern_count;
+    int case_sensitive;
+} MultiSearch;
+
+/**
+ * @brief Hàm nhận kết quả khi quét.
+ * @param pattern_index Chỉ số mẫu khớp (mẫu trùng nhau chỉ được báo với chỉ số nhỏ nhất).
+ * @param match_start, match_end Vị trí khớp trong dữ liệu [match_start, match_end).
+ * @return 0 để quét tiếp, khác 0 để dừng.
+ */
+typedef int (*MultiSearchCallback)(void* context, int pattern_index, const char* match_start, const char* match_end);
+
+/**
+ * @brief Biên dịch danh sách mẫu thành automaton (bỏ qua mẫu rỗng).
+ * @return 0 nếu thành công, -1 nếu không có mẫu hợp lệ hoặc không cấp phát được bộ nhớ.
+ */
+int multisearch_compile(MultiSearch* ms, const char* const* patterns, const size_t* lengths, int count, int case_sensitive);
+
+void multisearch_free(MultiSearch* ms);
+
+/**
+ * @brief Quét [begin, end) một lượt, gọi callback cho mọi lần khớp của mọi mẫu
+ * theo thứ tự vị trí kết thúc.
+ * @return 1 nếu callback yêu cầu dừng, 0 nếu đã quét hết.
+ */
+int multisearch_scan(const MultiSearch* ms, const char* begin, const char* end, MultiSearchCallback callback, void* context);
+
+#endif // MULTISEARCH_H
@@ -0,0 +1,811 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "regex_dfa.h"
+#include "search.h"
+
+#define REGEX_MIN_PREFIX_LENGTH 2        // Tiền tố ngắn hơn thì quét bằng DFA nhanh hơn là lọc trước
+#define REGEX_DFA_ARENA_INTS    (1 << 20) // Số phần tử tối thiểu của vùng nhớ chứa tập trạng thái NFA
+
+// Nút của cây cú pháp
+enum { NODE_SET, NODE_CONCAT, NODE_ALT, NODE_REPEAT, NODE_EMPTY, NODE_BOL, NODE_EOL };
+
+typedef struct {
+    int type;
+    int set;          // NODE_SET: chỉ số tập byte
+    int left, right;  // Nút con (NODE_REPEAT chỉ dùng left)
+    int min, max;     // NODE_REPEAT: số lần lặp, max = -1 nghĩa là không giới hạn
+} RegexNode;
+
+// Trạng thái NFA (dựng theo kiểu Thompson)
+enum { NFA_SET, NFA_SPLIT, NFA_BOL, NFA_EOL, NFA_MATCH };
+
+typedef struct {
+    int type;
+    int set;
+    int out, out1;
+} NfaState;
+
+// Tập 256 byte dạng bitmap
+typedef struct {
+    uint32_t bits[8];
+} ByteSet;
+
+typedef struct {
+    const char* pattern;
+    const char* p;
+    const char* end;
+    int case_sensitive;
+    RegexNode* nodes;
+    int node_count, node_capacity;
+    ByteSet* sets;
+    int set_count, set_capacity;
+    char* error;
+    size_t error_size;
+    int failed;
+} RegexParser;
+
+// Trạng thái DFA: một tập trạng thái NFA (đã sắp xếp) nằm trong vùng nhớ set_arena
+typedef struct {
+    size_t set_offset;
+    int set_count;
+    unsigned char line_start;       // Trạng thái đầu dòng (cho phép '^' trong bao đóng)
+    unsigned char accepting;        // Đã có chuỗi khớp
+    unsigned char accepting_at_eol; // Sẽ khớp nếu dòng kết thúc ngay đây (xét '$')
+} DfaState;
+
+struct Regex {
+    NfaState* nfa;
+    int nfa_count;
+    int start;
+    ByteSet* sets;
+    int set_count;
+    unsigned char byte_class[256];
+    unsigned char class_representative[256];
+    int num_classes;
+
+    int has_prefix;
+    SearchPattern prefix;
+
+    // Bộ nhớ đệm DFA có giới hạn
+    DfaState* states;
+    int state_count;
+    int initial_state;       // -1 nếu chưa dựng (hoặc vừa bị xóa)
+    int32_t* transitions;    // REGEX_DFA_MAX_STATES * num_classes, -1 = chưa tính
+    int* set_arena;
+    size_t arena_used, arena_capacity;
+    int32_t* hash_slots;     // Bảng băm địa chỉ mở: tập NFA -> trạng thái DFA
+    size_t hash_capacity;
+    unsigned long flush_count;
+
+    // Vùng làm việc khi tính bao đóng
+    int* work_list;
+    int* work_stack;
+    unsigned int* marks;
+    unsigned int generation;
+};
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static void set_error(RegexParser* parser, const char* message);
+static int new_node(RegexParser* parser, int type, int set, int left, int right);
+static int new_set(RegexParser* parser);
+static void set_add(ByteSet* set, unsigned char c);
+static int set_has(const ByteSet* set, unsigned char c);
+static void set_add_class_escape(ByteSet* set, char escape);
+static void set_fold_case(ByteSet* set);
+static int parse_alternation(RegexParser* parser, int depth);
+static int parse_concat(RegexParser* parser, int depth);
+static int parse_repeat(RegexParser* parser, int depth);
+static int parse_atom(RegexParser* parser, int depth);
+static int parse_escape_byte(RegexParser* parser, char escape, unsigned char* byte);
+static int parse_class(RegexParser* parser);
+static int parse_number(RegexParser* parser, int* value);
+static int emit_nfa(Regex* re, const RegexNode* nodes, int node, int next, size_t* capacity);
+static int new_nfa_state(Regex* re, int type, int set, int out, int out1, size_t* capacity);
+static void build_byte_classes(Regex* re);
+static void extract_prefix(const RegexNode* nodes, int node, unsigned char* prefix, size_t* length, size_t max_length, int* complete, int case_sensitive, const ByteSet* sets);
+static int dfa_init(Regex* re);
+static void dfa_flush(Regex* re);
+static void add_closure(Regex* re, int state, int allow_bol, int* count);
+static int closure_reaches_match(Regex* re, int state, int allow_bol);
+static int find_or_add_state(Regex* re, int count, int line_start);
+static int get_initial_state(Regex* re);
+static int compute_next_state(Regex* re, int state, int byte_class);
+static int compare_ints(const void* a, const void* b);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+Regex* regex_compile(const char* pattern, int case_sensitive, char* error, size_t error_size) {
+    RegexParser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.pattern = pattern;
+    parser.p = pattern;
+    parser.end = pattern + strlen(pattern);
+    parser.case_sensitive = case_sensitive;
+    parser.error = error;
+    parser.error_size = error_size;
+    if (error != NULL && error_size > 0) error[0] = '\0';
+
+    int root = parse_alternation(&parser, 0);
+    if (!parser.failed && parser.p < parser.end) set_error(&parser, "Dấu ')' không có '(' tương ứng");
+    if (parser.failed || root < 0) {
+        free(parser.nodes);
+        free(parser.sets);
+        return NULL;
+    }
+
+    Regex* re = (Regex*)calloc(1, sizeof(Regex));
+    if (re == NULL) {
+        free(parser.nodes);
+        free(parser.sets);
+        return NULL;
+    }
+    re->sets = parser.sets;
+    re->set_count = parser.set_count;
+
+    // Dựng NFA từ cuối về đầu: mỗi nút được nối thẳng vào trạng thái tiếp theo, không cần vá con trỏ
+    size_t capacity = 0;
+    int match = new_nfa_state(re, NFA_MATCH, -1, -1, -1, &capacity);
+    re->start = match < 0 ? -1 : emit_nfa(re, parser.nodes, root, match, &capacity);
+    if (re->start < 0) {
+        if (error != NULL && error_size > 0) snprintf(error, error_size, "%s", "Biểu thức quá lớn");
+        free(parser.nodes);
+        regex_free(re);
+        return NULL;
+    }
+
+    // Tiền tố cố định để lọc trước bằng search_next
+    unsigned char prefix[256];
+    size_t prefix_length = 0;
+    int complete = 1;
+    extract_prefix(parser.nodes, root, prefix, &prefix_length, sizeof(prefix), &complete, case_sensitive, re->sets);
+    free(parser.nodes);
+    if (prefix_length >= REGEX_MIN_PREFIX_LENGTH &&
+        search_compile(&re->prefix, (const char*)prefix, prefix_length, case_sensitive) == 0) {
+        re->has_prefix = 1;
+    }
+
+    build_byte_classes(re);
+    if (dfa_init(re) != 0) {
+        if (error != NULL && error_size > 0) snprintf(error, error_size, "%s", "Không đủ bộ nhớ");
+        regex_free(re);
+        return NULL;
+    }
+    return re;
+}
+
+void regex_free(Regex* re) {
+    if (re == NULL) return;
+    if (re->has_prefix) search_free(&re->prefix);
+    free(re->nfa);
+    free(re->sets);
+    free(re->states);
+    free(re->transitions);
+    free(re->set_arena);
+    free(re->hash_slots);
+    free(re->work_list);
+    free(re->work_stack);
+    free(re->marks);
+    free(re);
+}
+
+int regex_match_line(Regex* re, const char* line_start, const char* line_end) {
+    if (line_end > line_start && line_end[-1] == '\r') line_end--; // '$' khớp trước '\r' của tệp CRLF
+
+    int state = get_initial_state(re);
+    const unsigned char* p = (const unsigned char*)line_start;
+    const unsigned char* end = (const unsigned char*)line_end;
+    for (; p < end; p++) {
+        if (re->states[state].accepting) return 1;
+        int byte_class = re->byte_class[*p];
+        int next = re->transitions[(size_t)state * re->num_classes + byte_class];
+        state = next >= 0 ? next : compute_next_state(re, state, byte_class);
+    }
+    return re->states[state].accepting || re->states[state].accepting_at_eol;
+}
+
+int regex_find_line(Regex* re, const char* begin, const char* end, const char** line_start, const char** line_end) {
+    const char* p = begin;
+    while (p < end) {
+        if (re->has_prefix) {
+            // Nhảy đến dòng chứa ứng viên tiếp theo
+            const char* hit = search_next(&re->prefix, p, end);
+            if (hit == NULL) return 0;
+            const char* ls = hit;
+            while (ls > p && ls[-1] != '\n') ls--;
+            p = ls;
+        }
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        const char* le = newline != NULL ? newline : end;
+        if (regex_match_line(re, p, le)) {
+            *line_start = p;
+            *line_end = le;
+            return 1;
+        }
+        p = le + 1;
+    }
+    return 0;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+static void set_error(RegexParser* parser, const char* message) {
+    if (!parser->failed && parser->error != NULL && parser->error_size > 0) {
+        snprintf(parser->error, parser->error_size, "%s (vị trí %d)", message, (int)(parser->p - parser->pattern));
+    }
+    parser->failed = 1;
+}
+
+static int new_node(RegexParser* parser, int type, int set, int left, int right) {
+    if (parser->failed) return -1;
+    if (parser->node_count == parser->node_capacity) {
+        int capacity = parser->node_capacity == 0 ? 64 : parser->node_capacity * 2;
+        RegexNode* grown = (RegexNode*)realloc(parser->nodes, capacity * sizeof(RegexNode));
+        if (grown == NULL) {
+            set_error(parser, "Không đủ bộ nhớ");
+            return -1;
+        }
+        parser->nodes = grown;
+        parser->node_capacity = capacity;
+    }
+    RegexNode* node = &parser->nodes[parser->node_count];
+    node->type = type;
+    node->set = set;
+    node->left = left;
+    node->right = right;
+    node->min = node->max = 0;
+    return parser->node_count++;
+}
+
+static int new_set(RegexParser* parser) {
+    if (parser->failed) return -1;
+    if (parser->set_count == parser->set_capacity) {
+        int capacity = parser->set_capacity == 0 ? 16 : parser->set_capacity * 2;
+        ByteSet* grown = (ByteSet*)realloc(parser->sets, capacity * sizeof(ByteSet));
+        if (grown == NULL) {
+            set_error(parser, "Không đủ bộ nhớ");
+            return -1;
+        }
+        parser->sets = grown;
+        parser->set_capacity = capacity;
+    }
+    memset(&parser->sets[parser->set_count], 0, sizeof(ByteSet));
+    return parser->set_count++;
+}
+
+static void set_add(ByteSet* set, unsigned char c) {
+    set->bits[c >> 5] |= 1u << (c & 31);
+}
+
+static int set_has(const ByteSet* set, unsigned char c) {
+    return (set->bits[c >> 5] >> (c & 31)) & 1;
+}
+
+/**
+ * @brief Thêm các byte của lớp \d \w \s (hoặc phần bù \D \W \S, không gồm '\n') vào tập.
+ */
+static void set_add_class_escape(ByteSet* set, char escape) {
+    ByteSet members;
+    memset(&members, 0, sizeof(members));
+    char lower = (char)(escape | 0x20);
+    for (int c = 0; c < 256; c++) {
+        int in = 0;
+        if (lower == 'd') in = c >= '0' && c <= '9';
+        else if (lower == 'w') in = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        else if (lower == 's') in = c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+        if (escape != lower) in = !in && c != '\n'; // Chữ hoa: phần bù
+        if (in) set_add(&members, (unsigned char)c);
+    }
+    for (int i = 0; i < 8; i++) set->bits[i] |= members.bits[i];
+}
+
+static void set_fold_case(ByteSet* set) {
+    for (int c = 'a'; c <= 'z'; c++) {
+        if (set_has(set, (unsigned char)c) || set_has(set, (unsigned char)(c - 32))) {
+            set_add(set, (unsigned char)c);
+            set_add(set, (unsigned char)(c - 32));
+        }
+    }
+}
+
+// alternation := concat ('|' concat)*
+static int parse_alternation(RegexParser* parser, int depth) {
+    if (depth > 1000) {
+        set_error(parser, "Lồng nhóm quá sâu");
+        return -1;
+    }
+    int left = parse_concat(parser, depth);
+    while (!parser->failed && parser->p < parser->end && *parser->p == '|') {
+        parser->p++;
+        int right = parse_concat(parser, depth);
+        left = new_node(parser, NODE_ALT, -1, left, right);
+    }
+    return parser->failed ? -1 : left;
+}
+
+// concat := repeat*
+static int parse_concat(RegexParser* parser, int depth) {
+    int result = -1;
+    while (!parser->failed && parser->p < parser->end && *parser->p != '|' && *parser->p != ')') {
+        int item = parse_repeat(parser, depth);
+        result = result < 0 ? item : new_node(parser, NODE_CONCAT, -1, result, item);
+    }
+    if (result < 0) result = new_node(parser, NODE_EMPTY, -1, -1, -1);
+    return parser->failed ? -1 : result;
+}
+
+// repeat := atom ('*' | '+' | '?' | '{n}' | '{n,}' | '{n,m}')*
+static int parse_repeat(RegexParser* parser, int depth) {
+    int atom = parse_atom(parser, depth);
+    while (!parser->failed && parser->p < parser->end) {
+        int min, max;
+        const char* save = parser->p;
+        char c = *parser->p;
+        if (c == '*') { min = 0; max = -1; parser->p++; }
+        else if (c == '+') { min = 1; max = -1; parser->p++; }
+        else if (c == '?') { min = 0; max = 1; parser->p++; }
+        else if (c == '{') {
+            parser->p++;
+            if (!parse_number(parser, &min)) { parser->p = save; break; } // Không phải lượng từ: '{' là ký tự thường
+            max = min;
+            if (parser->p < parser->end && *parser->p == ',') {
+                parser->p++;
+                max = -1;
+                if (parser->p < parser->end && *parser->p != '}' && !parse_number(parser, &max)) { parser->p = save; break; }
+            }
+            if (parser->p >= parser->end || *parser->p != '}') { parser->p = save; break; }
+            parser->p++;
+            if (min > REGEX_MAX_REPEAT || max > REGEX_MAX_REPEAT) {
+                set_error(parser, "Số lần lặp quá lớn");
+                return -1;
+            }
+            if (max >= 0 && max < min) {
+                set_error(parser, "Khoảng lặp không hợp lệ");
+                return -1;
+            }
+        } else {
+            break;
+        }
+        if (parser->p < parser->end && *parser->p == '?') parser->p++; // Lượng từ "lười" cho cùng kết quả khi chỉ cần biết dòng có khớp không
+
+        int node = new_node(parser, NODE_REPEAT, -1, atom, -1);
+        if (node < 0) return -1;
+        parser->nodes[node].min = min;
+        parser->nodes[node].max = max;
+        atom = node;
+    }
+    return parser->failed ? -1 : atom;
+}
+
+static int parse_atom(RegexParser* parser, int depth) {
+    char c = *parser->p++;
+    switch (c) {
+        case '(': {
+            if (parser->end - parser->p >= 2 && parser->p[0] == '?' && parser->p[1] == ':') parser->p += 2;
+            int inner = parse_alternation(parser, depth + 1);
+            if (parser->failed) return -1;
+            if (parser->p >= parser->end || *parser->p != ')') {
+                set_error(parser, "Thiếu dấu ')'");
+                return -1;
+            }
+            parser->p++;
+            return inner;
+        }
+        case '[':
+            return parse_class(parser);
+        case '^':
+            return new_node(parser, NODE_BOL, -1, -1, -1);
+        case '$':
+            return new_node(parser, NODE_EOL, -1, -1, -1);
+        case '*': case '+': case '?':
+            parser->p--;
+            set_error(parser, "Lượng từ không có gì để lặp");
+            return -1;
+        default:
+            break;
+    }
+
+    int set = new_set(parser);
+    if (set < 0) return -1;
+    ByteSet* bytes = &parser->sets[set];
+    if (c == '.') {
+        for (int b = 0; b < 256; b++) if (b != '\n') set_add(bytes, (unsigned char)b);
+    } else if (c == '\\') {
+        if (parser->p >= parser->end) {
+            set_error(parser, "Dấu '\\' ở cuối biểu thức");
+            return -1;
+        }
+        char escape = *parser->p++;
+        unsigned char byte;
+        if (strchr("dDwWsS", escape) != NULL) set_add_class_escape(bytes, escape);
+        else if (parse_escape_byte(parser, escape, &byte) == 0) set_add(bytes, byte);
+        else return -1;
+    } else {
+        set_add(bytes, (unsigned char)c);
+    }
+    if (!parser->case_sensitive) set_fold_case(bytes);
+    return new_node(parser, NODE_SET, set, -1, -1);
+}
+
+/**
+ * @brief Byte của một escape đơn: \n, \t, \r hoặc một ký tự đặc biệt được thoát (ví dụ \. \[ \\).
+ * Các escape khác (\b, \x61, \1...) báo lỗi thay vì bị hiểu thầm lặng thành ký tự thường.
+ * @return 0 nếu hợp lệ, -1 (đã đặt lỗi) nếu escape không được hỗ trợ.
+ */
+static int parse_escape_byte(RegexParser* parser, char escape, unsigned char* byte) {
+    if (escape == 'n') *byte = '\n';
+    else if (escape == 't') *byte = '\t';
+    else if (escape == 'r') *byte = '\r';
+    else if (escape != '\0' && strchr("\\.^$|?*+()[]{}-/", escape) != NULL) *byte = (unsigned char)escape;
+    else {
+        set_error(parser, "Escape không được hỗ trợ (chỉ dùng \\d \\D \\w \\W \\s \\S \\n \\t \\r hoặc thoát ký tự đặc biệt)");
+        return -1;
+    }
+    return 0;
+}
+
+// class := '[' '^'? ']'? (item | item '-' item)* ']'
+static int parse_class(RegexParser* parser) {
+    int set = new_set(parser);
+    if (set < 0) return -1;
+    ByteSet bytes;
+    memset(&bytes, 0, sizeof(bytes));
+
+    int negate = 0;
+    if (parser->p < parser->end && *parser->p == '^') {
+        negate = 1;
+        parser->p++;
+    }
+    int first = 1;
+    while (parser->p < parser->end && (*parser->p != ']' || first)) {
+        first = 0;
+        unsigned char low = (unsigned char)*parser->p++;
+        if (low == '\\' && parser->p < parser->end) {
+            char escape = *parser->p++;
+            if (strchr("dDwWsS", escape) != NULL) {
+                set_add_class_escape(&bytes, escape);
+                continue;
+            }
+            if (parse_escape_byte(parser, escape, &low) != 0) return -1;
+        }
+        unsigned char high = low;
+        if (parser->end - parser->p >= 2 && *parser->p == '-' && parser->p[1] != ']') {
+            parser->p++;
+            high = (unsigned char)*parser->p++;
+            if (high == '\\' && parser->p < parser->end && parse_escape_byte(parser, *parser->p++, &high) != 0) return -1;
+            if (high < low) {
+                set_error(parser, "Khoảng ký tự không hợp lệ");
+                return -1;
+            }
+        }
+        for (int b = low; b <= high; b++) set_add(&bytes, (unsigned char)b);
+    }
+    if (parser->p >= parser->end) {
+        set_error(parser, "Thiếu dấu ']'");
+        return -1;
+    }
+    parser->p++;
+
+    if (!parser->case_sensitive) set_fold_case(&bytes);
+    if (negate) {
+        for (int i = 0; i < 8; i++) bytes.bits[i] = ~bytes.bits[i];
+        bytes.bits['\n' >> 5] &= ~(1u << ('\n' & 31)); // Tìm theo dòng: không bao giờ khớp '\n'
+    }
+    parser->sets[set] = bytes;
+    return new_node(parser, NODE_SET, set, -1, -1);
+}
+
+static int parse_number(RegexParser* parser, int* value) {
+    if (parser->p >= parser->end || *parser->p < '0' || *parser->p > '9') return 0;
+    long number = 0;
+    while (parser->p < parser->end && *parser->p >= '0' && *parser->p <= '9') {
+        if (number <= REGEX_MAX_REPEAT) number = number * 10 + (*parser->p - '0');
+        parser->p++;
+    }
+    *value = (int)(number > REGEX_MAX_REPEAT ? REGEX_MAX_REPEAT + 1 : number);
+    return 1;
+}
+
+static int new_nfa_state(Regex* re, int type, int set, int out, int out1, size_t* capacity) {
+    if (re->nfa_count >= REGEX_MAX_NFA_STATES) return -1;
+    if ((size_t)re->nfa_count == *capacity) {
+        size_t grown_capacity = *capacity == 0 ? 64 : *capacity * 2;
+        NfaState* grown = (NfaState*)realloc(re->nfa, grown_capacity * sizeof(NfaState));
+        if (grown == NULL) return -1;
+        re->nfa = grown;
+        *capacity = grown_capacity;
+    }
+    NfaState* state = &re->nfa[re->nfa_count];
+    state->type = type;
+    state->set = set;
+    state->out = out;
+    state->out1 = out1;
+    return re->nfa_count++;
+}
+
+/**
+ * @brief Sinh trạng thái NFA cho một nút, nối vào trạng thái next.
+ * @return Trạng thái bắt đầu của đoạn vừa sinh, hoặc -1 nếu vượt giới hạn.
+ */
+static int emit_nfa(Regex* re, const RegexNode* nodes, int node, int next, size_t* capacity) {
+    if (next < 0) return -1;
+    const RegexNode* n = &nodes[node];
+    switch (n->type) {
+        case NODE_EMPTY:
+            return next;
+        case NODE_SET:
+            return new_nfa_state(re, NFA_SET, n->set, next, -1, capacity);
+        case NODE_BOL:
+            return new_nfa_state(re, NFA_BOL, -1, next, -1, capacity);
+        case NODE_EOL:
+            return new_nfa_state(re, NFA_EOL, -1, next, -1, capacity);
+        case NODE_CONCAT:
+            return emit_nfa(re, nodes, n->left, emit_nfa(re, nodes, n->right, next, capacity), capacity);
+        case NODE_ALT: {
+            int left = emit_nfa(re, nodes, n->left, next, capacity);
+            int right = emit_nfa(re, nodes, n->right, next, capacity);
+            if (left < 0 || right < 0) return -1;
+            return new_nfa_state(re, NFA_SPLIT, -1, left, right, capacity);
+        }
+        case NODE_REPEAT: {
+            int current = next;
+            if (n->max < 0) {
+                // Vòng lặp: loop -> (thân -> loop) | next
+                int loop = new_nfa_state(re, NFA_SPLIT, -1, -1, next, capacity);
+                if (loop < 0) return -1;
+                int body = emit_nfa(re, nodes, n->left, loop, capacity);
+                if (body < 0) return -1;
+                re->nfa[loop].out = body;
+                current = loop;
+            } else {
+                // (max - min) bản tùy chọn lồng nhau: (x(x)?)?
+                for (int i = 0; i < n->max - n->min; i++) {
+                    int body = emit_nfa(re, nodes, n->left, current, capacity);
+                    if (body < 0) return -1;
+                    current = new_nfa_state(re, NFA_SPLIT, -1, body, next, capacity);
+                    if (current < 0) return -1;
+                }
+            }
+            for (int i = 0; i < n->min; i++) {
+                current = emit_nfa(re, nodes, n->left, current, capacity);
+                if (current < 0) return -1;
+            }
+            return current;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Chia 256 byte thành các lớp tương đương: hai byte cùng lớp khi chúng thuộc
+ * cùng những tập byte của biểu thức, nên bảng chuyển DFA chỉ cần một cột cho mỗi lớp.
+ */
+static void build_byte_classes(Regex* re) {
+    int class_of[256] = {0};
+    int count = 1;
+    for (int s = 0; s < re->set_count; s++) {
+        int remap[512];
+        for (int i = 0; i < 2 * count; i++) remap[i] = -1;
+        int new_count = 0;
+        for (int b = 0; b < 256; b++) {
+            int key = class_of[b] * 2 + set_has(&re->sets[s], (unsigned char)b);
+            if (remap[key] < 0) remap[key] = new_count++;
+            class_of[b] = remap[key];
+        }
+        count = new_count;
+    }
+    re->num_classes = count;
+    for (int b = 255; b >= 0; b--) {
+        re->byte_class[b] = (unsigned char)class_of[b];
+        re->class_representative[class_of[b]] = (unsigned char)b;
+    }
+}
+
+/**
+ * @brief Lấy chuỗi cố định mà mọi chuỗi khớp đều phải bắt đầu bằng nó.
+ * @param complete Được đặt về 0 khi gặp nút không phải ký tự cố định (dừng nối thêm).
+ */
+static void extract_prefix(const RegexNode* nodes, int node, unsigned char* prefix, size_t* length, size_t max_length,
+                           int* complete, int case_sensitive, const ByteSet* sets) {
+    if (!*complete) return;
+    const RegexNode* n = &nodes[node];
+    if (n->type == NODE_CONCAT) {
+        extract_prefix(nodes, n->left, prefix, length, max_length, complete, case_sensitive, sets);
+        extract_prefix(nodes, n->right, prefix, length, max_length, complete, case_sensitive, sets);
+        return;
+    }
+    if ((n->type == NODE_BOL || n->type == NODE_EMPTY) && *length == 0) return;
+    if (n->type != NODE_SET || *length >= max_length) {
+        *complete = 0;
+        return;
+    }
+
+    // Tập chỉ gồm một byte (hoặc một cặp hoa/thường khi không phân biệt)
+    int members = 0, first = -1;
+    for (int b = 0; b < 256; b++) {
+        if (set_has(&sets[n->set], (unsigned char)b)) {
+            if (first < 0) first = b;
+            members++;
+        }
+    }
+    int is_literal = members == 1 ||
+                     (!case_sensitive && members == 2 && first >= 'A' && first <= 'Z' && set_has(&sets[n->set], (unsigned char)(first + 32)));
+    if (!is_literal) {
+        *complete = 0;
+        return;
+    }
+    prefix[(*length)++] = (unsigned char)first;
+}
+
+static int dfa_init(Regex* re) {
+    re->hash_capacity = 1;
+    while (re->hash_capacity < 2 * REGEX_DFA_MAX_STATES) re->hash_capacity <<= 1;
+    re->arena_capacity = (size_t)re->nfa_count * 2 > REGEX_DFA_ARENA_INTS ? (size_t)re->nfa_count * 2 : REGEX_DFA_ARENA_INTS;
+
+    re->states = (DfaState*)malloc(REGEX_DFA_MAX_STATES * sizeof(DfaState));
+    re->transitions = (int32_t*)malloc((size_t)REGEX_DFA_MAX_STATES * re->num_classes * sizeof(int32_t));
+    re->set_arena = (int*)malloc(re->arena_capacity * sizeof(int));
+    re->hash_slots = (int32_t*)malloc(re->hash_capacity * sizeof(int32_t));
+    re->work_list = (int*)malloc(re->nfa_count * sizeof(int));
+    re->work_stack = (int*)malloc(((size_t)re->nfa_count * 2 + 1) * sizeof(int)); // Mỗi trạng thái đẩy tối đa 2 phần tử
+    re->marks = (unsigned int*)calloc(re->nfa_count, sizeof(unsigned int));
+    if (re->states == NULL || re->transitions == NULL || re->set_arena == NULL || re->hash_slots == NULL ||
+        re->work_list == NULL || re->work_stack == NULL || re->marks == NULL) {
+        return -1;
+    }
+    dfa_flush(re);
+    return 0;
+}
+
+/**
+ * @brief Xóa toàn bộ bộ nhớ đệm DFA (khi đầy); các trạng thái sẽ được dựng lại khi cần.
+ */
+static void dfa_flush(Regex* re) {
+    re->state_count = 0;
+    re->arena_used = 0;
+    re->initial_state = -1;
+    re->flush_count++;
+    for (size_t i = 0; i < re->hash_capacity; i++) re->hash_slots[i] = -1;
+}
+
+/**
+ * @brief Thêm bao đóng epsilon của một trạng thái NFA vào work_list[0..*count).
+ * Chỉ giữ các trạng thái có ý nghĩa khi đọc byte tiếp theo (NFA_SET), NFA_EOL và NFA_MATCH.
+ * Dùng marks/generation để mỗi trạng thái chỉ được thăm một lần.
+ */
+static void add_closure(Regex* re, int state, int allow_bol, int* count) {
+    int top = 0;
+    re->work_stack[top++] = state;
+    while (top > 0) {
+        int s = re->work_stack[--top];
+        if (re->marks[s] == re->generation) continue;
+        re->marks[s] = re->generation;
+        const NfaState* n = &re->nfa[s];
+        switch (n->type) {
+            case NFA_SPLIT:
+                re->work_stack[top++] = n->out1;
+                re->work_stack[top++] = n->out;
+                break;
+            case NFA_BOL:
+                if (allow_bol) re->work_stack[top++] = n->out;
+                break;
+            default:
+                re->work_list[(*count)++] = s;
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Kiểm tra từ một trạng thái, coi như đang ở cuối dòng ('$' thỏa mãn), có tới được NFA_MATCH không.
+ */
+static int closure_reaches_match(Regex* re, int state, int allow_bol) {
+    int top = 0;
+    re->work_stack[top++] = state;
+    while (top > 0) {
+        int s = re->work_stack[--top];
+        if (re->marks[s] == re->generation) continue;
+        re->marks[s] = re->generation;
+        const NfaState* n = &re->nfa[s];
+        if (n->type == NFA_MATCH) return 1;
+        if (n->type == NFA_SPLIT) {
+            re->work_stack[top++] = n->out1;
+            re->work_stack[top++] = n->out;
+        } else if (n->type == NFA_EOL || (n->type == NFA_BOL && allow_bol)) {
+            re->work_stack[top++] = n->out;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Tìm trạng thái DFA ứng với tập work_list[0..count) (sẽ được sắp xếp), tạo mới nếu chưa có.
+ * Khi bộ nhớ đệm đầy thì xóa sạch trước khi thêm.
+ */
+static int find_or_add_state(Regex* re, int count, int line_start) {
+    qsort(re->work_list, count, sizeof(int), compare_ints);
+
+    uint32_t hash = 2166136261u ^ (uint32_t)line_start;
+    for (int i = 0; i < count; i++) hash = (hash ^ (uint32_t)re->work_list[i]) * 16777619u;
+
+    size_t mask = re->hash_capacity - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        int32_t id = re->hash_slots[slot];
+        if (id < 0) break;
+        const DfaState* existing = &re->states[id];
+        if (existing->set_count == count && existing->line_start == line_start &&
+            memcmp(re->set_arena + existing->set_offset, re->work_list, count * sizeof(int)) == 0) {
+            return id;
+        }
+    }
+
+    if (re->state_count == REGEX_DFA_MAX_STATES || re->arena_used + (size_t)count > re->arena_capacity) {
+        dfa_flush(re);
+    }
+
+    int id = re->state_count++;
+    DfaState* state = &re->states[id];
+    state->set_offset = re->arena_used;
+    state->set_count = count;
+    state->line_start = (unsigned char)line_start;
+    memcpy(re->set_arena + re->arena_used, re->work_list, count * sizeof(int));
+    re->arena_used += count;
+    for (int c = 0; c < re->num_classes; c++) re->transitions[(size_t)id * re->num_classes + c] = -1;
+
+    state->accepting = 0;
+    state->accepting_at_eol = 0;
+    re->generation++;
+    for (int i = 0; i < count; i++) {
+        const NfaState* n = &re->nfa[re->set_arena[state->set_offset + i]];
+        if (n->type == NFA_MATCH) state->accepting = 1;
+        if (n->type == NFA_EOL && closure_reaches_match(re, n->out, line_start)) state->accepting_at_eol = 1;
+    }
+
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        if (re->hash_slots[slot] < 0) {
+            re->hash_slots[slot] = id;
+            break;
+        }
+    }
+    return id;
+}
+
+static int get_initial_state(Regex* re) {
+    if (re->initial_state < 0) {
+        int count = 0;
+        re->generation++;
+        add_closure(re, re->start, 1, &count);
+        re->initial_state = find_or_add_state(re, count, 1);
+    }
+    return re->initial_state;
+}
+
+/**
+ * @brief Tính (và lưu vào bảng chuyển) trạng thái kế tiếp khi đọc một byte thuộc lớp byte_class.
+ * Trạng thái bắt đầu luôn được thêm lại để tìm chuỗi khớp bắt đầu ở mọi vị trí.
+ */
+static int compute_next_state(Regex* re, int state, int byte_class) {
+    unsigned char byte = re->class_representative[byte_class];
+    int count = 0;
+    re->generation++;
+    const DfaState* current = &re->states[state];
+    for (int i = 0; i < current->set_count; i++) {
+        const NfaState* n = &re->nfa[re->set_arena[current->set_offset + i]];
+        if (n->type == NFA_SET && set_has(&re->sets[n->set], byte)) add_closure(re, n->out, 0, &count);
+    }
+    add_closure(re, re->start, 0, &count);
+
+    unsigned long flushes_before = re->flush_count;
+    int next = find_or_add_state(re, count, 0);
+    // Nếu bộ nhớ đệm vừa bị xóa thì trạng thái hiện tại không còn, không lưu cạnh chuyển
+    if (re->flush_count == flushes_before) {
+        re->transitions[(size_t)state * re->num_classes + byte_class] = next;
+    }
+    return next;
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
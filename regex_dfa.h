@@ -0,0 +1,48 @@
+#ifndef REGEX_DFA_H
+#define REGEX_DFA_H
+
+#include <stddef.h>
+
+// Giới hạn bộ nhớ đệm DFA: khi đầy, toàn bộ trạng thái bị xóa và dựng lại dần
+#define REGEX_DFA_MAX_STATES 4096
+// Giới hạn kích thước để thời gian biên dịch và quét luôn bị chặn
+#define REGEX_MAX_REPEAT     1000
+#define REGEX_MAX_NFA_STATES 100000
+
+/**
+ * @brief Biểu thức chính quy đã biên dịch.
+ * Cú pháp hỗ trợ: ký tự thường, '.', lớp ký tự [a-z] và [^...], \d \w \s \D \W \S,
+ * nhóm ( ) và (?: ), lựa chọn |, lượng từ * + ? {n} {n,} {n,m}, neo ^ và $ (theo dòng),
+ * escape \n \t \r và thoát ký tự đặc biệt (\. \[ ...); các escape khác (\b, \x61, \1) là lỗi biên dịch.
+ * Việc so khớp chạy trên một DFA được dựng dần khi quét (mỗi trạng thái DFA là một tập trạng thái NFA),
+ * nên thời gian luôn tuyến tính theo độ dài dữ liệu, kể cả với mẫu "xấu" như (a*)*b.
+ * Đối tượng chứa bộ nhớ đệm DFA nên không dùng chung giữa các luồng.
+ */
+typedef struct Regex Regex;
+
+/**
+ * @brief Biên dịch biểu thức chính quy.
+ * @param case_sensitive 0 để không phân biệt chữ hoa/thường (ASCII).
+ * @param error Bộ đệm nhận thông báo lỗi (có thể NULL).
+ * @return Con trỏ đến biểu thức đã biên dịch, hoặc NULL nếu cú pháp sai hoặc biểu thức quá lớn.
+ */
+Regex* regex_compile(const char* pattern, int case_sensitive, char* error, size_t error_size);
+
+void regex_free(Regex* re);
+
+/**
+ * @brief Kiểm tra một dòng (không gồm '\n') có chứa chuỗi khớp không.
+ * @return 1 nếu có, 0 nếu không.
+ */
+int regex_match_line(Regex* re, const char* line_start, const char* line_end);
+
+/**
+ * @brief Tìm dòng khớp tiếp theo trong [begin, end), với begin là đầu một dòng.
+ * Nếu biểu thức bắt đầu bằng một chuỗi cố định, chuỗi đó được tìm trước bằng bộ tìm chuỗi con
+ * để bỏ qua nhanh các dòng không thể khớp.
+ * @param line_start, line_end Nhận biên của dòng khớp (line_end trỏ vào '\n' hoặc end).
+ * @return 1 nếu tìm thấy, 0 nếu không.
+ */
+int regex_find_line(Regex* re, const char* begin, const char* end, const char** line_start, const char** line_end);
+
+#endif // REGEX_DFA_H
@@ -0,0 +1,253 @@
+#include "report.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Bảng 2 chữ số "00".."99" để chuyển số nguyên sang chuỗi nhanh hơn printf
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static void write_json_string(ReportWriter* writer, const char* str);
+static void write_csv_field(ReportWriter* writer, const char* str);
+static void write_report_json(ReportWriter* writer, const ReportSummary* summary, const WordStats* words, int word_count);
+static void write_report_csv(ReportWriter* writer, const WordStats* words, int word_count);
+static void write_report_bin(ReportWriter* writer, const ReportSummary* summary, const WordStats* words, int word_count);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+ReportFormat get_report_format_from_string(const char* str) {
+    if (str == NULL) return REPORT_UNKNOWN;
+    if (strcmp(str, "text") == 0) return REPORT_TEXT;
+    if (strcmp(str, "json") == 0) return REPORT_JSON;
+    if (strcmp(str, "csv") == 0) return REPORT_CSV;
+    if (strcmp(str, "bin") == 0) return REPORT_BIN;
+    return REPORT_UNKNOWN;
+}
+
+int report_writer_init(ReportWriter* writer, FILE* stream, size_t capacity) {
+    writer->stream = stream;
+    writer->capacity = capacity;
+    writer->used = 0;
+    writer->error = 0;
+    writer->buffer = (char*)malloc(capacity);
+    if (writer->buffer == NULL) {
+        writer->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+int report_writer_flush(ReportWriter* writer) {
+    if (writer->used > 0 && !writer->error) {
+        if (fwrite(writer->buffer, 1, writer->used, writer->stream) != writer->used) {
+            writer->error = 1;
+        }
+    }
+    writer->used = 0;
+    if (!writer->error && fflush(writer->stream) != 0) {
+        writer->error = 1;
+    }
+    return writer->error ? -1 : 0;
+}
+
+int report_writer_close(ReportWriter* writer) {
+    int result = report_writer_flush(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    writer->capacity = 0;
+    return result;
+}
+
+void report_write_bytes(ReportWriter* writer, const void* data, size_t length) {
+    if (writer->error) return;
+
+    // Không đủ chỗ: đẩy bộ đệm ra trước
+    if (writer->used + length > writer->capacity) {
+        if (writer->used > 0 && fwrite(writer->buffer, 1, writer->used, writer->stream) != writer->used) {
+            writer->error = 1;
+            return;
+        }
+        writer->used = 0;
+        // Khối lớn hơn cả bộ đệm thì ghi thẳng, không cần sao chép
+        if (length > writer->capacity) {
+            if (fwrite(data, 1, length, writer->stream) != length) writer->error = 1;
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->used, data, length);
+    writer->used += length;
+}
+
+void report_write_str(ReportWriter* writer, const char* str) {
+    report_write_bytes(writer, str, strlen(str));
+}
+
+void report_write_uint(ReportWriter* writer, uint64_t value) {
+    char digits[20]; // UINT64_MAX có 20 chữ số
+    char* p = digits + sizeof(digits);
+
+    // Mỗi vòng lặp xử lý 2 chữ số nhờ bảng digit_pairs
+    while (value >= 100) {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned int pair = (unsigned int)value * 2;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    report_write_bytes(writer, p, (size_t)(digits + sizeof(digits) - p));
+}
+
+void report_write_u32le(ReportWriter* writer, uint32_t value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    report_write_bytes(writer, bytes, 4);
+}
+
+void report_write_u64le(ReportWriter* writer, uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+    report_write_bytes(writer, bytes, 8);
+}
+
+int write_analysis_report(FILE* stream, ReportFormat format, const ReportSummary* summary,
+                          const WordStats* words, int word_count) {
+    ReportWriter writer;
+    if (report_writer_init(&writer, stream, REPORT_BUFFER_SIZE) != 0) {
+        fprintf(stderr, "Lỗi: Không thể cấp phát bộ đệm ghi báo cáo.\n");
+        return -1;
+    }
+
+    switch (format) {
+        case REPORT_JSON:
+            write_report_json(&writer, summary, words, word_count);
+            break;
+        case REPORT_CSV:
+            write_report_csv(&writer, words, word_count);
+            break;
+        case REPORT_BIN:
+            write_report_bin(&writer, summary, words, word_count);
+            break;
+        default:
+            fprintf(stderr, "Lỗi: Định dạng báo cáo không được hỗ trợ.\n");
+            report_writer_close(&writer);
+            return -1;
+    }
+
+    return report_writer_close(&writer);
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+/**
+ * @brief Ghi chuỗi JSON có dấu ngoặc kép, thoát các ký tự đặc biệt.
+ * Các byte UTF-8 (>= 0x80) được giữ nguyên.
+ */
+static void write_json_string(ReportWriter* writer, const char* str) {
+    static const char hex[] = "0123456789abcdef";
+    const char* run_start = str;
+
+    report_write_bytes(writer, "\"", 1);
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // Ghi đoạn không cần thoát trước đó, rồi ghi ký tự đã thoát
+        report_write_bytes(writer, run_start, (size_t)(str - run_start));
+        run_start = str + 1;
+        if (c == '"') report_write_bytes(writer, "\\\"", 2);
+        else if (c == '\\') report_write_bytes(writer, "\\\\", 2);
+        else if (c == '\n') report_write_bytes(writer, "\\n", 2);
+        else if (c == '\r') report_write_bytes(writer, "\\r", 2);
+        else if (c == '\t') report_write_bytes(writer, "\\t", 2);
+        else {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            report_write_bytes(writer, escaped, 6);
+        }
+    }
+    report_write_bytes(writer, run_start, (size_t)(str - run_start));
+    report_write_bytes(writer, "\"", 1);
+}
+
+/**
+ * @brief Ghi một trường CSV theo RFC 4180: chỉ bọc ngoặc kép khi cần.
+ */
+static void write_csv_field(ReportWriter* writer, const char* str) {
+    if (strpbrk(str, ",\"\r\n") == NULL) {
+        report_write_str(writer, str);
+        return;
+    }
+
+    report_write_bytes(writer, "\"", 1);
+    const char* quote;
+    while ((quote = strchr(str, '"')) != NULL) {
+        report_write_bytes(writer, str, (size_t)(quote - str + 1));
+        report_write_bytes(writer, "\"", 1); // Nhân đôi dấu ngoặc kép
+        str = quote + 1;
+    }
+    report_write_str(writer, str);
+    report_write_bytes(writer, "\"", 1);
+}
+
+static void write_report_json(ReportWriter* writer, const ReportSummary* summary, const WordStats* words, int word_count) {
+    report_write_str(writer, "{\"char_count\":");
+    report_write_uint(writer, (uint64_t)summary->char_count);
+    report_write_str(writer, ",\"total_word_count\":");
+    report_write_uint(writer, (uint64_t)summary->total_word_count);
+    report_write_str(writer, ",\"unique_word_count\":");
+    report_write_uint(writer, (uint64_t)summary->unique_word_count);
+    report_write_str(writer, ",\"line_count\":");
+    report_write_uint(writer, (uint64_t)summary->line_count);
+    report_write_str(writer, ",\"words\":[");
+    for (int i = 0; i < word_count; i++) {
+        report_write_str(writer, i == 0 ? "\n{\"word\":" : ",\n{\"word\":");
+        write_json_string(writer, words[i].word);
+        report_write_str(writer, ",\"count\":");
+        report_write_uint(writer, (uint64_t)words[i].count);
+        report_write_bytes(writer, "}", 1);
+    }
+    report_write_str(writer, "\n]}\n");
+}
+
+static void write_report_csv(ReportWriter* writer, const WordStats* words, int word_count) {
+    report_write_str(writer, "word,count\n");
+    for (int i = 0; i < word_count; i++) {
+        write_csv_field(writer, words[i].word);
+        report_write_bytes(writer, ",", 1);
+        report_write_uint(writer, (uint64_t)words[i].count);
+        report_write_bytes(writer, "\n", 1);
+    }
+}
+
+/**
+ * Bố cục (little-endian):
+ *   "TAR1" | u64 char_count | u64 total_word_count | u32 line_count | u32 word_count
+ *   sau đó word_count bản ghi: u32 count | u32 length | length byte của từ (không có '\0')
+ */
+static void write_report_bin(ReportWriter* writer, const ReportSummary* summary, const WordStats* words, int word_count) {
+    report_write_bytes(writer, REPORT_BIN_MAGIC, 4);
+    report_write_u64le(writer, (uint64_t)summary->char_count);
+    report_write_u64le(writer, (uint64_t)summary->total_word_count);
+    report_write_u32le(writer, (uint32_t)summary->line_count);
+    report_write_u32le(writer, (uint32_t)word_count);
+    for (int i = 0; i < word_count; i++) {
+        size_t length = strlen(words[i].word);
+        report_write_u32le(writer, (uint32_t)words[i].count);
+        report_write_u32le(writer, (uint32_t)length);
+        report_write_bytes(writer, words[i].word, length);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hashtable.h"
+
+#define REPORT_BUFFER_SIZE (1 << 20) // Bộ đệm ghi 1 MiB
+#define REPORT_BIN_MAGIC "TAR1"      // "Số ma thuật" cho báo cáo dạng nhị phân
+
+/**
+ * @brief Enum để định danh định dạng xuất báo cáo phân tích.
+ */
+typedef enum {
+    REPORT_TEXT,  // Văn bản mô tả (mặc định, như cũ)
+    REPORT_JSON,  // JSON
+    REPORT_CSV,   // CSV: word,count
+    REPORT_BIN,   // Nhị phân little-endian
+    REPORT_UNKNOWN
+} ReportFormat;
+
+/**
+ * @brief Các số liệu thống kê cơ bản đi kèm danh sách từ.
+ */
+typedef struct {
+    long char_count;
+    long total_word_count;
+    int unique_word_count;
+    int line_count;
+} ReportSummary;
+
+/**
+ * @brief Bộ ghi có bộ đệm lớn, chỉ gọi fwrite khi bộ đệm đầy hoặc khi flush.
+ */
+typedef struct {
+    FILE* stream;
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    int error; // Khác 0 nếu đã có lỗi ghi
+} ReportWriter;
+
+/**
+ * @brief Chuyển chuỗi ("json", "csv", "bin", "text") thành ReportFormat.
+ * @return Định dạng tương ứng hoặc REPORT_UNKNOWN.
+ */
+ReportFormat get_report_format_from_string(const char* str);
+
+int report_writer_init(ReportWriter* writer, FILE* stream, size_t capacity);
+void report_write_bytes(ReportWriter* writer, const void* data, size_t length);
+void report_write_str(ReportWriter* writer, const char* str);
+void report_write_uint(ReportWriter* writer, uint64_t value);
+void report_write_u32le(ReportWriter* writer, uint32_t value);
+void report_write_u64le(ReportWriter* writer, uint64_t value);
+int report_writer_flush(ReportWriter* writer);
+/**
+ * @brief Flush phần còn lại và giải phóng bộ đệm.
+ * @return 0 nếu mọi thao tác ghi đều thành công, -1 nếu có lỗi.
+ */
+int report_writer_close(ReportWriter* writer);
+
+/**
+ * @brief Ghi thống kê và toàn bộ danh sách từ ra luồng theo định dạng máy đọc được.
+ * @param stream Luồng đầu ra (nên mở ở chế độ nhị phân với REPORT_BIN).
+ * @param format REPORT_JSON, REPORT_CSV hoặc REPORT_BIN.
+ * @param summary Thống kê cơ bản.
+ * @param words Danh sách từ (đã sắp xếp theo ý người gọi).
+ * @param word_count Số phần tử của words.
+ * @return 0 nếu thành công, -1 nếu thất bại.
+ */
+int write_analysis_report(FILE* stream, ReportFormat format, const ReportSummary* summary,
+                          const WordStats* words, int word_count);
+
+#endif // REPORT_H
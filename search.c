@@ -0,0 +1,165 @@
+#include <stdlib.h>
+#include <string.h>
+#include "search.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define F4(c) (c), (c) + 1, (c) + 2, (c) + 3
+#define F16(c) F4(c), F4((c) + 4), F4((c) + 8), F4((c) + 12)
+
+const unsigned char search_fold_table[256] = {
+    F16(0x00), F16(0x10), F16(0x20), F16(0x30),
+    // 0x40..0x5F: '@', A-Z được chuyển thành a-z, rồi "[\]^_"
+    0x40, F16(0x61), F4(0x71), 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+    F16(0x60), F16(0x70),
+    F16(0x80), F16(0x90), F16(0xA0), F16(0xB0),
+    F16(0xC0), F16(0xD0), F16(0xE0), F16(0xF0)
+};
+
+// --- KHAI BÁO CÁC HÀM "PRIVATE" ---
+static int equals_folded(const unsigned char* text, const unsigned char* pattern, size_t length);
+static const char* search_filter(const SearchPattern* sp, const unsigned char* p, const unsigned char* end);
+static const char* search_horspool(const SearchPattern* sp, const unsigned char* p, const unsigned char* end);
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+int search_compile(SearchPattern* sp, const char* pattern, size_t length, int case_sensitive) {
+    memset(sp, 0, sizeof(SearchPattern));
+    if (length == 0) return -1;
+
+    sp->pattern = (unsigned char*)malloc(length);
+    if (sp->pattern == NULL) return -1;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)pattern[i];
+        sp->pattern[i] = case_sensitive ? c : search_fold_table[c];
+    }
+    sp->length = length;
+    sp->case_sensitive = case_sensitive;
+    sp->use_horspool = length >= SEARCH_HORSPOOL_MIN_LENGTH;
+
+    if (sp->use_horspool) {
+        for (int c = 0; c < 256; c++) sp->skip[c] = length;
+        for (size_t i = 0; i + 1 < length; i++) sp->skip[sp->pattern[i]] = length - 1 - i;
+    }
+    return 0;
+}
+
+void search_free(SearchPattern* sp) {
+    free(sp->pattern);
+    sp->pattern = NULL;
+    sp->length = 0;
+}
+
+const char* search_next(const SearchPattern* sp, const char* haystack, const char* end) {
+    if (haystack == NULL || (size_t)(end - haystack) < sp->length) return NULL;
+    if (sp->use_horspool) {
+        return search_horspool(sp, (const unsigned char*)haystack, (const unsigned char*)end);
+    }
+    return search_filter(sp, (const unsigned char*)haystack, (const unsigned char*)end);
+}
+
+size_t count_newlines(const char* begin, const char* end) {
+    size_t count = 0;
+    const unsigned char* p = (const unsigned char*)begin;
+    const unsigned char* stop = (const unsigned char*)end;
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (stop - p >= 16) {
+        // Mỗi byte của counters đếm số '\n' ở một làn; gộp lại sau tối đa 255 khối để không tràn
+        size_t blocks = (size_t)(stop - p) / 16;
+        if (blocks > 255) blocks = 255;
+        __m128i counters = _mm_setzero_si128();
+        for (size_t i = 0; i < blocks; i++, p += 16) {
+            __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline);
+            counters = _mm_sub_epi8(counters, eq); // eq là 0xFF (= -1) ở làn khớp
+        }
+        __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_extract_epi16(sums, 4);
+    }
+#endif
+    for (; p < stop; p++) count += *p == '\n';
+    return count;
+}
+
+// --- CÀI ĐẶT CÁC HÀM "PRIVATE" ---
+
+static int equals_folded(const unsigned char* text, const unsigned char* pattern, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (search_fold_table[text[i]] != pattern[i]) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Bộ lọc byte đầu/cuối: với mỗi vị trí i, chỉ xác minh toàn bộ mẫu khi
+ * text[i] khớp byte đầu và text[i + len - 1] khớp byte cuối. Bản SSE2 kiểm tra 16 vị trí mỗi lần.
+ */
+static const char* search_filter(const SearchPattern* sp, const unsigned char* p, const unsigned char* end) {
+    const unsigned char* pattern = sp->pattern;
+    size_t length = sp->length;
+    const unsigned char* last = end - length; // Vị trí bắt đầu cuối cùng có thể khớp
+    unsigned char first_lo = pattern[0];
+    unsigned char last_lo = pattern[length - 1];
+    // Với chữ cái và không phân biệt hoa/thường, so thêm với dạng chữ hoa
+    unsigned char first_up = (!sp->case_sensitive && first_lo >= 'a' && first_lo <= 'z') ? first_lo - 32 : first_lo;
+    unsigned char last_up = (!sp->case_sensitive && last_lo >= 'a' && last_lo <= 'z') ? last_lo - 32 : last_lo;
+
+#if defined(__SSE2__)
+    const __m128i v_first_lo = _mm_set1_epi8((char)first_lo);
+    const __m128i v_first_up = _mm_set1_epi8((char)first_up);
+    const __m128i v_last_lo = _mm_set1_epi8((char)last_lo);
+    const __m128i v_last_up = _mm_set1_epi8((char)last_up);
+
+    while (last - p >= 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)p);
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(p + length - 1));
+        __m128i eq_first = _mm_or_si128(_mm_cmpeq_epi8(block_first, v_first_lo), _mm_cmpeq_epi8(block_first, v_first_up));
+        __m128i eq_last = _mm_or_si128(_mm_cmpeq_epi8(block_last, v_last_lo), _mm_cmpeq_epi8(block_last, v_last_up));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+        while (mask != 0) {
+            int bit = __builtin_ctz(mask);
+            const unsigned char* candidate = p + bit;
+            if (sp->case_sensitive ? memcmp(candidate + 1, pattern + 1, length - 1) == 0
+                                   : equals_folded(candidate + 1, pattern + 1, length - 1)) {
+                return (const char*)candidate;
+            }
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+#endif
+
+    // Phần còn lại (hoặc toàn bộ nếu không có SSE2)
+    for (; p <= last; p++) {
+        if ((*p != first_lo && *p != first_up) || (p[length - 1] != last_lo && p[length - 1] != last_up)) continue;
+        if (sp->case_sensitive ? memcmp(p + 1, pattern + 1, length - 1) == 0
+                               : equals_folded(p + 1, pattern + 1, length - 1)) {
+            return (const char*)p;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Boyer-Moore-Horspool cho mẫu dài: nhảy theo byte cuối của cửa sổ hiện tại.
+ */
+static const char* search_horspool(const SearchPattern* sp, const unsigned char* p, const unsigned char* end) {
+    const unsigned char* pattern = sp->pattern;
+    size_t length = sp->length;
+    unsigned char last_char = pattern[length - 1];
+
+    while ((size_t)(end - p) >= length) {
+        unsigned char c = p[length - 1];
+        if (!sp->case_sensitive) c = search_fold_table[c];
+        if (c == last_char) {
+            if (sp->case_sensitive ? memcmp(p, pattern, length - 1) == 0
+                                   : equals_folded(p, pattern, length - 1)) {
+                return (const char*)p;
+            }
+        }
+        p += sp->skip[c];
+    }
+    return NULL;
+}
@@ -0,0 +1,45 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stddef.h>
+
+// Mẫu dài từ ngưỡng này trở lên dùng Boyer-Moore-Horspool thay cho bộ lọc byte đầu/cuối
+#define SEARCH_HORSPOOL_MIN_LENGTH 32
+
+/**
+ * @brief Bảng chuyển byte sang chữ thường (chỉ A-Z, giống tolower ở locale "C").
+ */
+extern const unsigned char search_fold_table[256];
+
+/**
+ * @brief Mẫu tìm kiếm chuỗi con đã được biên dịch.
+ */
+typedef struct {
+    unsigned char* pattern;   // Bản sao mẫu; đã chuyển chữ thường nếu không phân biệt hoa/thường
+    size_t length;
+    int case_sensitive;
+    int use_horspool;
+    size_t skip[256];         // Bảng nhảy Horspool (chỉ dùng khi use_horspool)
+} SearchPattern;
+
+/**
+ * @brief Biên dịch mẫu tìm kiếm.
+ * @return 0 nếu thành công, -1 nếu mẫu rỗng hoặc không cấp phát được bộ nhớ.
+ */
+int search_compile(SearchPattern* sp, const char* pattern, size_t length, int case_sensitive);
+
+void search_free(SearchPattern* sp);
+
+/**
+ * @brief Tìm lần xuất hiện đầu tiên của mẫu trong [haystack, end).
+ * So khớp không phân biệt hoa/thường được thực hiện ngay khi quét, không sao chép dữ liệu.
+ * @return Con trỏ đến vị trí khớp, hoặc NULL nếu không có.
+ */
+const char* search_next(const SearchPattern* sp, const char* haystack, const char* end);
+
+/**
+ * @brief Đếm số ký tự '\n' trong [begin, end) (SSE2: so sánh 16 byte mỗi lần).
+ */
+size_t count_newlines(const char* begin, const char* end);
+
+#endif // SEARCH_H
@@ -0,0 +1,316 @@
+#include <array>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+
+extern "C" {
+#include "stopwords.h"
+}
+
+// Hàm băm hoàn hảo tối thiểu kiểu "hash and displace" (CHD):
+//  - mỗi từ được băm MỘT lần thành 64 bit; 32 bit cao chọn bucket, 32 bit thấp làm khóa phụ.
+//  - mỗi bucket lưu một độ dời d sao cho slot = mix(low + d * GOLDEN) % m không đụng độ.
+//  - m = số từ, nên bảng slot không có ô trống (tối thiểu).
+// Tra cứu: 1 lần băm + 1 lần đọc bảng dời + 1 lần so sánh chuỗi.
+
+#define STOPWORD_NO_SLOT    0xFFFFFFFFu
+#define STOPWORD_MAX_BUCKET 32       // Kích thước bucket tối đa được chấp nhận
+#define STOPWORD_MAX_TRIES  (1 << 20) // Số độ dời thử tối đa cho mỗi bucket
+
+struct StopWordSet {
+    const char* const* words;  // Từ theo thứ tự slot
+    const uint8_t* lengths;    // Độ dài từ theo thứ tự slot
+    const uint32_t* displacements;
+    uint32_t num_words;        // m
+    uint32_t num_buckets;
+    uint64_t seed;
+    bool is_builtin;
+
+    // Chỉ dùng cho tập tải từ tệp
+    std::string arena;
+    std::vector<const char*> word_storage;
+    std::vector<uint8_t> length_storage;
+    std::vector<uint32_t> displacement_storage;
+};
+
+namespace {
+
+constexpr uint64_t word_hash(const char* word, size_t length, uint64_t seed) {
+    uint64_t h = 14695981039346656037ull ^ seed; // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)word[i];
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33; // Trộn cuối để bit cao cũng phân tán đều
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+constexpr uint32_t slot_of(uint64_t h, uint32_t displacement, uint32_t m) {
+    uint32_t x = (uint32_t)h + displacement * 0x9E3779B9u;
+    x ^= x >> 16; // fmix32 của MurmurHash3
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x % m;
+}
+
+constexpr uint32_t bucket_of(uint64_t h, uint32_t num_buckets) {
+    return (uint32_t)(h >> 32) % num_buckets;
+}
+
+constexpr uint32_t bucket_count_for(size_t n) {
+    return (uint32_t)(n / 3 + 1);
+}
+
+constexpr size_t literal_length(const char* str) {
+    size_t length = 0;
+    while (str[length] != '\0') length++;
+    return length;
+}
+
+/**
+ * @brief Dựng bảng dời và bảng slot. Dùng chung cho constexpr (std::array) và lúc chạy (std::vector).
+ * @param hashes Giá trị băm của từng từ.
+ * @param bucket_start Mảng tạm num_buckets + 1 phần tử.
+ * @param keys_by_bucket Mảng tạm n phần tử.
+ * @param slots Đầu ra: chỉ số từ tại mỗi slot (n phần tử).
+ * @return true nếu dựng thành công.
+ */
+template <class Hashes, class Index, class Displacements>
+constexpr bool build_displacements(const Hashes& hashes, uint32_t n, uint32_t num_buckets,
+                                   Index& bucket_start, Index& keys_by_bucket,
+                                   Displacements& displacements, Index& slots) {
+    // Sắp xếp đếm các từ theo bucket
+    for (uint32_t b = 0; b <= num_buckets; b++) bucket_start[b] = 0;
+    for (uint32_t i = 0; i < n; i++) bucket_start[bucket_of(hashes[i], num_buckets) + 1]++;
+    uint32_t max_size = 0;
+    for (uint32_t b = 0; b < num_buckets; b++) {
+        if (bucket_start[b + 1] > max_size) max_size = bucket_start[b + 1];
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    if (max_size > STOPWORD_MAX_BUCKET) return false;
+    for (uint32_t b = 0; b < num_buckets; b++) displacements[b] = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t b = bucket_of(hashes[i], num_buckets);
+        keys_by_bucket[bucket_start[b] + displacements[b]++] = i;
+    }
+    for (uint32_t s = 0; s < n; s++) slots[s] = STOPWORD_NO_SLOT;
+
+    // Xếp các bucket lớn trước, khi bảng còn nhiều chỗ trống
+    for (uint32_t size = max_size; size > 0; size--) {
+        for (uint32_t b = 0; b < num_buckets; b++) {
+            if (bucket_start[b + 1] - bucket_start[b] != size) continue;
+
+            bool placed = false;
+            for (uint32_t d = 0; d < STOPWORD_MAX_TRIES && !placed; d++) {
+                uint32_t chosen[STOPWORD_MAX_BUCKET] = {};
+                placed = true;
+                for (uint32_t k = 0; k < size && placed; k++) {
+                    uint32_t s = slot_of(hashes[keys_by_bucket[bucket_start[b] + k]], d, n);
+                    if (slots[s] != STOPWORD_NO_SLOT) placed = false;
+                    for (uint32_t j = 0; j < k && placed; j++) {
+                        if (chosen[j] == s) placed = false;
+                    }
+                    chosen[k] = s;
+                }
+                if (placed) {
+                    for (uint32_t k = 0; k < size; k++) slots[chosen[k]] = keys_by_bucket[bucket_start[b] + k];
+                    displacements[b] = d;
+                }
+            }
+            if (!placed) return false;
+        }
+    }
+    return true;
+}
+
+// --- Tập dựng sẵn, được dựng hoàn toàn lúc biên dịch ---
+
+template <size_t N>
+struct StaticStopWords {
+    std::array<const char*, N> words = {};
+    std::array<uint8_t, N> lengths = {};
+    std::array<uint32_t, N / 3 + 1> displacements = {};
+    uint64_t seed = 0;
+    bool ok = false;
+};
+
+template <size_t N>
+constexpr StaticStopWords<N> build_static_set(const std::array<const char*, N>& source) {
+    StaticStopWords<N> set;
+    const uint32_t num_buckets = bucket_count_for(N);
+    for (uint64_t seed = 0; seed < 16 && !set.ok; seed++) {
+        std::array<uint64_t, N> hashes = {};
+        for (size_t i = 0; i < N; i++) hashes[i] = word_hash(source[i], literal_length(source[i]), seed);
+
+        std::array<uint32_t, N + 1> bucket_start = {};
+        std::array<uint32_t, N + 1> keys_by_bucket = {};
+        std::array<uint32_t, N + 1> slots = {};
+        if (!build_displacements(hashes, (uint32_t)N, num_buckets, bucket_start, keys_by_bucket, set.displacements, slots)) {
+            continue;
+        }
+        for (size_t s = 0; s < N; s++) {
+            set.words[s] = source[slots[s]];
+            set.lengths[s] = (uint8_t)literal_length(source[slots[s]]);
+        }
+        set.seed = seed;
+        set.ok = true;
+    }
+    return set;
+}
+
+constexpr std::array<const char*, 104> english_words = {
+    "a", "about", "above", "after", "again", "against", "all", "am", "an", "and",
+    "any", "are", "as", "at", "be", "because", "been", "before", "being", "below",
+    "between", "both", "but", "by", "can", "could", "did", "do", "does", "doing",
+    "down", "during", "each", "few", "for", "from", "further", "had", "has", "have",
+    "having", "he", "her", "here", "hers", "him", "his", "how", "i", "if",
+    "in", "into", "is", "it", "its", "just", "me", "more", "most", "my",
+    "no", "nor", "not", "now", "of", "off", "on", "once", "only", "or",
+    "other", "our", "out", "over", "own", "same", "she", "should", "so", "some",
+    "such", "than", "that", "the", "their", "them", "then", "there", "these", "they",
+    "this", "those", "through", "to", "too", "under", "until", "up", "very", "was",
+    "we", "were", "what", "with"
+};
+
+constexpr std::array<const char*, 80> vietnamese_words = {
+    "và", "của", "là", "có", "được", "cho", "không", "những", "các", "với",
+    "này", "trong", "một", "người", "đã", "để", "khi", "thì", "cũng", "như",
+    "từ", "đến", "lại", "ra", "vào", "nhưng", "mà", "nên", "rằng", "theo",
+    "tại", "về", "bị", "do", "sẽ", "đang", "vẫn", "rất", "nhiều", "hay",
+    "hoặc", "nếu", "vì", "bởi", "sau", "trước", "trên", "dưới", "giữa", "nào",
+    "ấy", "đó", "kia", "đây", "ở", "còn", "chỉ", "chưa", "đều", "cả",
+    "thế", "vậy", "gì", "ai", "sao", "làm", "lên", "xuống", "qua", "mỗi",
+    "nữa", "thôi", "chứ", "à", "ạ", "ơi", "nhé", "tôi", "chúng", "họ"
+};
+
+constexpr auto english_set = build_static_set(english_words);
+constexpr auto vietnamese_set = build_static_set(vietnamese_words);
+static_assert(english_set.ok, "Không dựng được hàm băm hoàn hảo cho danh sách từ dừng tiếng Anh");
+static_assert(vietnamese_set.ok, "Không dựng được hàm băm hoàn hảo cho danh sách từ dừng tiếng Việt");
+
+template <size_t N>
+StopWordSet make_builtin(const StaticStopWords<N>& set) {
+    StopWordSet result;
+    result.words = set.words.data();
+    result.lengths = set.lengths.data();
+    result.displacements = set.displacements.data();
+    result.num_words = (uint32_t)N;
+    result.num_buckets = bucket_count_for(N);
+    result.seed = set.seed;
+    result.is_builtin = true;
+    return result;
+}
+
+StopWordSet g_english_stopwords = make_builtin(english_set);
+StopWordSet g_vietnamese_stopwords = make_builtin(vietnamese_set);
+
+/**
+ * @brief Tải tệp danh sách từ dừng và dựng hàm băm hoàn hảo tối thiểu lúc chạy.
+ */
+StopWordSet* load_stopword_file(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) return NULL;
+
+    std::vector<std::string> list;
+    char line_buffer[512];
+    while (fgets(line_buffer, sizeof(line_buffer), file) != NULL) {
+        char* start = line_buffer;
+        while (isspace((unsigned char)*start)) start++;
+        if (*start == '#' || *start == '\0') continue;
+        char* end = start + strlen(start);
+        while (end > start && isspace((unsigned char)end[-1])) end--;
+        if (end - start > 255) continue; // Độ dài được lưu trong 1 byte
+        std::string word(start, end);
+        for (auto& ch : word) ch = (char)tolower((unsigned char)ch);
+        list.push_back(word);
+    }
+    fclose(file);
+
+    // Từ trùng lặp sẽ luôn đụng độ, nên phải loại bỏ trước khi dựng
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+
+    StopWordSet* set = new StopWordSet();
+    set->is_builtin = false;
+    set->num_words = (uint32_t)list.size();
+    set->num_buckets = bucket_count_for(list.size());
+    if (list.empty()) {
+        set->displacement_storage.assign(1, 0);
+        set->displacements = set->displacement_storage.data();
+        set->words = NULL;
+        set->lengths = NULL;
+        set->seed = 0;
+        return set;
+    }
+
+    // Gom toàn bộ từ vào một vùng nhớ liền mạch (kèm '\0' để dễ gỡ lỗi)
+    std::vector<size_t> offsets;
+    for (const auto& word : list) {
+        offsets.push_back(set->arena.size());
+        set->arena.append(word);
+        set->arena.push_back('\0');
+    }
+
+    uint32_t n = set->num_words;
+    std::vector<uint64_t> hashes(n);
+    std::vector<uint32_t> bucket_start(set->num_buckets + 1);
+    std::vector<uint32_t> keys_by_bucket(n);
+    std::vector<uint32_t> slots(n);
+    set->displacement_storage.assign(set->num_buckets, 0);
+
+    bool ok = false;
+    for (uint64_t seed = 0; seed < 64 && !ok; seed++) {
+        for (uint32_t i = 0; i < n; i++) hashes[i] = word_hash(list[i].data(), list[i].size(), seed);
+        ok = build_displacements(hashes, n, set->num_buckets, bucket_start, keys_by_bucket, set->displacement_storage, slots);
+        set->seed = seed;
+    }
+    if (!ok) {
+        delete set;
+        return NULL;
+    }
+
+    set->word_storage.resize(n);
+    set->length_storage.resize(n);
+    for (uint32_t s = 0; s < n; s++) {
+        set->word_storage[s] = set->arena.data() + offsets[slots[s]];
+        set->length_storage[s] = (uint8_t)list[slots[s]].size();
+    }
+    set->words = set->word_storage.data();
+    set->lengths = set->length_storage.data();
+    set->displacements = set->displacement_storage.data();
+    return set;
+}
+
+} // namespace
+
+// --- CÀI ĐẶT CÁC HÀM "PUBLIC" ---
+
+StopWordSet* stopwords_create(const char* source) {
+    if (source == NULL) return NULL;
+    if (strcmp(source, "en") == 0) return &g_english_stopwords;
+    if (strcmp(source, "vi") == 0) return &g_vietnamese_stopwords;
+    return load_stopword_file(source);
+}
+
+int stopwords_contains(const StopWordSet* set, const char* word, size_t length) {
+    if (set == NULL || set->num_words == 0) return 0;
+    uint64_t h = word_hash(word, length, set->seed);
+    uint32_t slot = slot_of(h, set->displacements[bucket_of(h, set->num_buckets)], set->num_words);
+    return set->lengths[slot] == length && memcmp(set->words[slot], word, length) == 0;
+}
+
+size_t stopwords_count(const StopWordSet* set) {
+    return set == NULL ? 0 : set->num_words;
+}
+
+void stopwords_free(StopWordSet* set) {
+    if (set != NULL && !set->is_builtin) delete set;
+}
@@ -0,0 +1,39 @@
+#ifndef STOPWORDS_H
+#define STOPWORDS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Tập từ dừng (stop words) tra cứu bằng hàm băm hoàn hảo tối thiểu.
+ * Danh sách dựng sẵn ("en", "vi") được dựng lúc biên dịch (constexpr);
+ * danh sách của người dùng được dựng lúc chạy với cùng thuật toán.
+ */
+typedef struct StopWordSet StopWordSet;
+
+/**
+ * @brief Lấy tập từ dừng dựng sẵn hoặc tải từ tệp.
+ * @param source Mã ngôn ngữ ("en", "vi") hoặc đường dẫn tệp (mỗi dòng một từ,
+ *               dòng bắt đầu bằng '#' là chú thích). Từ trong tệp được chuyển về chữ thường.
+ * @return Con trỏ đến tập từ dừng, hoặc NULL nếu không mở được tệp.
+ */
+StopWordSet* stopwords_create(const char* source);
+
+/**
+ * @brief Kiểm tra một từ có thuộc tập từ dừng không (một lần dò duy nhất).
+ * @param word Từ cần kiểm tra (không cần kết thúc bằng '\0').
+ * @param length Độ dài của từ tính bằng byte.
+ * @return 1 nếu là từ dừng, 0 nếu không.
+ */
+int stopwords_contains(const StopWordSet* set, const char* word, size_t length);
+
+/**
+ * @brief Số từ trong tập.
+ */
+size_t stopwords_count(const StopWordSet* set);
+
+/**
+ * @brief Giải phóng tập từ dừng (không làm gì với tập dựng sẵn).
+ */
+void stopwords_free(StopWordSet* set);
+
+#endif // STOPWORDS_H
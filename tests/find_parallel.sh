@@ -0,0 +1,76 @@
+#!/bin/sh
+# find_parallel.sh - Kiểm tra 'find -j 1' và 'find -j N' cho kết quả giống hệt nhau
+#
+# Cách dùng: find_parallel.sh <chương trình> [số luồng, mặc định 8]
+# Tệp nhật ký được sinh lại giống hệt ở mỗi lần chạy và lớn hơn vài đoạn tìm kiếm (4 MB),
+# nên bản nhiều luồng thật sự chia tệp. Mỗi chế độ tìm (chuỗi con, --match, --regex, --fuzzy,
+# --count, --max-count, --bytes/--lines) được chạy trên tệp thường và trên tệp nén --seekable.
+set -e
+
+BIN=$1
+THREADS=${2:-8}
+WORK=${TMPDIR:-/tmp}/text_analyst_find.$$
+LOG=$WORK/log.txt
+
+if [ -z "$BIN" ]; then
+    echo "Cách dùng: $0 <chương trình> [số luồng]" >&2
+    exit 1
+fi
+
+mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+failures=0
+cases=0
+
+# Nhật ký giả lập khoảng 16 MB: mức độ, đường dẫn và mã trạng thái xoay vòng theo số dòng
+awk 'BEGIN {
+    split("INFO WARN ERROR DEBUG", level, " ");
+    split("/api/users /api/orders /static/app.js /health /api/Request/retry", path, " ");
+    for (i = 0; i < 200000; i++) {
+        printf "2026-10-19 %02d:%02d:%02d %s request id=%d GET %s status=%d in %d ms\n",
+               (i / 3600) % 24, (i / 60) % 60, i % 60, level[i % 4 + 1], i,
+               path[(i * 7) % 5 + 1], 200 + (i % 3) * 100, (i * 13) % 977;
+    }
+}' > "$LOG"
+"$BIN" compress "$LOG" --algo lzh --seekable -o "$WORK/log" > /dev/null 2>&1
+
+# check_case <mô tả> <tham số của find sau tệp...>
+check_case() {
+    label=$1
+    shift
+    for file in "$LOG" "$WORK/log.lzh"; do
+        cases=$((cases + 1))
+        "$BIN" find "$file" "$@" -j 1 > "$WORK/one.txt" 2>&1 || true
+        "$BIN" find "$file" "$@" -j "$THREADS" > "$WORK/many.txt" 2>&1 || true
+        if ! cmp -s "$WORK/one.txt" "$WORK/many.txt"; then
+            echo "FAIL: $label ($(basename "$file")): -j 1 và -j $THREADS khác nhau" >&2
+            failures=$((failures + 1))
+        elif [ ! -s "$WORK/one.txt" ]; then
+            echo "FAIL: $label ($(basename "$file")): không có kết quả" >&2
+            failures=$((failures + 1))
+        fi
+    done
+    # Tệp nén phải cho cùng kết quả với tệp thường (trừ tên tệp trong --count)
+    sed "s|^$WORK/log.lzh:|$LOG:|" "$WORK/many.txt" > "$WORK/many_plain.txt"
+    "$BIN" find "$LOG" "$@" -j "$THREADS" > "$WORK/plain.txt" 2>&1 || true
+    if ! cmp -s "$WORK/plain.txt" "$WORK/many_plain.txt"; then
+        echo "FAIL: $label: tệp nén và tệp thường khác nhau" >&2
+        failures=$((failures + 1))
+    fi
+}
+
+check_case "chuỗi con" request
+check_case "--match" Request --match
+check_case "--match --case-sensitive" ERROR --match --case-sensitive
+check_case "--regex" 'status=[45]00 in 9[0-9]{2} ms' --regex
+check_case "--fuzzy" rety --fuzzy 1
+check_case "--count" retry --count
+check_case "--max-count" retry --max-count 25
+check_case "--bytes" ERROR --match --bytes 1000003:9000001
+check_case "--lines" health --lines 50000:150000
+
+if [ $failures -ne 0 ]; then
+    echo "find_parallel: $failures/$cases kiểm tra thất bại." >&2
+    exit 1
+fi
+echo "find_parallel: OK ($cases trường hợp, -j 1 so với -j $THREADS)"
@@ -0,0 +1,84 @@
+#!/bin/sh
+# regex_cases.sh - So kết quả 'find --regex' với các dòng khớp đã biết trước
+#
+# Cách dùng: regex_cases.sh <chương trình>
+# Mỗi trường hợp gồm biểu thức, tùy chọn thêm và danh sách số dòng phải khớp ("-" nếu không dòng nào).
+# Các biểu thức sai cú pháp phải bị từ chối với mã thoát khác 0.
+set -e
+
+BIN=$1
+WORK=${TMPDIR:-/tmp}/text_analyst_regex.$$
+DATA=$WORK/data.txt
+
+if [ -z "$BIN" ]; then
+    echo "Cách dùng: $0 <chương trình>" >&2
+    exit 1
+fi
+
+mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+failures=0
+cases=0
+
+printf '%s\n' \
+    'ERR404 not found' \
+    'err500 internal' \
+    'WARN disk 91%' \
+    'user=alice id=42' \
+    'a.b.c' \
+    'abc' \
+    'tab	here' \
+    'aaaab' \
+    '' \
+    'xyz' > "$DATA"
+
+# expect <số dòng khớp> <biểu thức> [tùy chọn...]
+expect() {
+    want=$1
+    shift
+    cases=$((cases + 1))
+    got=$("$BIN" find "$DATA" -- "$@" --regex 2> /dev/null |
+          sed -n 's/^.* trong dòng \([0-9][0-9]*\): .*$/\1/p' | tr '\n' ' ' | sed 's/ $//')
+    [ -n "$got" ] || got=-
+    if [ "$got" != "$want" ]; then
+        echo "FAIL: '$1' $2: cần dòng [$want], nhận được [$got]" >&2
+        failures=$((failures + 1))
+    fi
+}
+
+# reject <biểu thức>
+reject() {
+    cases=$((cases + 1))
+    if "$BIN" find "$DATA" -- "$1" --regex > /dev/null 2>&1; then
+        echo "FAIL: '$1' phải là lỗi cú pháp" >&2
+        failures=$((failures + 1))
+    fi
+}
+
+expect "1 2"     'ERR[0-9]{3}'
+expect "1"       'ERR[0-9]{3}' --case-sensitive
+expect "4 5 6 8" '^a|alice'
+expect "5 6"     'c$'
+expect "5"       'a\.b'
+expect "5 8"     'a.b'
+expect "3"       '\d+%'
+expect "5 6 7 8" '(a*)*b'
+expect "3 4"     'alice|disk'
+expect "7"       '\t'
+expect "9"       '^$'
+expect "10"      'x(?:y|q)z'
+expect "8"       'a{4}b'
+expect "-"       'a{5}'
+expect "4"       '\w+=\w+ id=\d{2}$'
+expect "1 2 3 4 7" '^[^a-d]\S*\s'
+
+reject '\b'
+reject '(ab'
+reject 'a{2,1}'
+reject '[z-a]'
+
+if [ $failures -ne 0 ]; then
+    echo "regex_cases: $failures/$cases kiểm tra thất bại." >&2
+    exit 1
+fi
+echo "regex_cases: OK ($cases trường hợp)"
@@ -0,0 +1,103 @@
+#!/bin/sh
+# roundtrip.sh - Nén rồi giải nén bằng mọi thuật toán và so với tệp gốc; kiểm tra lệnh 'verify'
+#
+# Cách dùng: roundtrip.sh <chương trình>
+# Dữ liệu vào được sinh lại giống hệt ở mỗi lần chạy: tệp rỗng, một byte, đủ 256 giá trị byte,
+# văn bản nhiều dòng lớn hơn một khối (1 MB) và dữ liệu có nhiều đoạn lặp.
+set -e
+
+BIN=$1
+WORK=${TMPDIR:-/tmp}/text_analyst_roundtrip.$$
+ALGOS="rle huffman rleb huffb lz77 lzh auto"
+
+if [ -z "$BIN" ]; then
+    echo "Cách dùng: $0 <chương trình>" >&2
+    exit 1
+fi
+
+mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+failures=0
+
+fail() {
+    echo "FAIL: $*" >&2
+    failures=$((failures + 1))
+}
+
+# 1. Dữ liệu vào
+: > "$WORK/empty.bin"
+printf 'x' > "$WORK/one.bin"
+i=0
+while [ $i -lt 256 ]; do
+    printf "\\$(printf '%03o' $i)"
+    i=$((i + 1))
+done > "$WORK/bytes.bin"
+awk 'BEGIN {
+    split("INFO WARN ERROR DEBUG", level, " ");
+    for (i = 0; i < 60000; i++) {
+        printf "2026-10-19 %02d:%02d:%02d %s request id=%d status=%d\n",
+               (i / 3600) % 24, (i / 60) % 60, i % 60, level[i % 4 + 1], i, 200 + (i % 3) * 100;
+    }
+}' > "$WORK/log.txt"
+awk 'BEGIN {
+    for (i = 0; i < 20000; i++) {
+        n = (i * 7) % 200 + 1;
+        s = "";
+        for (j = 0; j < n; j++) s = s sprintf("%c", 65 + i % 26);
+        printf "%s%d", s, i;
+    }
+}' > "$WORK/runs.bin"
+
+# 2. Nén, kiểm tra và giải nén từng tệp bằng từng thuật toán
+for input in empty.bin one.bin bytes.bin log.txt runs.bin; do
+    original=$WORK/$input
+    for algo in $ALGOS; do
+        rm -f "$WORK"/c.*
+        if ! "$BIN" compress "$original" --algo "$algo" -o "$WORK/c" > /dev/null 2>&1; then
+            fail "compress $input --algo $algo"
+            continue
+        fi
+        # Đuôi của tệp nén là thuật toán đã dùng (với 'auto' là thuật toán được chọn)
+        compressed=$(ls "$WORK"/c.* | head -n 1)
+        if ! "$BIN" verify "$compressed" > /dev/null 2>&1; then
+            fail "verify $input --algo $algo"
+        fi
+        if ! "$BIN" decompress "$compressed" -o "$WORK/d.out" > /dev/null 2>&1 ||
+           ! cmp -s "$original" "$WORK/d.out"; then
+            fail "decompress $input --algo $algo"
+        fi
+    done
+done
+
+# 3. Tệp có bảng tra vị trí: đọc một khoảng dòng mà không giải nén cả tệp
+rm -f "$WORK"/c.*
+"$BIN" compress "$WORK/log.txt" --algo lzh --seekable -o "$WORK/c" > /dev/null 2>&1
+{ echo "--- Nội dung của tệp ---"; sed -n '40000,40010p' "$WORK/log.txt"; echo; echo "------------------------"; } > "$WORK/expected.txt"
+if ! "$BIN" read "$WORK/c.lzh" --lines 40000:40010 > "$WORK/range.txt" 2>&1 || ! cmp -s "$WORK/expected.txt" "$WORK/range.txt"; then
+    fail "read --lines trên tệp --seekable"
+fi
+
+# 4. Tệp hỏng hoặc bị cắt cụt phải bị từ chối
+size=$(wc -c < "$WORK/c.lzh" | tr -d ' ')
+cp "$WORK/c.lzh" "$WORK/bad.lzh"
+printf '\377' | dd of="$WORK/bad.lzh" bs=1 seek=$((size / 2)) conv=notrunc 2> /dev/null
+if "$BIN" verify "$WORK/bad.lzh" > /dev/null 2>&1; then
+    fail "verify chấp nhận tệp bị sửa một byte"
+fi
+head -c $((size / 2)) "$WORK/c.lzh" > "$WORK/cut.lzh"
+if "$BIN" decompress "$WORK/cut.lzh" -o "$WORK/d.out" > /dev/null 2>&1; then
+    fail "decompress chấp nhận tệp bị cắt cụt"
+fi
+
+# 5. RLE cũ không có header (các cặp số lần, byte) vẫn giải nén được
+printf '\003a\002b\001\n' > "$WORK/legacy.rle"
+printf 'aaabb\n' > "$WORK/legacy.txt"
+if ! "$BIN" decompress "$WORK/legacy.rle" -o "$WORK/d.out" > /dev/null 2>&1 || ! cmp -s "$WORK/legacy.txt" "$WORK/d.out"; then
+    fail "decompress RLE cũ không có header"
+fi
+
+if [ $failures -ne 0 ]; then
+    echo "roundtrip: $failures kiểm tra thất bại." >&2
+    exit 1
+fi
+echo "roundtrip: OK ($ALGOS)"
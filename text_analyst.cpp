@@ -3,11 +3,33 @@
 #include <string.h>
 #include <limits.h>
 #include <ctype.h>
+#include <time.h>
+#include <signal.h>
+#include <math.h>
+#ifdef _WIN32
 #include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 extern "C" {
 #include "compress.h"
 #include "hashtable.h"
+#include "report.h"
+#include "stopwords.h"
+#include "tokenizer.h"
+#include "threadpool.h"
+#include "mapped_file.h"
+#include "search.h"
+#include "multisearch.h"
+#include "invindex.h"
+#include "regex_dfa.h"
+#include "fuzzy.h"
+#include "lz77.h"
+#include "lzh.h"
 }
 
 // Định nghĩa các mã lệnh
@@ -17,6 +39,9 @@ extern "C" {
 #define CMD_FIND        4
 #define CMD_COMPRESS    5
 #define CMD_DECOMPRESS  6
+#define CMD_CORPUS      7
+#define CMD_INDEX       8
+#define CMD_VERIFY      9
 
 #define SORT_NONE    0
 #define SORT_ALPHA   1 // Theo alphabet
@@ -24,6 +49,25 @@ extern "C" {
 #define SORT_LEN_ASC 3 // Theo độ dài tăng dần
 #define HASH_TABLE_SIZE 10007
 
+// Cấu hình chế độ theo dõi (--follow)
+#define FOLLOW_POLL_MS           200   // Chu kỳ kiểm tra dữ liệu mới (ms)
+#define FOLLOW_BUCKET_TABLE_SIZE 1021  // Kích thước bảng băm cho mỗi khung thời gian
+#define FOLLOW_READ_CHUNK        65536
+#define FOLLOW_TAIL_CHECK        16    // Số byte cuối đã đọc được so lại để phát hiện tệp bị cắt ngắn rồi ghi tiếp
+
+// Vị trí trong tệp 64 bit: long chỉ có 32 bit trên Windows nên fseek/ftell không vượt được 2 GB
+#ifdef _WIN32
+#define file_seek64 _fseeki64
+#define file_tell64 _ftelli64
+#else
+#define file_seek64 fseeko
+#define file_tell64 ftello
+#endif
+
+// Cấu hình tìm kiếm song song (find -j)
+#define FIND_CHUNK_SIZE          (4 << 20) // Kích thước mỗi đoạn tệp (được nới đến hết dòng)
+#define FIND_CHUNKS_PER_THREAD   4         // Số đoạn mỗi luồng trong một đợt; kết quả được in sau mỗi đợt
+
 // Macro để kiểm tra cấp phát bộ nhớ
 #define CHECK_ALLOC(ptr, message) \
     if ((ptr) == NULL) { \
@@ -31,11 +75,6 @@ extern "C" {
         exit(EXIT_FAILURE); \
     }
 
-typedef struct {
-    char *word; // Con trỏ để lưu chuỗi (từ)
-    int count;  // Số lần xuất hiện
-} WordStats;
-
 // bảng ánh xạ thuật toán nén
 typedef struct {
     const char* name;
@@ -45,24 +84,70 @@ typedef struct {
 // Tạo một bảng tra cứu tĩnh
 static const AlgoMap algo_mappings[] = {
     { "rle",     ALG_RLE },
-    { "huffman", ALG_HUFFMAN }
-    // Dễ dàng thêm thuật toán mới ở đây, ví dụ:
-    // { "lz77", ALG_LZ77 },
+    { "huffman", ALG_HUFFMAN },
+    { "rleb",    ALG_RLE_BLOCK },
+    { "huffb",   ALG_HUFFMAN_BLOCK },
+    { "lz77",    ALG_LZ77 },
+    { "lzh",     ALG_LZH },
+    { "auto",    ALG_AUTO }
+    // Dễ dàng thêm thuật toán mới ở đây
 };
 // Tính số lượng thuật toán trong bảng
 static const int num_algos = sizeof(algo_mappings) / sizeof(algo_mappings[0]);
 
+// Các tùy chọn của 'find': tham số ngay sau tên tệp là từ khóa, trừ khi nó là một trong các tùy chọn này
+// (từ khóa được bỏ qua khi dùng --patterns). Từ khóa trùng tên tùy chọn được viết sau '--'.
+static const char* const find_options[] = {
+    "--case-sensitive", "--match", "--patterns", "--index", "--index-file", "--regex",
+    "--count", "--files-with-matches", "--max-count", "--fuzzy", "--bytes", "--lines", "-j", "-o", "--output"
+};
+static const int num_find_options = sizeof(find_options) / sizeof(find_options[0]);
+// Kiểu kết quả của lệnh 'find'
+typedef enum {
+    FIND_OUTPUT_LINES, // In từng dòng khớp (mặc định)
+    FIND_OUTPUT_COUNT, // --count: chỉ in số dòng khớp của mỗi tệp
+    FIND_OUTPUT_FILES  // --files-with-matches: chỉ in tên các tệp có kết quả
+} FindOutputMode;
+
+// Khoảng dữ liệu mà 'read' và 'find' làm việc (--bytes, --lines)
+typedef enum {
+    RANGE_NONE,  // Toàn bộ tệp
+    RANGE_BYTES, // Byte [range_start, range_end), đếm từ 0
+    RANGE_LINES  // Dòng range_start..range_end, đếm từ 1
+} RangeMode;
+
 // Cấu hình chương trình
 typedef struct {
     int command_code;
     char *input_filename;
     char *output_filename;
     char *keyword;
+    char *patterns_filename; // Tệp danh sách mẫu cho 'find --patterns'
+    char *index_filename;    // Tệp chỉ mục cho 'find --index-file' (NULL: <tên_tệp>.idx)
+    char *stopwords_source; // Mã ngôn ngữ hoặc tệp danh sách từ dừng
+    char **input_files;     // Danh sách tệp cho lệnh 'corpus' và 'find' (phần tử đầu là input_filename)
+    int input_count;
 
     // Tùy chọn
     int case_sensitive;
     int exact_match;
+    int use_index;       // 'find --index': trả lời bằng chỉ mục đảo thay vì quét tệp
+    int use_regex;       // 'find --regex': từ khóa là biểu thức chính quy
+    int fuzzy_errors;    // 'find --fuzzy K': số lỗi chỉnh sửa cho phép (-1 = tìm chính xác)
+    FindOutputMode find_output; // 'find --count' / '--files-with-matches'
+    int max_count;       // 'find --max-count': số dòng khớp tối đa mỗi tệp (0 = không giới hạn)
     int sort_mode;
+    ReportFormat report_format;
+    int follow;          // Chế độ theo dõi tệp đang được ghi thêm
+    int window_minutes;  // Độ dài cửa sổ trượt (phút)
+    int bucket_seconds;  // Độ dài mỗi khung thời gian (giây)
+    int top_count;       // Số từ hiển thị (chế độ theo dõi, corpus)
+    int num_threads;     // Số luồng (-j), 0 nghĩa là dùng số lõi CPU
+    int compress_level;  // 'compress --level': mức nỗ lực của LZ77 (0 = mặc định)
+    int seekable;        // 'compress --seekable': ghi bảng tra vị trí để đọc một khoảng mà không giải nén cả tệp
+    RangeMode range_mode;
+    uint64_t range_start;
+    uint64_t range_end;  // UINT64_MAX: đến hết tệp
     CompressionAlgorithm algo;
     int algo_is_manual;
 } Config;
@@ -74,12 +159,20 @@ const char* get_string_from_algo(CompressionAlgorithm algo);
 
 int get_command_code(const char *command_str);
 int parse_arguments(int argc, char *argv[], Config *config);
+static int is_find_option(const char *arg);
+static int parse_range(const char *text, uint64_t *start, uint64_t *end);
 void print_usage(char *program_name);
-void perform_read(FILE *file);
-void perform_analysis(FILE *file, int case_sensitive, int sort_mode, const char* output_filename);
-void perform_find(FILE *file, int case_sensitive, int exact_match, const char *word_to_find, const char *output_filename);
+int perform_read(FILE *file, const Config* config);
+void perform_analysis(FILE *file, int case_sensitive, int sort_mode, ReportFormat report_format, const StopWordSet* stopwords, const char* output_filename);
+int perform_follow(FILE *file, const Config* config, const StopWordSet* stopwords);
+int perform_corpus(const Config* config);
+int perform_find(const Config* config);
+int perform_find_patterns(const Config* config);
+int perform_find_indexed(const Config* config);
+int perform_index(const Config* config);
 int perform_compress(FILE* input_file, const Config* config);
 int perform_decompress(FILE* input_file, const Config* config);
+int perform_verify(FILE* input_file, const Config* config);
 
 void to_lowercase(char *str);
 int compare_alpha(const void *a, const void *b);
@@ -91,8 +184,10 @@ WordStats* ht_to_array(HashTable* table, int* count);
 // --- Hàm main ---
 int main(int argc, char *argv[]) {
     // Thiết lập console để in tiếng Việt
+#ifdef _WIN32
     SetConsoleOutputCP(65001);
     SetConsoleCP(65001);
+#endif
 
     // --- Kiểm tra số lượng đối số ---
     if (argc < 3) {
@@ -107,8 +202,37 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    const char* input_mode = (config.command_code == CMD_COMPRESS || config.command_code == CMD_DECOMPRESS) ? "rb" : "r";
-    FILE* input_file = fopen(config.input_filename, input_mode);
+    // Lệnh 'corpus' và 'find' làm việc với nhiều tệp, tự mở từng tệp
+    if (config.command_code == CMD_CORPUS) {
+        int result = perform_corpus(&config);
+        free(config.input_files);
+        return result == 0 ? 0 : 1;
+    }
+    if (config.command_code == CMD_FIND) {
+        int result;
+        if (config.use_index) {
+            result = perform_find_indexed(&config);
+        } else if (config.patterns_filename != NULL) {
+            result = perform_find_patterns(&config);
+        } else {
+            result = perform_find(&config);
+        }
+        free(config.input_files);
+        return result == 0 ? 0 : 1;
+    }
+
+    const char* input_mode = (config.command_code == CMD_COMPRESS || config.command_code == CMD_DECOMPRESS ||
+                              config.command_code == CMD_VERIFY || config.follow) ? "rb" : "r";
+    FILE* input_file;
+    if (strcmp(config.input_filename, "-") == 0) {
+        // Đọc từ đầu vào chuẩn (pipe)
+        input_file = stdin;
+#ifdef _WIN32
+        if (input_mode[1] == 'b') _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    } else {
+        input_file = fopen(config.input_filename, input_mode);
+    }
     if (input_file == NULL) {
         fprintf(stderr, "Lỗi: Không thể mở tệp đầu vào '%s'\n", config.input_filename);
         return 1;
@@ -116,13 +240,38 @@ int main(int argc, char *argv[]) {
 
     switch (config.command_code) {
         case CMD_READ:
-            perform_read(input_file);
+            if (perform_read(input_file, &config) != 0) {
+                fclose(input_file);
+                return 1;
+            }
             break;
-        case CMD_ANALYST:
-            perform_analysis(input_file, config.case_sensitive, config.sort_mode, config.output_filename);
+        case CMD_ANALYST: {
+            StopWordSet* stopwords = NULL;
+            if (config.stopwords_source != NULL) {
+                stopwords = stopwords_create(config.stopwords_source);
+                if (stopwords == NULL) {
+                    fprintf(stderr, "Lỗi: Không thể tải danh sách từ dừng '%s'\n", config.stopwords_source);
+                    fclose(input_file);
+                    return 1;
+                }
+            }
+            if (config.follow) {
+                if (perform_follow(input_file, &config, stopwords) != 0) {
+                    stopwords_free(stopwords);
+                    fclose(input_file);
+                    return 1;
+                }
+            } else {
+                perform_analysis(input_file, config.case_sensitive, config.sort_mode, config.report_format, stopwords, config.output_filename);
+            }
+            stopwords_free(stopwords);
             break;
-        case CMD_FIND:
-            perform_find(input_file, config.case_sensitive, config.exact_match, config.keyword, config.output_filename);
+        }
+        case CMD_INDEX:
+            if (perform_index(&config) != 0) {
+                fclose(input_file);
+                return 1;
+            }
             break;
         case CMD_COMPRESS:
             if (perform_compress(input_file, &config) != 0) {
@@ -134,13 +283,19 @@ int main(int argc, char *argv[]) {
                 return 1; // Trả về lỗi nếu giải nén thất bại
             }
             break;
+        case CMD_VERIFY:
+            if (perform_verify(input_file, &config) != 0) {
+                return 1; // Tệp nén bị hỏng hoặc không kiểm tra được
+            }
+            break;
         default:
             printf("Lỗi: Lệnh '%s' không hợp lệ.\n", argv[1]);
             print_usage(argv[0]);
             break;
     }
 
-    fclose(input_file);
+    if (input_file != stdin) fclose(input_file);
+    free(config.input_files);
     return 0;
 }
 
@@ -154,6 +309,9 @@ int get_command_code(const char *command_str) {
     if (strcmp(command_str, "find") == 0) return CMD_FIND;
     if (strcmp(command_str, "compress") == 0) return CMD_COMPRESS;
     if (strcmp(command_str, "decompress") == 0) return CMD_DECOMPRESS;
+    if (strcmp(command_str, "corpus") == 0) return CMD_CORPUS;
+    if (strcmp(command_str, "index") == 0) return CMD_INDEX;
+    if (strcmp(command_str, "verify") == 0) return CMD_VERIFY;
     return CMD_UNKNOWN;
 }
 
@@ -170,21 +328,49 @@ int parse_arguments(int argc, char *argv[], Config *config) {
     config->input_filename = argv[2];
     config->output_filename = NULL;
     config->keyword = NULL;
+    config->patterns_filename = NULL;
+    config->index_filename = NULL;
+    config->stopwords_source = NULL;
+    config->input_files = NULL;
+    config->input_count = 0;
     config->case_sensitive = 0;
     config->exact_match = 0;
+    config->use_index = 0;
+    config->use_regex = 0;
+    config->fuzzy_errors = -1;
+    config->find_output = FIND_OUTPUT_LINES;
+    config->max_count = 0;
     config->sort_mode = SORT_NONE;
+    config->report_format = REPORT_TEXT;
+    config->follow = 0;
+    config->window_minutes = 5;
+    config->bucket_seconds = 10;
+    config->top_count = 10;
+    config->num_threads = 0;
+    config->compress_level = 0;
+    config->seekable = 0;
+    config->range_mode = RANGE_NONE;
+    config->range_start = 0;
+    config->range_end = UINT64_MAX;
     config->algo = ALG_RLE;
     config->algo_is_manual = 0;
 
     // Xác định tham số bắt buộc và điểm bắt đầu của tùy chọn
     int start_options_index = 3;
-    if (config->command_code == CMD_FIND) {
-        if (argc < 4) {
-            fprintf(stderr, "Lỗi: Lệnh 'find' cần có từ khóa tìm kiếm.\n");
-            return -1;
+    // Từ khóa của 'find' có thể bắt đầu bằng '-' (ví dụ 'find log.txt -v'); chỉ bỏ qua khi dùng --patterns
+    if (config->command_code == CMD_FIND && argc >= 4) {
+        if (strcmp(argv[3], "--") == 0 && argc >= 5) {
+            config->keyword = argv[4];
+            start_options_index = 5;
+        } else if (!is_find_option(argv[3])) {
+            config->keyword = argv[3];
+            start_options_index = 4;
         }
-        config->keyword = argv[3];
-        start_options_index = 4;
+    }
+    if (config->command_code == CMD_CORPUS || config->command_code == CMD_FIND) {
+        config->input_files = (char**)malloc(argc * sizeof(char*));
+        CHECK_ALLOC(config->input_files, "Tạo danh sách tài liệu");
+        config->input_files[config->input_count++] = argv[2];
     }
 
     // Vòng lặp xử lý các tùy chọn còn lại
@@ -193,6 +379,34 @@ int parse_arguments(int argc, char *argv[], Config *config) {
         if (strcmp(argv[i], "--case-sensitive") == 0) config->case_sensitive = 1;
         // Kiểm tra match exact
         else if (strcmp(argv[i], "--match") == 0) config->exact_match = 1;
+        // Kiểm tra tìm kiếm bằng chỉ mục
+        else if (strcmp(argv[i], "--index") == 0 && config->command_code == CMD_FIND) config->use_index = 1;
+        // Kiểm tra tìm kiếm bằng biểu thức chính quy
+        else if (strcmp(argv[i], "--regex") == 0 && config->command_code == CMD_FIND) config->use_regex = 1;
+        // Kiểm tra tìm kiếm gần đúng
+        else if (strcmp(argv[i], "--fuzzy") == 0 && config->command_code == CMD_FIND) {
+            if (i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9') {
+                config->fuzzy_errors = atoi(argv[++i]);
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp số lỗi cho phép sau tùy chọn '--fuzzy'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        // Kiểm tra các chế độ chỉ đếm của 'find'
+        else if (strcmp(argv[i], "--count") == 0 && config->command_code == CMD_FIND) {
+            if (config->find_output == FIND_OUTPUT_LINES) config->find_output = FIND_OUTPUT_COUNT;
+        }
+        else if (strcmp(argv[i], "--files-with-matches") == 0 && config->command_code == CMD_FIND) config->find_output = FIND_OUTPUT_FILES;
+        else if (strcmp(argv[i], "--max-count") == 0 && config->command_code == CMD_FIND) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                config->max_count = atoi(argv[++i]);
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp số nguyên dương sau tùy chọn '--max-count'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
 
         // Kiểm tra tùy chọn sort
         else if (strcmp(argv[i], "--sort") == 0 && config->command_code == CMD_ANALYST) {
@@ -214,6 +428,129 @@ int parse_arguments(int argc, char *argv[], Config *config) {
             }
         }
 
+        // Kiểm tra định dạng xuất báo cáo
+        else if (strcmp(argv[i], "--format") == 0 && config->command_code == CMD_ANALYST) {
+            if (i + 1 < argc) {
+                i++;
+                config->report_format = get_report_format_from_string(argv[i]);
+                if (config->report_format == REPORT_UNKNOWN) {
+                    fprintf(stderr, "Lỗi: Định dạng báo cáo không hợp lệ '%s'.\n", argv[i]);
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp định dạng sau tùy chọn '--format'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra tệp danh sách mẫu cho 'find'
+        else if (strcmp(argv[i], "--patterns") == 0 && config->command_code == CMD_FIND) {
+            if (i + 1 < argc) {
+                i++;
+                config->patterns_filename = argv[i];
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp tệp danh sách mẫu sau tùy chọn '--patterns'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra tệp chỉ mục cho 'find' (chỉ mục tạo bằng 'index -o')
+        else if (strcmp(argv[i], "--index-file") == 0 && config->command_code == CMD_FIND) {
+            if (i + 1 < argc) {
+                i++;
+                config->index_filename = argv[i];
+                config->use_index = 1;
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp tệp chỉ mục sau tùy chọn '--index-file'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra danh sách từ dừng
+        else if (strcmp(argv[i], "--stopwords") == 0 && (config->command_code == CMD_ANALYST || config->command_code == CMD_CORPUS)) {
+            if (i + 1 < argc) {
+                i++;
+                config->stopwords_source = argv[i];
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp ngôn ngữ ('en', 'vi') hoặc tệp sau tùy chọn '--stopwords'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra các tùy chọn của chế độ theo dõi
+        else if (strcmp(argv[i], "--follow") == 0 && config->command_code == CMD_ANALYST) config->follow = 1;
+        else if ((strcmp(argv[i], "--window") == 0 || strcmp(argv[i], "--bucket") == 0 || strcmp(argv[i], "--top") == 0)
+                 && (config->command_code == CMD_ANALYST || config->command_code == CMD_CORPUS)) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                int value = atoi(argv[i + 1]);
+                if (strcmp(argv[i], "--window") == 0) config->window_minutes = value;
+                else if (strcmp(argv[i], "--bucket") == 0) config->bucket_seconds = value;
+                else config->top_count = value;
+                i++;
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp số nguyên dương sau tùy chọn '%s'.\n", argv[i]);
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra số luồng
+        else if (strcmp(argv[i], "-j") == 0) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                config->num_threads = atoi(argv[++i]);
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp số luồng dương sau tùy chọn '-j'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra mức nỗ lực nén
+        else if (strcmp(argv[i], "--level") == 0 && config->command_code == CMD_COMPRESS) {
+            int value = i + 1 < argc ? atoi(argv[i + 1]) : 0;
+            if (value >= LZ77_MIN_LEVEL && value <= LZ77_MAX_LEVEL) {
+                config->compress_level = value;
+                i++;
+            } else {
+                fprintf(stderr, "Lỗi: Cần cung cấp mức từ %d đến %d sau tùy chọn '--level'.\n", LZ77_MIN_LEVEL, LZ77_MAX_LEVEL);
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Kiểm tra bảng tra vị trí khi nén
+        else if (strcmp(argv[i], "--seekable") == 0 && config->command_code == CMD_COMPRESS) config->seekable = 1;
+
+        // Kiểm tra khoảng dữ liệu của 'read' và 'find'
+        else if ((strcmp(argv[i], "--bytes") == 0 || strcmp(argv[i], "--lines") == 0)
+                 && (config->command_code == CMD_READ || config->command_code == CMD_FIND)) {
+            int lines = strcmp(argv[i], "--lines") == 0;
+            if (config->range_mode != RANGE_NONE) {
+                fprintf(stderr, "Lỗi: Chỉ dùng một trong hai tùy chọn '--bytes' và '--lines'.\n");
+                return 1;
+            }
+            if (i + 1 < argc && parse_range(argv[i + 1], &config->range_start, &config->range_end) == 0
+                && (!lines || config->range_start >= 1)) {
+                config->range_mode = lines ? RANGE_LINES : RANGE_BYTES;
+                i++;
+            } else {
+                fprintf(stderr, lines ? "Lỗi: Cần cung cấp khoảng dòng 'A:B' (đếm từ 1, A <= B) hoặc 'A:' sau tùy chọn '--lines'.\n"
+                                      : "Lỗi: Cần cung cấp khoảng byte 'A:B' (đếm từ 0, A <= B) hoặc 'A:' sau tùy chọn '--bytes'.\n");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Các tham số không phải tùy chọn của 'corpus' và 'find' là tệp bổ sung
+        else if ((config->command_code == CMD_CORPUS || config->command_code == CMD_FIND) && argv[i][0] != '-') {
+            config->input_files[config->input_count++] = argv[i];
+        }
+
         // Kiểm tra tùy chọn đầu ra cho kết quả
         // đối với lệnh compress và decompress thì tùy chọn này là bắt buộc
         else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
@@ -238,6 +575,10 @@ int parse_arguments(int argc, char *argv[], Config *config) {
                     print_usage(argv[0]);
                     return 1;
                 }
+                if (config->algo == ALG_AUTO && config->command_code == CMD_DECOMPRESS) {
+                    fprintf(stderr, "Lỗi: '--algo auto' chỉ dùng khi nén; khi giải nén, thuật toán được nhận diện qua header của tệp.\n");
+                    return 1;
+                }
                 config->algo_is_manual = 1; // Đánh dấu rằng thuật toán đã được chỉ định
             } else {
                 fprintf(stderr, "Lỗi: Cần cung cấp thuật toán nén sau tùy chọn '--algo'.\n");
@@ -245,9 +586,45 @@ int parse_arguments(int argc, char *argv[], Config *config) {
                 return 1;
             }
         }
+
+        // Tham số còn lại của 'find' là tùy chọn gõ sai hoặc thừa: báo lỗi thay vì bỏ qua
+        // (main in hướng dẫn sử dụng khi hàm này trả về lỗi)
+        else if (config->command_code == CMD_FIND) {
+            fprintf(stderr, "Lỗi: Tham số không hợp lệ cho lệnh 'find': '%s'.\n", argv[i]);
+            return -1;
+        }
     }
 
     // Kiểm tra các điều kiện bắt buộc sau khi đã phân tích
+    if (config->command_code == CMD_FIND && config->keyword == NULL && config->patterns_filename == NULL) {
+        fprintf(stderr, "Lỗi: Lệnh 'find' cần có từ khóa tìm kiếm hoặc tùy chọn '--patterns'.\n");
+        return -1;
+    }
+    if (config->command_code == CMD_FIND && config->keyword != NULL && config->patterns_filename != NULL) {
+        fprintf(stderr, "Lỗi: Không dùng được từ khóa '%s' cùng với '--patterns'; hãy thêm nó vào tệp mẫu.\n", config->keyword);
+        return -1;
+    }
+    if (config->use_regex && (config->use_index || config->patterns_filename != NULL || config->keyword == NULL)) {
+        fprintf(stderr, "Lỗi: Tùy chọn '--regex' cần có biểu thức và không dùng chung với '--index' hoặc '--patterns'.\n");
+        return -1;
+    }
+    if (config->fuzzy_errors >= 0 && (config->use_regex || config->use_index || config->patterns_filename != NULL || config->exact_match)) {
+        fprintf(stderr, "Lỗi: Tùy chọn '--fuzzy' không dùng chung với '--regex', '--index', '--patterns' hoặc '--match'.\n");
+        return -1;
+    }
+    if (config->use_index && config->keyword == NULL) {
+        fprintf(stderr, "Lỗi: Tùy chọn '--index' cần có từ khóa tìm kiếm.\n");
+        return -1;
+    }
+    if ((config->use_index || config->patterns_filename != NULL)
+        && (config->input_count > 1 || config->find_output != FIND_OUTPUT_LINES || config->max_count > 0)) {
+        fprintf(stderr, "Lỗi: Nhiều tệp, '--count', '--files-with-matches' và '--max-count' không dùng chung với '--index' hoặc '--patterns'.\n");
+        return -1;
+    }
+    if ((config->use_index || config->patterns_filename != NULL) && config->range_mode != RANGE_NONE) {
+        fprintf(stderr, "Lỗi: Tùy chọn '--bytes' và '--lines' không dùng chung với '--index' hoặc '--patterns'.\n");
+        return -1;
+    }
     if ((config->command_code == CMD_COMPRESS || config->command_code == CMD_DECOMPRESS) && config->output_filename == NULL) {
         fprintf(stderr, "Lỗi: Lệnh '%s' cần có tệp đầu ra (-o).\n", argv[1]);
         return -1;
@@ -256,35 +633,309 @@ int parse_arguments(int argc, char *argv[], Config *config) {
     return 0; // Thành công
 }
 
+static int is_find_option(const char *arg) {
+    for (int i = 0; i < num_find_options; i++) {
+        if (strcmp(arg, find_options[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Đọc khoảng dạng "A:B", hoặc "A:" (đến hết tệp).
+ * @return 0 nếu hợp lệ (A <= B), -1 nếu không.
+ */
+static int parse_range(const char *text, uint64_t *start, uint64_t *end) {
+    char *rest;
+    if (!isdigit((unsigned char)text[0])) return -1;
+    unsigned long long a = strtoull(text, &rest, 10);
+    if (*rest != ':') return -1;
+    rest++;
+    if (*rest == '\0') {
+        *start = a;
+        *end = UINT64_MAX;
+        return 0;
+    }
+    if (!isdigit((unsigned char)rest[0])) return -1;
+    unsigned long long b = strtoull(rest, &rest, 10);
+    if (*rest != '\0' || b < a) return -1;
+    *start = a;
+    *end = b;
+    return 0;
+}
+
 /** @brief In hướng dẫn sử dụng chương trình.
  * @param program_name Tên chương trình, thường là argv[0].
  */
 void print_usage(char *program_name) {
     printf("Cách dùng: %s <lệnh> <tên_tệp> [tùy_chọn]\n", program_name);
     printf("Các lệnh:\n");
-    printf("  read        Đọc và in nội dung của tệp.\n");
+    printf("  read        Đọc và in nội dung của tệp (kể cả tệp nén).\n");
     printf("  analyst     Phân tích tệp.\n");
-    printf("  find        Tìm kiếm một từ trong tệp.\n");
+    printf("  find        Tìm kiếm một từ trong tệp (find <tệp> <từ_khóa> hoặc find <tệp> --patterns <tệp_mẫu>).\n");
     printf("  compress    Nén tệp.\n");
-    printf("  decompress  Giải nén tệp.\n\n");
+    printf("  decompress  Giải nén tệp.\n");
+    printf("  verify      Kiểm tra tệp nén: giải mã mọi khối và so CRC32C, không ghi dữ liệu ra.\n");
+    printf("  index       Tạo chỉ mục đảo <tên_tệp>.idx để 'find --index' không phải quét lại tệp.\n");
+    printf("  corpus      Xếp hạng từ đặc trưng của nhiều tệp theo TF-IDF (corpus <tệp1> <tệp2> ...).\n\n");
+    printf("Các tùy chọn cho 'read':\n");
+    printf("  --lines A:B In các dòng A đến B (đếm từ 1); 'A:' là từ dòng A đến hết tệp.\n");
+    printf("  --bytes A:B In các byte [A, B) (đếm từ 0); 'A:' là từ byte A đến hết tệp.\n");
+    printf("  -j n        Số luồng giải nén khi đọc tệp nén (mặc định: số lõi CPU).\n");
+    printf("  Với tệp nén, '--lines'/'--bytes' chỉ giải nén các khối phủ khoảng cần đọc; tệp cần được nén với '--seekable'.\n");
     printf("Các tùy chọn cho 'analyst':\n");
     printf("  --sort type Sắp xếp kết quả ('alpha', 'dec', 'asc').\n");
     printf("  --case-sensitive  Phân biệt chữ hoa/thường.\n");
+    printf("  --format f  Xuất toàn bộ danh sách từ dạng máy đọc ('json', 'csv', 'bin').\n");
+    printf("  --stopwords <lang|file>  Bỏ qua từ dừng ('en', 'vi' hoặc tệp mỗi dòng một từ).\n");
+    printf("  --follow    Theo dõi dữ liệu được ghi thêm vào tệp và liên tục cập nhật.\n");
+    printf("  --window n  Cửa sổ thời gian cho --follow, tính bằng phút (mặc định 5).\n");
+    printf("  --bucket n  Độ dài mỗi khung thời gian, tính bằng giây (mặc định 10).\n");
+    printf("  --top n     Số từ hiển thị trong chế độ --follow (mặc định 10).\n");
     printf("  -o <file>   Ghi kết quả ra tệp.\n");
+    printf("Các tùy chọn cho 'corpus':\n");
+    printf("  --top n     Số từ đặc trưng cho mỗi tệp (mặc định 10).\n");
+    printf("  -j n        Số luồng xử lý song song (mặc định: số lõi CPU).\n");
+    printf("  --stopwords, --case-sensitive, -o <file>  Như 'analyst'.\n");
     printf("Các tùy chọn cho 'find':\n");
     printf("  --match     Tìm kiếm khớp chính xác (mặc định là tìm chuỗi con).\n");
     printf("  --case-sensitive  Phân biệt chữ hoa/thường.\n");
+    printf("  --patterns <file>  Tìm đồng thời mọi mẫu trong tệp (mỗi dòng một mẫu) bằng một lượt quét.\n");
+    printf("  --regex     Từ khóa là biểu thức chính quy (ví dụ 'ERR[0-9]{3}'); in các dòng có chuỗi khớp.\n");
+    printf("  --fuzzy k   Tìm gần đúng: chấp nhận tối đa k lỗi thêm/xóa/thay ký tự (từ khóa tối đa %d ký tự).\n", FUZZY_MAX_PATTERN);
+    printf("  --index     Tìm từ hoặc cụm từ chính xác bằng chỉ mục <tên_tệp>.idx (tạo bằng lệnh 'index').\n");
+    printf("  --index-file <file>  Như '--index' nhưng dùng tệp chỉ mục đã tạo bằng 'index -o <file>'.\n");
+    printf("  --count     Chỉ in số dòng khớp của mỗi tệp.\n");
+    printf("  --files-with-matches  Chỉ in tên các tệp có kết quả (dừng đọc tệp ở kết quả đầu tiên).\n");
+    printf("  --max-count n  Dừng sau n dòng khớp trong mỗi tệp.\n");
+    printf("  -j n        Số luồng tìm song song trên tệp lớn (mặc định: số lõi CPU).\n");
+    printf("  --lines A:B, --bytes A:B  Chỉ tìm trong khoảng dòng/byte này (như 'read'); số dòng in ra vẫn tính từ đầu tệp.\n");
+    printf("              Tệp nén bằng 'compress --seekable' được tìm trực tiếp, chỉ giải nén các khối cần thiết.\n");
+    printf("  Có thể tìm trong nhiều tệp: find <tệp1> <từ_khóa> <tệp2> ...\n");
+    printf("  Từ khóa trùng tên một tùy chọn (ví dụ '--match') được viết sau '--': find <tệp> -- --match\n");
+    printf("Các tùy chọn cho 'compress' và 'decompress':\n");
+    printf("  --algo a    Thuật toán: 'rle', 'huffman', 'rleb' (RLE theo khối, không làm phình dữ liệu ít lặp),\n");
+    printf("              'huffb' (Huffman theo khối 1 MB, nén/giải nén song song),\n");
+    printf("              'lz77' (LZ77/LZSS, hiệu quả với log có nhiều đoạn lặp, giải nén rất nhanh),\n");
+    printf("              'lzh' (LZ77 + Huffman kiểu deflate, tỉ lệ nén tốt nhất),\n");
+    printf("              'auto' (chỉ khi nén: lấy mẫu tệp rồi chọn rleb, huffb hoặc lzh; đuôi tệp là thuật toán đã chọn).\n");
+    printf("              Khi giải nén, thuật toán được nhận diện qua header; '--algo' chỉ cần cho tệp 'rle' cũ\n");
+    printf("              (không có header) không mang đuôi .rle.\n");
+    printf("  -j n        Số luồng nén/giải nén/kiểm tra song song (mặc định: số lõi CPU).\n");
+    printf("  --seekable  Khi nén: ghi thêm bảng tra vị trí để 'read' và 'find' đọc một khoảng mà không giải nén cả tệp.\n");
+    printf("  --level n   Mức nỗ lực khi nén lz77/lzh, %d (nhanh) đến %d (nén tốt nhất); mặc định %d cho lz77, %d cho lzh.\n",
+           LZ77_MIN_LEVEL, LZ77_MAX_LEVEL, LZ77_DEFAULT_LEVEL, LZH_DEFAULT_LEVEL);
+    printf("  -o <file>   Tên tệp đầu ra (khi nén, đuôi .<thuật_toán> được thêm vào). '-' là đầu ra chuẩn.\n");
+    printf("  Tên tệp đầu vào '-' đọc từ đầu vào chuẩn; 'auto' khi đó chọn 'lzh'.\n");
+    printf("Các tùy chọn cho 'index':\n");
+    printf("  --case-sensitive  Phân biệt chữ hoa/thường (phải giống khi dùng 'find --index').\n");
+    printf("  -o <file>   Tên tệp chỉ mục (mặc định <tên_tệp>.idx; khi đó dùng 'find --index-file <file>').\n");
+}
+
+/**
+ * @brief Kiểm tra tệp có phải tệp nén dạng khung (bắt đầu bằng FRAME_MAGIC) hay không.
+ */
+static int is_compressed_file(const char *filename) {
+    if (strcmp(filename, "-") == 0) return 0;
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) return 0;
+    char magic[4];
+    int compressed = fread(magic, 1, 4, file) == 4 && memcmp(magic, FRAME_MAGIC, 4) == 0;
+    fclose(file);
+    return compressed;
+}
+
+// Khoảng dữ liệu của một tệp trong bộ nhớ: ánh xạ từ tệp thường, hoặc giải nén từ tệp nén
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t first_line;  // Số dòng (đếm từ 1) chứa byte đầu tiên của khoảng
+    int word_before;    // Byte ngay trước khoảng (--bytes) thuộc một từ: từ đầu khoảng bị cắt dở
+    int word_after;     // Byte ngay sau khoảng thuộc một từ: từ cuối khoảng bị cắt dở
+    MappedFile mapped;
+    char *buffer;       // Dữ liệu đã giải nén (NULL khi dùng mapped)
+} FileRegion;
+
+/**
+ * @brief Bỏ qua count dòng bắt đầu từ p.
+ * @return Đầu dòng thứ count tính từ p, hoặc end nếu không đủ dòng.
+ */
+static const char* skip_lines(const char *p, const char *end, uint64_t count) {
+    while (count > 0 && p < end) {
+        const char *newline = (const char*)memchr(p, '\n', end - p);
+        if (newline == NULL) return end;
+        p = newline + 1;
+        count--;
+    }
+    return p;
+}
+
+/**
+ * @brief Giải nén khoảng dữ liệu của config->range_mode từ tệp nén có bảng tra vị trí;
+ * chỉ các khối phủ khoảng đó được đọc và giải mã. Không có khoảng thì giải nén cả tệp vào bộ nhớ,
+ * nên tệp nén không có bảng tra vị trí vẫn dùng được.
+ */
+static int load_compressed_region(const Config *config, const char *filename, FileRegion *region) {
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Lỗi: Không thể mở tệp '%s'\n", filename);
+        return -1;
+    }
+    CompressOptions options = { config->num_threads, 0, 0 };
+    if (config->range_mode == RANGE_NONE) {
+        unsigned char *data = NULL;
+        int result = decompress_to_memory(file, &options, &data, &region->size);
+        fclose(file);
+        region->buffer = (char*)data;
+        region->data = region->buffer;
+        if (result != 0) fprintf(stderr, "Lỗi: Không thể giải nén tệp '%s'\n", filename);
+        return result;
+    }
+    SeekableFile *seekable = seekable_open(file, &options);
+    if (seekable == NULL) {
+        fprintf(stderr, "Lỗi: Không thể đọc tệp nén '%s'\n", filename);
+        fclose(file);
+        return -1;
+    }
+
+    uint64_t size = seekable_size(seekable);
+    uint64_t begin = 0, end = size;
+    int result = 0;
+    if (config->range_mode == RANGE_BYTES) {
+        begin = config->range_start < size ? config->range_start : size;
+        end = config->range_end < size ? config->range_end : size;
+        uint64_t lines_before = 0;
+        result = seekable_count_lines(seekable, begin, &lines_before);
+        region->first_line = (size_t)lines_before + 1;
+    } else if (config->range_mode == RANGE_LINES) {
+        result = seekable_line_start(seekable, config->range_start - 1, &begin);
+        if (result == 0) result = seekable_line_start(seekable, config->range_end, &end);
+        region->first_line = (size_t)config->range_start;
+    }
+    if (result == 0 && end - begin > SIZE_MAX - 3) {
+        fprintf(stderr, "Lỗi: Khoảng cần đọc quá lớn.\n");
+        result = -1;
+    }
+    if (result == 0) {
+        // Đọc thêm một byte mỗi bên (nếu có) để biết biên khoảng có cắt ngang một từ không
+        uint64_t read_begin = begin > 0 ? begin - 1 : begin;
+        uint64_t read_end = end < size ? end + 1 : end;
+        region->buffer = (char*)malloc((size_t)(read_end - read_begin) + 1);
+        CHECK_ALLOC(region->buffer, "Tạo bộ đệm cho dữ liệu giải nén");
+        result = seekable_read(seekable, read_begin, (size_t)(read_end - read_begin), (unsigned char*)region->buffer);
+        region->data = region->buffer + (begin - read_begin);
+        region->size = (size_t)(end - begin);
+        region->word_before = begin > read_begin && !is_token_delimiter(region->data[-1]);
+        region->word_after = read_end > end && !is_token_delimiter(region->data[region->size]);
+    }
+    seekable_close(seekable);
+    fclose(file);
+    if (result != 0) fprintf(stderr, "Lỗi: Không thể giải nén khoảng cần đọc của tệp '%s'\n", filename);
+    return result;
+}
+
+/**
+ * @brief Lấy khoảng dữ liệu (--bytes, --lines, hoặc cả tệp) của một tệp thường hoặc tệp nén vào bộ nhớ.
+ * Tệp thường được ánh xạ và chỉ dùng phần trong khoảng; tệp nén cần bảng tra vị trí (compress --seekable)
+ * khi có khoảng.
+ * @return 0 nếu thành công (giải phóng bằng free_file_region), -1 nếu không (đã in lỗi).
+ */
+static int load_file_region(const Config *config, const char *filename, FileRegion *region) {
+    memset(region, 0, sizeof(FileRegion));
+    region->first_line = 1;
+    if (is_compressed_file(filename)) {
+        if (load_compressed_region(config, filename, region) == 0) return 0;
+        free(region->buffer);
+        return -1;
+    }
+    if (map_file(filename, &region->mapped) != 0) {
+        fprintf(stderr, "Lỗi: Không thể ánh xạ tệp '%s'\n", filename);
+        return -1;
+    }
+    region->data = region->mapped.data;
+    region->size = region->mapped.size;
+    if (region->size == 0) return 0;
+
+    const char *begin = region->data;
+    const char *end = region->data + region->size;
+    if (config->range_mode == RANGE_BYTES) {
+        if (config->range_end < region->size) end = region->data + config->range_end;
+        begin = config->range_start < region->size ? region->data + config->range_start : end;
+        if (begin > end) begin = end;
+        region->first_line = 1 + count_newlines(region->data, begin);
+    } else if (config->range_mode == RANGE_LINES) {
+        begin = skip_lines(begin, end, config->range_start - 1);
+        if (config->range_end != UINT64_MAX) end = skip_lines(begin, end, config->range_end - config->range_start + 1);
+        region->first_line = (size_t)config->range_start;
+    }
+    region->word_before = begin > region->data && !is_token_delimiter(begin[-1]);
+    region->word_after = end < region->data + region->size && !is_token_delimiter(*end);
+    region->data = begin;
+    region->size = end - begin;
+    return 0;
 }
 
-/** @brief Đọc và in nội dung của tệp.
+static void free_file_region(FileRegion *region) {
+    if (region->buffer != NULL) free(region->buffer);
+    else unmap_file(&region->mapped);
+    memset(region, 0, sizeof(FileRegion));
+}
+
+/** @brief Đọc và in nội dung của tệp, hoặc chỉ khoảng --bytes/--lines.
+ * Tệp nén được giải nén khi in; với một khoảng, chỉ các khối phủ khoảng đó được giải nén.
  * @param file Con trỏ đến tệp cần đọc.
+ * @param config Cấu hình chứa tên tệp, khoảng cần đọc và số luồng.
+ * @return 0 nếu thành công, -1 nếu không đọc được tệp nén.
  */
-void perform_read(FILE *file) {
+int perform_read(FILE *file, const Config* config) {
+    if (is_compressed_file(config->input_filename)) {
+        FILE *compressed = fopen(config->input_filename, "rb");
+        if (compressed == NULL) {
+            fprintf(stderr, "Lỗi: Không thể mở tệp đầu vào '%s'\n", config->input_filename);
+            return -1;
+        }
+        int result;
+        if (config->range_mode == RANGE_NONE) {
+            // Cả tệp: giải nén tuần tự ra stdout, không cần bảng tra vị trí
+            CompressOptions options = { config->num_threads, 0, 0 };
+            printf("--- Nội dung của tệp ---\n");
+            fflush(stdout);
+            CompressionAlgorithm algo = ALG_UNKNOWN;
+            result = decompress_file(compressed, stdout, ALG_UNKNOWN, &options, &algo);
+            printf("\n------------------------\n");
+        } else {
+            FileRegion region;
+            result = load_file_region(config, config->input_filename, &region);
+            if (result == 0) {
+                printf("--- Nội dung của tệp ---\n");
+                fwrite(region.data, 1, region.size, stdout);
+                printf("\n------------------------\n");
+                free_file_region(&region);
+            }
+        }
+        fclose(compressed);
+        return result;
+    }
+
+    // Tệp thường (hoặc đầu vào chuẩn): đọc tuần tự, chỉ in phần nằm trong khoảng
     printf("--- Nội dung của tệp ---\n");
     int character;
-    while ((character = fgetc(file)) != EOF)
-        putchar(character);
+    uint64_t position = 0;
+    uint64_t line = 1;
+    while ((character = fgetc(file)) != EOF) {
+        if (config->range_mode == RANGE_BYTES) {
+            if (position >= config->range_end) break;
+            if (position >= config->range_start) putchar(character);
+        } else if (config->range_mode == RANGE_LINES) {
+            if (line > config->range_end) break;
+            if (line >= config->range_start) putchar(character);
+        } else {
+            putchar(character);
+        }
+        position++;
+        if (character == '\n') line++;
+    }
     printf("\n------------------------\n");
+    return 0;
 }
 
 /**
@@ -292,12 +943,14 @@ void perform_read(FILE *file) {
  * @param file Con trỏ đến tệp cần phân tích.
  * @param case_sensitive Chế độ phân biệt chữ hoa/thường.
  * @param sort_mode Chế độ sắp xếp kết quả.
+ * @param report_format Định dạng xuất (REPORT_TEXT là văn bản mô tả như cũ).
+ * @param stopwords Tập từ dừng bị loại trước khi chèn vào bảng băm (NULL nếu không lọc).
  * @param output_filename Tên tệp đầu ra (nếu có).
  */
-void perform_analysis(FILE *file, int case_sensitive, int sort_mode, const char* output_filename) {
+void perform_analysis(FILE *file, int case_sensitive, int sort_mode, ReportFormat report_format, const StopWordSet* stopwords, const char* output_filename) {
     FILE *output_stream = stdout; // Mặc định in ra console
     if (output_filename != NULL) {
-        output_stream = fopen(output_filename, "w");
+        output_stream = fopen(output_filename, report_format == REPORT_BIN ? "wb" : "w");
         if (output_stream == NULL) {
             printf("Lỗi: Không thể tạo tệp đầu ra '%s'\n", output_filename);
             return; // Thoát nếu không tạo được file
@@ -324,16 +977,20 @@ void perform_analysis(FILE *file, int case_sensitive, int sort_mode, const char*
         line_count++;
 
         // Tách từ đầu tiên trong dòng
-        char *token = strtok(line_buffer, " \t\n\r,.;:!?\"()"); // Các ký tự phân tách
+        char *cursor = line_buffer;
+        char *token = next_token(&cursor);
         while (token != NULL) {
             total_word_count++;
 
             if (!case_sensitive) {
                 to_lowercase(token);
             }
-            ht_insert(hash_table, token);
+            // Từ dừng bị loại ngay tại đây, trước khi tốn công chèn vào bảng băm
+            if (stopwords == NULL || !stopwords_contains(stopwords, token, strlen(token))) {
+                ht_insert(hash_table, token);
+            }
             // Tiếp tục tách các từ sau, bắt đầu sau từ hiện tại
-            token = strtok(NULL, " \t\n\r,.;:!?\"()");
+            token = next_token(&cursor);
         }
     }
     
@@ -342,6 +999,33 @@ void perform_analysis(FILE *file, int case_sensitive, int sort_mode, const char*
     WordStats *word_list = ht_to_array(hash_table, &unique_word_count);
     free_table(hash_table); // không cần bảng băm nữa
 
+    // --sort_mode
+    if (word_list != NULL) {
+        if (sort_mode == SORT_ALPHA)
+            qsort(word_list, unique_word_count, sizeof(WordStats), compare_alpha);
+        else if (sort_mode == SORT_LEN_DEC)
+            qsort(word_list, unique_word_count, sizeof(WordStats), compare_len_dec);
+        else if (sort_mode == SORT_LEN_ASC)
+            qsort(word_list, unique_word_count, sizeof(WordStats), compare_len_asc);
+    }
+
+    // --- Xuất dạng máy đọc: toàn bộ danh sách từ qua bộ ghi có bộ đệm ---
+    if (report_format != REPORT_TEXT) {
+#ifdef _WIN32
+        if (output_stream == stdout && report_format == REPORT_BIN) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        ReportSummary summary = {char_count, total_word_count, unique_word_count, line_count};
+        if (write_analysis_report(output_stream, report_format, &summary, word_list, unique_word_count) != 0) {
+            fprintf(stderr, "Lỗi: Ghi báo cáo thất bại.\n");
+        }
+
+        for (int i = 0; i < unique_word_count; i++)
+            free(word_list[i].word);
+        free(word_list);
+        if (output_stream != stdout) fclose(output_stream);
+        return;
+    }
+
     if (word_list == NULL) {
         fprintf(output_stream, "Không có từ nào trong tệp.\n");
         if (output_stream != stdout) fclose(output_stream);
@@ -353,14 +1037,6 @@ void perform_analysis(FILE *file, int case_sensitive, int sort_mode, const char*
     fprintf(output_stream, "Số từ (tổng cộng): %ld\n", total_word_count);
     fprintf(output_stream, "Số từ (duy nhất): %d\n", unique_word_count);
     fprintf(output_stream, "Số dòng: %d\n", line_count);
-    
-    // --sort_mode 
-    if (sort_mode == SORT_ALPHA) 
-        qsort(word_list, unique_word_count, sizeof(WordStats), compare_alpha);
-    else if (sort_mode == SORT_LEN_DEC)
-        qsort(word_list, unique_word_count, sizeof(WordStats), compare_len_dec);
-    else if (sort_mode == SORT_LEN_ASC)
-        qsort(word_list, unique_word_count, sizeof(WordStats), compare_len_asc);
 
     // Tính toán độ dài min/max và tần suất min/max
     size_t max_len = strlen(word_list[0].word);
@@ -417,82 +1093,1139 @@ void perform_analysis(FILE *file, int case_sensitive, int sort_mode, const char*
 }
 
 /**
- * @brief Tìm kiếm một từ trong tệp và in kết quả.
- * @param file Con trỏ đến tệp cần tìm kiếm.
- * @param case_sensitive Chế độ phân biệt chữ hoa/thường.
- * @param exact_match Chế độ tìm kiếm khớp chính xác hay chuỗi con.
- * @param word_to_find Từ cần tìm.
- * @param output_filename Tên tệp đầu ra (nếu có).
+ * @brief Hàm so sánh cho qsort trên mảng Entry*, sắp xếp theo số lần xuất hiện (giảm dần).
  */
-void perform_find(FILE *file, int case_sensitive, int exact_match, const char *word_to_find, const char *output_filename) {
-    FILE *output_stream = stdout; // Mặc định in ra console
-    if (output_filename != NULL) {
-        output_stream = fopen(output_filename, "w");
-        if (output_stream == NULL) {
-            printf("Lỗi: Không thể tạo tệp đầu ra '%s'\n", output_filename);
-            return; // Thoát nếu không tạo được file
+static int compare_entry_count_dec(const void *a, const void *b) {
+    const Entry *ea = *(const Entry* const*)a;
+    const Entry *eb = *(const Entry* const*)b;
+    return (eb->count > ea->count) - (eb->count < ea->count);
+}
+
+/**
+ * @brief In top_count từ xuất hiện nhiều nhất trong cửa sổ, dùng min-heap kích thước top_count
+ * nên chỉ duyệt bảng băm một lần và không cần sắp xếp toàn bộ.
+ */
+static void print_top_words(HashTable* window, int top_count, int window_minutes) {
+    Entry** heap = (Entry**)malloc(top_count * sizeof(Entry*));
+    CHECK_ALLOC(heap, "Tạo heap cho chế độ theo dõi");
+    int heap_size = 0;
+
+    for (int i = 0; i < window->size; i++) {
+        for (Entry* entry = window->entries[i]; entry != NULL; entry = entry->next) {
+            int pos;
+            if (heap_size < top_count) {
+                // Thêm vào cuối rồi đẩy lên
+                pos = heap_size++;
+                while (pos > 0 && heap[(pos - 1) / 2]->count > entry->count) {
+                    heap[pos] = heap[(pos - 1) / 2];
+                    pos = (pos - 1) / 2;
+                }
+                heap[pos] = entry;
+            } else if (entry->count > heap[0]->count) {
+                // Thay gốc (nhỏ nhất) rồi đẩy xuống
+                pos = 0;
+                for (;;) {
+                    int child = 2 * pos + 1;
+                    if (child >= heap_size) break;
+                    if (child + 1 < heap_size && heap[child + 1]->count < heap[child]->count) child++;
+                    if (heap[child]->count >= entry->count) break;
+                    heap[pos] = heap[child];
+                    pos = child;
+                }
+                heap[pos] = entry;
+            }
         }
-        printf("Đã ghi kết quả vào tệp: %s\n", output_filename);
     }
+    qsort(heap, heap_size, sizeof(Entry*), compare_entry_count_dec);
+
+    char time_buffer[16];
+    time_t now = time(NULL);
+    strftime(time_buffer, sizeof(time_buffer), "%H:%M:%S", localtime(&now));
+    printf("--- Top %d từ trong %d phút qua (%s) ---\n", top_count, window_minutes, time_buffer);
+    for (int i = 0; i < heap_size; i++) {
+        printf("  %2d. %s (%d lần)\n", i + 1, heap[i]->word, heap[i]->count);
+    }
+    if (heap_size == 0) printf("  (chưa có từ nào)\n");
+    fflush(stdout);
+    free(heap);
+}
 
-    // --- Tìm kiếm từ trong tệp ---
-    char line_buffer[2048];
-    int found = 0;
+// Được đặt bởi bộ xử lý Ctrl+C để vòng lặp của --follow dừng lại và giải phóng bộ nhớ
+static volatile sig_atomic_t g_follow_stop = 0;
 
-    // Chuyển đổi từ cần tìm sang chữ thường nếu không phân biệt hoa/thường
-    char *keyword_to_find = strdup(word_to_find);
-    if (!case_sensitive) to_lowercase(keyword_to_find);
+static void follow_handle_signal(int signal_number) {
+    (void)signal_number;
+    g_follow_stop = 1;
+}
 
-    rewind(file); // Đặt con trỏ tệp về đầu để đọc lại
-    while (fgets(line_buffer, sizeof(line_buffer), file) != NULL) {
-        if (exact_match) {
-            // --- LOGIC TÌM TỪ KHỚP CHÍNH XÁC (strtok) ---
-            char *line_copy = strdup(line_buffer);
-            char *token = strtok(line_copy, " \t\n\r,.;:!?\"()");
-            while (token != NULL) {
-                char* word_to_compare = token;
-                char* temp_token_copy = NULL;
-
-                if (!case_sensitive) {
-                    temp_token_copy = strdup(token);
-                    to_lowercase(temp_token_copy);
-                    word_to_compare = temp_token_copy;
+/**
+ * @brief Kiểm tra đường dẫn có còn trỏ tới tệp đang mở không. Log bị xoay vòng bằng cách đổi tên rồi
+ * tạo tệp mới cùng tên: tệp đang mở sẽ không được ghi thêm nữa.
+ * Trên Windows tệp đang mở bằng fopen không đổi tên được, nên chỉ có kiểu cắt ngắn (xử lý theo kích thước).
+ * @return 0 nếu đường dẫn đã là một tệp khác, 1 nếu vẫn là tệp đó hoặc không kiểm tra được (ví dụ tệp mới chưa được tạo).
+ */
+static int follow_same_file(FILE *file, const char *path) {
+#ifdef _WIN32
+    (void)file;
+    (void)path;
+    return 1;
+#else
+    struct stat opened, named;
+    if (fstat(fileno(file), &opened) != 0 || stat(path, &named) != 0) return 1;
+    return opened.st_dev == named.st_dev && opened.st_ino == named.st_ino;
+#endif
+}
+
+/**
+ * @brief Đếm các từ của một dòng (kết thúc bằng '\0') vào khung hiện tại và vào cửa sổ.
+ * @return 1 nếu có từ được đếm, 0 nếu không.
+ */
+static int follow_count_line(char *line, const Config *config, const StopWordSet *stopwords, HashTable *bucket, HashTable *window) {
+    int counted = 0;
+    char *cursor = line;
+    char *token;
+    while ((token = next_token(&cursor)) != NULL) {
+        if (!config->case_sensitive) to_lowercase(token);
+        if (stopwords != NULL && stopwords_contains(stopwords, token, strlen(token))) continue;
+        ht_insert(bucket, token);
+        ht_insert(window, token);
+        counted = 1;
+    }
+    return counted;
+}
+
+/**
+ * @brief Theo dõi một tệp đang được ghi thêm (ví dụ log) và liên tục cập nhật số lần xuất hiện.
+ * Mỗi khung thời gian có bảng băm riêng; bảng "window" là tổng của các khung còn trong cửa sổ.
+ * Khi một khung hết hạn, số đếm của nó được trừ khỏi window và bảng của nó được giải phóng,
+ * nên bộ nhớ chỉ phụ thuộc vào dữ liệu trong cửa sổ và không cần quét lại tệp.
+ * Dữ liệu mới được phát hiện bằng cách thăm dò kích thước tệp mỗi FOLLOW_POLL_MS thay vì inotify:
+ * cách này chạy giống nhau trên Windows (không có inotify) và với tệp trên ổ mạng (inotify không báo
+ * thay đổi do máy khác ghi), còn độ trễ 200 ms là đủ cho việc xem log.
+ * Tệp bị cắt ngắn được đọc lại từ đầu; tệp bị xoay vòng (đường dẫn trỏ tới tệp mới)
+ * được đọc hết phần còn lại rồi mở tệp mới từ đầu. Ctrl+C dừng vòng lặp và giải phóng toàn bộ bộ nhớ.
+ * @param file Tệp đầu vào đã mở ở chế độ nhị phân. Chỉ dữ liệu ghi thêm sau khi bắt đầu mới được đếm.
+ * @param config Cấu hình (input_filename, case_sensitive, window_minutes, bucket_seconds, top_count).
+ * @param stopwords Tập từ dừng (NULL nếu không lọc).
+ * @return 0 khi dừng bằng Ctrl+C, -1 nếu không đọc được tệp.
+ */
+int perform_follow(FILE *file, const Config* config, const StopWordSet* stopwords) {
+    int num_buckets = (config->window_minutes * 60 + config->bucket_seconds - 1) / config->bucket_seconds;
+    if (num_buckets < 1) num_buckets = 1;
+
+    HashTable** buckets = (HashTable**)calloc(num_buckets, sizeof(HashTable*));
+    long long* bucket_epochs = (long long*)malloc(num_buckets * sizeof(long long));
+    CHECK_ALLOC(buckets, "Tạo các khung thời gian");
+    CHECK_ALLOC(bucket_epochs, "Tạo các khung thời gian");
+    for (int i = 0; i < num_buckets; i++) bucket_epochs[i] = -1;
+    HashTable* window = create_table(HASH_TABLE_SIZE);
+
+    size_t pending_capacity = FOLLOW_READ_CHUNK * 2;
+    size_t pending_length = 0;
+    char* pending = (char*)malloc(pending_capacity + 1);
+    CHECK_ALLOC(pending, "Tạo bộ đệm dòng cho chế độ theo dõi");
+    char chunk[FOLLOW_READ_CHUNK];
+
+    // Bắt đầu từ cuối tệp, giống "tail -f"
+    int result = 0;
+    FILE* current = file; // Tệp đang đọc; khác file sau khi log bị xoay vòng
+    long long offset = -1;
+    if (file_seek64(current, 0, SEEK_END) == 0) offset = file_tell64(current);
+    if (offset < 0) {
+        fprintf(stderr, "Lỗi: Không xác định được kích thước tệp '%s'\n", config->input_filename);
+        result = -1;
+    }
+    char tail[FOLLOW_TAIL_CHECK]; // Các byte ngay trước offset, như đã đọc được
+    size_t tail_length = 0;
+    int dirty = 1;
+    time_t last_report = 0;
+
+    g_follow_stop = 0;
+    signal(SIGINT, follow_handle_signal);
+    if (result == 0) {
+        printf("Đang theo dõi '%s' (cửa sổ %d phút, khung %d giây). Nhấn Ctrl+C để dừng.\n",
+               config->input_filename, config->window_minutes, config->bucket_seconds);
+    }
+
+    while (result == 0 && !g_follow_stop) {
+        time_t now = time(NULL);
+        long long epoch = (long long)now / config->bucket_seconds;
+
+        // 1. Trừ các khung đã ra khỏi cửa sổ
+        for (int i = 0; i < num_buckets; i++) {
+            if (buckets[i] == NULL || bucket_epochs[i] > epoch - num_buckets) continue;
+            HashTable* expired = buckets[i];
+            for (int j = 0; j < expired->size; j++) {
+                for (Entry* entry = expired->entries[j]; entry != NULL; entry = entry->next) {
+                    ht_add(window, entry->word, -entry->count);
+                    dirty = 1;
                 }
+            }
+            free_table(expired);
+            buckets[i] = NULL;
+            bucket_epochs[i] = -1;
+        }
+        int slot = (int)(epoch % num_buckets);
+        if (buckets[slot] == NULL) {
+            buckets[slot] = create_table(FOLLOW_BUCKET_TABLE_SIZE);
+            bucket_epochs[slot] = epoch;
+        }
 
-                if (strcmp(word_to_compare, keyword_to_find) == 0) {
-                    fprintf(output_stream, "Tìm thấy từ '%s' trong dòng: %s", word_to_find, line_buffer);
-                    found++;
-                    free(temp_token_copy); // Giải phóng ở đây
-                    free(line_copy);       // Và giải phóng line_copy
-                    goto next_line;        // Nhảy ra ngoài để tránh break 2 lớp
+        // 2. Đọc phần dữ liệu mới được ghi thêm
+        long long size = -1;
+        if (file_seek64(current, 0, SEEK_END) == 0) size = file_tell64(current);
+        if (size < 0) {
+            fprintf(stderr, "Lỗi: Không xác định được kích thước tệp '%s'\n", config->input_filename);
+            result = -1;
+            break;
+        }
+        // Tệp bị cắt ngắn (ví dụ logrotate copytruncate) rồi có thể đã được ghi tiếp vượt vị trí cũ:
+        // nhận ra khi nhỏ hơn vị trí đã đọc, hoặc khi các byte ngay trước vị trí đó đã khác đi
+        int truncated = size < offset;
+        if (!truncated && tail_length > 0) {
+            char check[FOLLOW_TAIL_CHECK];
+            if (file_seek64(current, offset - (long long)tail_length, SEEK_SET) != 0 ||
+                fread(check, 1, tail_length, current) != tail_length) {
+                truncated = 1;
+            } else {
+                truncated = memcmp(check, tail, tail_length) != 0;
+            }
+        }
+        if (truncated) {
+            // Đọc lại từ đầu, bỏ phần dòng dở dang của nội dung cũ
+            offset = 0;
+            tail_length = 0;
+            pending_length = 0;
+        }
+        if (size > offset) {
+            if (file_seek64(current, offset, SEEK_SET) != 0) {
+                fprintf(stderr, "Lỗi: Không di chuyển được tới vị trí %lld của tệp '%s'\n", offset, config->input_filename);
+                result = -1;
+                break;
+            }
+            size_t bytes_read;
+            while ((bytes_read = fread(chunk, 1, sizeof(chunk), current)) > 0) {
+                offset += bytes_read;
+                // Giữ FOLLOW_TAIL_CHECK byte cuối đã đọc
+                if (bytes_read >= FOLLOW_TAIL_CHECK) {
+                    tail_length = FOLLOW_TAIL_CHECK;
+                    memcpy(tail, chunk + bytes_read - FOLLOW_TAIL_CHECK, FOLLOW_TAIL_CHECK);
+                } else {
+                    size_t keep = tail_length + bytes_read > FOLLOW_TAIL_CHECK ? FOLLOW_TAIL_CHECK - bytes_read : tail_length;
+                    memmove(tail, tail + tail_length - keep, keep);
+                    memcpy(tail + keep, chunk, bytes_read);
+                    tail_length = keep + bytes_read;
+                }
+                if (pending_length + bytes_read > pending_capacity) {
+                    pending_capacity = (pending_length + bytes_read) * 2;
+                    pending = (char*)realloc(pending, pending_capacity + 1);
+                    CHECK_ALLOC(pending, "Mở rộng bộ đệm dòng");
+                }
+                memcpy(pending + pending_length, chunk, bytes_read);
+                pending_length += bytes_read;
+
+                // Chỉ xử lý các dòng đã hoàn chỉnh; phần dòng dở dang chờ lần đọc sau
+                char* line_start = pending;
+                char* newline;
+                while ((newline = (char*)memchr(line_start, '\n', pending + pending_length - line_start)) != NULL) {
+                    *newline = '\0';
+                    if (follow_count_line(line_start, config, stopwords, buckets[slot], window)) dirty = 1;
+                    line_start = newline + 1;
                 }
-                free(temp_token_copy); // Giải phóng nếu không khớp
-                token = strtok(NULL, " \t\n\r,.;:!?\"()");
+                pending_length -= line_start - pending;
+                memmove(pending, line_start, pending_length);
             }
-            free(line_copy);
-            next_line:; // Nhãn để goto
+            if (ferror(current)) {
+                fprintf(stderr, "Lỗi: Không đọc được tệp '%s'\n", config->input_filename);
+                result = -1;
+                break;
+            }
+        }
 
-        } else {
-            // --- LOGIC TÌM CHUỖI CON (strstr) ---
-            char *search_target = line_buffer;
-            char *temp_line_copy = NULL;
-            if (!case_sensitive) {
-                temp_line_copy = strdup(line_buffer);
-                to_lowercase(temp_line_copy);
-                search_target = temp_line_copy;
+        // 3. Log bị xoay vòng: tệp cũ đã được đọc hết ở bước 2 nên chuyển sang tệp mới, đọc từ đầu
+        if (!follow_same_file(current, config->input_filename)) {
+            FILE* reopened = fopen(config->input_filename, "rb");
+            if (reopened != NULL) {
+                // Dòng cuối của tệp cũ không có '\n' sẽ không bao giờ được hoàn chỉnh nữa
+                if (pending_length > 0) {
+                    pending[pending_length] = '\0';
+                    if (follow_count_line(pending, config, stopwords, buckets[slot], window)) dirty = 1;
+                    pending_length = 0;
+                }
+                if (current != file) fclose(current);
+                current = reopened;
+                offset = 0;
+                tail_length = 0;
+            }
+        }
+
+        // 4. Cập nhật màn hình tối đa mỗi giây một lần, và chỉ khi có thay đổi
+        if (dirty && now != last_report) {
+            print_top_words(window, config->top_count, config->window_minutes);
+            last_report = now;
+            dirty = 0;
+        }
+#ifdef _WIN32
+        Sleep(FOLLOW_POLL_MS);
+#else
+        usleep(FOLLOW_POLL_MS * 1000);
+#endif
+    }
+    signal(SIGINT, SIG_DFL);
+    if (result == 0) printf("Đã dừng theo dõi '%s'.\n", config->input_filename);
+
+    if (current != file) fclose(current);
+    for (int i = 0; i < num_buckets; i++) {
+        if (buckets[i] != NULL) free_table(buckets[i]);
+    }
+    free(buckets);
+    free(bucket_epochs);
+    free_table(window);
+    free(pending);
+    return result;
+}
+
+// Một từ cùng điểm TF-IDF của nó trong một tài liệu
+typedef struct {
+    char *word;
+    int count;
+    double score;
+} TermScore;
+
+// Kết quả gọn của một tài liệu: chỉ giữ top_count từ, không giữ toàn bộ từ vựng
+typedef struct {
+    const char *filename;
+    int ok;
+    long total_terms;
+    int unique_terms;
+    TermScore *top;
+    int top_size;
+} CorpusDocument;
+
+// Dữ liệu dùng chung cho các tác vụ song song của lệnh 'corpus'
+typedef struct {
+    const Config *config;
+    const StopWordSet *stopwords;
+    CorpusDocument *documents;
+    HashTable **worker_df;             // Lượt 1: tần suất tài liệu riêng của từng luồng
+    const HashTable *document_frequency; // Lượt 2: tần suất tài liệu toàn cục (chỉ đọc)
+    int num_valid_documents;
+} CorpusContext;
+
+/**
+ * @brief Đếm số lần xuất hiện của từng từ trong một tài liệu, bằng cùng bộ tách từ với 'analyst'.
+ * @param total_terms Nhận tổng số từ đã đếm (sau khi lọc từ dừng).
+ * @return Bảng băm các từ, hoặc NULL nếu không mở được tệp.
+ */
+static HashTable* count_document_terms(const char *filename, int case_sensitive, const StopWordSet *stopwords, long *total_terms) {
+    FILE *file = fopen(filename, "r");
+    if (file == NULL) return NULL;
+
+    HashTable *table = create_table(HASH_TABLE_SIZE);
+    char line_buffer[2048];
+    *total_terms = 0;
+    while (fgets(line_buffer, sizeof(line_buffer), file) != NULL) {
+        char *cursor = line_buffer;
+        char *token;
+        while ((token = next_token(&cursor)) != NULL) {
+            if (!case_sensitive) to_lowercase(token);
+            if (stopwords != NULL && stopwords_contains(stopwords, token, strlen(token))) continue;
+            ht_insert(table, token);
+            (*total_terms)++;
+        }
+    }
+    fclose(file);
+    return table;
+}
+
+/**
+ * @brief Lượt 1: đếm từ của một tài liệu và cộng 1 vào tần suất tài liệu của mỗi từ
+ * (bảng riêng của luồng, không cần khóa). Bảng của tài liệu được giải phóng ngay.
+ */
+static void corpus_count_task(void *context, int index, int worker) {
+    CorpusContext *ctx = (CorpusContext*)context;
+    CorpusDocument *doc = &ctx->documents[index];
+
+    HashTable *table = count_document_terms(doc->filename, ctx->config->case_sensitive, ctx->stopwords, &doc->total_terms);
+    if (table == NULL) return;
+    doc->ok = 1;
+    for (int i = 0; i < table->size; i++) {
+        for (Entry *entry = table->entries[i]; entry != NULL; entry = entry->next) {
+            ht_insert(ctx->worker_df[worker], entry->word);
+            doc->unique_terms++;
+        }
+    }
+    free_table(table);
+}
+
+/**
+ * @brief Lượt 2: đếm lại tài liệu, tính TF-IDF và chỉ giữ top_count từ bằng min-heap.
+ */
+static void corpus_rank_task(void *context, int index, int worker) {
+    (void)worker;
+    CorpusContext *ctx = (CorpusContext*)context;
+    CorpusDocument *doc = &ctx->documents[index];
+    if (!doc->ok) return;
+
+    long total_terms = 0;
+    HashTable *table = count_document_terms(doc->filename, ctx->config->case_sensitive, ctx->stopwords, &total_terms);
+    if (table == NULL || total_terms == 0) {
+        if (table != NULL) free_table(table);
+        return;
+    }
+
+    int capacity = ctx->config->top_count;
+    TermScore *heap = (TermScore*)malloc(capacity * sizeof(TermScore));
+    CHECK_ALLOC(heap, "Tạo heap TF-IDF");
+    int heap_size = 0;
+
+    for (int i = 0; i < table->size; i++) {
+        for (Entry *entry = table->entries[i]; entry != NULL; entry = entry->next) {
+            Entry *df_entry = ht_lookup(ctx->document_frequency, entry->word);
+            int df = df_entry != NULL ? df_entry->count : 1;
+            double score = ((double)entry->count / total_terms) * log((double)ctx->num_valid_documents / df);
+            if (score <= 0.0) continue; // Từ có trong mọi tài liệu không mang tính đặc trưng
+            if (heap_size == capacity && score <= heap[0].score) continue;
+
+            TermScore item = {entry->word, entry->count, score};
+            int pos;
+            if (heap_size < capacity) {
+                pos = heap_size++;
+                while (pos > 0 && heap[(pos - 1) / 2].score > score) {
+                    heap[pos] = heap[(pos - 1) / 2];
+                    pos = (pos - 1) / 2;
+                }
+            } else {
+                pos = 0;
+                for (;;) {
+                    int child = 2 * pos + 1;
+                    if (child >= heap_size) break;
+                    if (child + 1 < heap_size && heap[child + 1].score < heap[child].score) child++;
+                    if (heap[child].score >= score) break;
+                    heap[pos] = heap[child];
+                    pos = child;
+                }
+            }
+            heap[pos] = item;
+        }
+    }
+
+    // Sao chép các từ được giữ lại trước khi giải phóng bảng của tài liệu
+    for (int i = 0; i < heap_size; i++) heap[i].word = strdup(heap[i].word);
+    free_table(table);
+    doc->top = heap;
+    doc->top_size = heap_size;
+}
+
+/**
+ * @brief Hàm so sánh cho qsort, sắp xếp TermScore theo điểm (giảm dần).
+ */
+static int compare_score_dec(const void *a, const void *b) {
+    const TermScore *ta = (const TermScore*)a;
+    const TermScore *tb = (const TermScore*)b;
+    return (tb->score > ta->score) - (tb->score < ta->score);
+}
+
+/**
+ * @brief Phân tích một tập tài liệu: tần suất tài liệu toàn cục và các từ đặc trưng (TF-IDF) của mỗi tệp.
+ * Lượt 1 đếm song song từng tài liệu và chỉ giữ lại tần suất tài liệu (gộp từ bảng riêng của mỗi luồng).
+ * Lượt 2 đếm lại song song, mỗi tài liệu chỉ giữ top_count từ, nên không bao giờ giữ từ vựng
+ * đầy đủ của mọi tài liệu cùng lúc.
+ * @param config Cấu hình chứa danh sách tệp, số luồng và các tùy chọn tách từ.
+ * @return 0 nếu thành công, -1 nếu thất bại.
+ */
+int perform_corpus(const Config* config) {
+    StopWordSet *stopwords = NULL;
+    if (config->stopwords_source != NULL) {
+        stopwords = stopwords_create(config->stopwords_source);
+        if (stopwords == NULL) {
+            fprintf(stderr, "Lỗi: Không thể tải danh sách từ dừng '%s'\n", config->stopwords_source);
+            return -1;
+        }
+    }
+
+    FILE *output_stream = stdout;
+    if (config->output_filename != NULL) {
+        output_stream = fopen(config->output_filename, "w");
+        if (output_stream == NULL) {
+            fprintf(stderr, "Lỗi: Không thể tạo tệp đầu ra '%s'\n", config->output_filename);
+            stopwords_free(stopwords);
+            return -1;
+        }
+        printf("Đã ghi kết quả vào tệp: %s\n", config->output_filename);
+    }
+
+    ThreadPool *pool = threadpool_create(config->num_threads);
+    CHECK_ALLOC(pool, "Tạo nhóm luồng");
+    int num_workers = threadpool_size(pool);
+
+    CorpusContext ctx;
+    ctx.config = config;
+    ctx.stopwords = stopwords;
+    ctx.documents = (CorpusDocument*)calloc(config->input_count, sizeof(CorpusDocument));
+    ctx.worker_df = (HashTable**)malloc(num_workers * sizeof(HashTable*));
+    CHECK_ALLOC(ctx.documents, "Tạo danh sách tài liệu");
+    CHECK_ALLOC(ctx.worker_df, "Tạo bảng tần suất tài liệu");
+    for (int i = 0; i < config->input_count; i++) ctx.documents[i].filename = config->input_files[i];
+    for (int w = 0; w < num_workers; w++) ctx.worker_df[w] = create_table(HASH_TABLE_SIZE);
+
+    // --- Lượt 1: tần suất tài liệu ---
+    threadpool_run(pool, config->input_count, corpus_count_task, &ctx);
+
+    HashTable *document_frequency = create_table(HASH_TABLE_SIZE);
+    for (int w = 0; w < num_workers; w++) {
+        HashTable *table = ctx.worker_df[w];
+        for (int i = 0; i < table->size; i++) {
+            for (Entry *entry = table->entries[i]; entry != NULL; entry = entry->next) {
+                ht_add(document_frequency, entry->word, entry->count);
+            }
+        }
+        free_table(table);
+    }
+    free(ctx.worker_df);
+    ctx.worker_df = NULL;
+
+    ctx.num_valid_documents = 0;
+    for (int i = 0; i < config->input_count; i++) {
+        if (ctx.documents[i].ok) ctx.num_valid_documents++;
+        else fprintf(stderr, "Cảnh báo: Bỏ qua tệp không mở được '%s'\n", ctx.documents[i].filename);
+    }
+
+    // --- Lượt 2: xếp hạng TF-IDF ---
+    ctx.document_frequency = document_frequency;
+    threadpool_run(pool, config->input_count, corpus_rank_task, &ctx);
+    threadpool_destroy(pool);
+
+    // --- In kết quả theo thứ tự tệp đầu vào ---
+    int vocabulary_size = 0;
+    for (int i = 0; i < document_frequency->size; i++) {
+        for (Entry *entry = document_frequency->entries[i]; entry != NULL; entry = entry->next) vocabulary_size++;
+    }
+    fprintf(output_stream, "--- Thống kê tập tài liệu ---\n");
+    fprintf(output_stream, "Số tài liệu: %d\n", ctx.num_valid_documents);
+    fprintf(output_stream, "Số từ (duy nhất, toàn tập): %d\n", vocabulary_size);
+
+    for (int i = 0; i < config->input_count; i++) {
+        CorpusDocument *doc = &ctx.documents[i];
+        if (!doc->ok) continue;
+        fprintf(output_stream, "\n--- %s (%ld từ, %d từ duy nhất) ---\n", doc->filename, doc->total_terms, doc->unique_terms);
+        qsort(doc->top, doc->top_size, sizeof(TermScore), compare_score_dec);
+        for (int j = 0; j < doc->top_size; j++) {
+            Entry *df_entry = ht_lookup(document_frequency, doc->top[j].word);
+            fprintf(output_stream, "  %2d. %-20s tf-idf=%.5f  (%d lần, có trong %d/%d tệp)\n", j + 1, doc->top[j].word,
+                    doc->top[j].score, doc->top[j].count, df_entry != NULL ? df_entry->count : 0, ctx.num_valid_documents);
+            free(doc->top[j].word);
+        }
+        if (doc->top_size == 0) fprintf(output_stream, "  (không có từ đặc trưng)\n");
+        free(doc->top);
+    }
+
+    free(ctx.documents);
+    free_table(document_frequency);
+    stopwords_free(stopwords);
+    if (output_stream != stdout) fclose(output_stream);
+    return 0;
+}
+
+// Truy vấn tìm kiếm đã được chuẩn bị cho lệnh 'find'
+typedef struct {
+    int case_sensitive;
+    int exact_match;
+    size_t keyword_length;
+    int keyword_is_token;  // 0 nếu từ khóa chứa ký tự phân tách, khi đó --match không thể khớp
+    SearchPattern pattern; // Mẫu chuỗi con đã biên dịch
+    Regex *regex;          // Biểu thức chính quy (--regex), NULL nếu không dùng
+    FuzzyPattern *fuzzy;   // Mẫu tìm gần đúng (--fuzzy), NULL nếu không dùng
+} FindQuery;
+
+/**
+ * @brief Giải phóng các thành phần của truy vấn (an toàn với thành phần chưa được tạo).
+ */
+static void free_find_query(FindQuery *query) {
+    search_free(&query->pattern);
+    regex_free(query->regex);
+    if (query->fuzzy != NULL) fuzzy_free(query->fuzzy);
+    free(query->fuzzy);
+}
+
+/**
+ * @brief Tìm lần xuất hiện tiếp theo của từ khóa dưới dạng một từ trọn vẹn (tách từ như 'analyst').
+ * So khớp chuỗi con (đã gộp hoa/thường) ngay trên vùng nhớ rồi kiểm tra hai biên bằng bảng ký tự
+ * phân tách, nên không cần sao chép dòng hay từng từ.
+ * @param p Đầu một dòng, hoặc đầu khoảng --bytes; byte ngay trước p là biên từ trừ khi word_before.
+ * @param word_before, word_after Từ tiếp diễn qua p / end ra ngoài khoảng đang tìm (FileRegion),
+ * nên p / end không phải biên từ.
+ * @return Vị trí đầu từ khớp, hoặc NULL nếu không còn.
+ */
+static const char* find_exact_word(const FindQuery *query, const char *p, const char *end, int word_before, int word_after) {
+    if (!query->keyword_is_token) return NULL;
+    const char *from = p;
+    const char *hit;
+    while ((hit = search_next(&query->pattern, from, end)) != NULL) {
+        const char *hit_end = hit + query->keyword_length;
+        if ((hit == p ? !word_before : is_token_delimiter(hit[-1])) &&
+            (hit_end == end ? !word_after : is_token_delimiter(*hit_end))) {
+            return hit;
+        }
+        from = hit + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tìm dòng khớp tiếp theo trong [p, end), với p luôn là đầu một dòng (hoặc đầu khoảng --bytes).
+ * Chế độ chuỗi con và --match quét thẳng trên vùng nhớ ánh xạ và chỉ xác định biên của dòng chứa kết quả.
+ * @param word_before, word_after Như find_exact_word (chỉ dùng cho --match).
+ * @param line_start, line_end Nhận biên của dòng khớp (line_end trỏ vào '\n' hoặc end).
+ * @return 1 nếu tìm thấy, 0 nếu không.
+ */
+static int find_next_line(const FindQuery *query, const char *p, const char *end, int word_before, int word_after,
+                          const char **line_start, const char **line_end) {
+    if (query->regex != NULL) {
+        return regex_find_line(query->regex, p, end, line_start, line_end);
+    }
+    if (query->fuzzy != NULL) {
+        return fuzzy_find_line(query->fuzzy, p, end, line_start, line_end);
+    }
+    const char *hit = query->exact_match ? find_exact_word(query, p, end, word_before, word_after)
+                                         : search_next(&query->pattern, p, end);
+    if (hit == NULL) return 0;
+    const char *ls = hit;
+    while (ls > p && ls[-1] != '\n') ls--;
+    const char *newline = (const char*)memchr(hit, '\n', end - hit);
+    *line_start = ls;
+    *line_end = newline != NULL ? newline : end;
+    return 1;
+}
+
+/**
+ * @brief In một dòng kết quả (bỏ '\r' cuối dòng của tệp CRLF).
+ */
+static void print_found_line(FILE *output_stream, const char *word_to_find, int line_number, const char *line_start, const char *line_end) {
+    if (line_end > line_start && line_end[-1] == '\r') line_end--;
+    fprintf(output_stream, "Tìm thấy từ '%s' trong dòng %d: ", word_to_find, line_number);
+    fwrite(line_start, 1, line_end - line_start, output_stream);
+    fputc('\n', output_stream);
+}
+
+// Một dòng khớp trong một đoạn tệp
+typedef struct {
+    const char *line_start;
+    const char *line_end;
+    size_t line_offset; // Số dòng tính từ đầu đoạn (0 = dòng đầu tiên của đoạn)
+} FoundRange;
+
+// Một đoạn tệp (bắt đầu ở đầu dòng, kết thúc sau '\n') và kết quả tìm kiếm trong đó
+typedef struct {
+    const char *begin;
+    const char *end;
+    int word_before;      // Đoạn bắt đầu/kết thúc ở biên khoảng --bytes cắt ngang một từ (FileRegion)
+    int word_after;
+    size_t newline_count; // Số '\n' trong đoạn, dùng để tính số dòng tuyệt đối bằng tổng tiền tố
+    FoundRange *hits;
+    int hit_count;
+    int hit_capacity;
+} FindChunk;
+
+// Dữ liệu dùng chung cho các tác vụ tìm kiếm trong một đợt
+typedef struct {
+    const Config *config;
+    FindQuery query;
+    ThreadPool *pool;   // NULL cho đến khi gặp tệp lớn hơn một đoạn (và -j khác 1)
+    int num_workers;
+    int batch_size;     // Số đoạn mỗi đợt
+    FindQuery *queries; // Mỗi luồng một bản (bộ nhớ đệm DFA của --regex không dùng chung được)
+    FindChunk *chunks;  // Các đoạn của đợt hiện tại
+    int hit_limit;      // Số dòng khớp tối đa cần tìm trong một tệp (0 = không giới hạn)
+    int store_hits;     // 0 khi chỉ cần đếm (--count, --files-with-matches): không ghi nhận dòng, không đếm số dòng
+} FindBatchContext;
+
+/**
+ * @brief Tìm các dòng khớp trong một đoạn; số dòng được đếm lười như khi tìm tuần tự,
+ * phần còn lại của đoạn được đếm sau cùng để có tổng số '\n' của đoạn.
+ * Dừng ngay khi đoạn đã có đủ hit_limit dòng, vì khi đó tệp chắc chắn đã đủ kết quả.
+ */
+static void find_chunk_task(void *context, int index, int worker) {
+    FindBatchContext *ctx = (FindBatchContext*)context;
+    const FindQuery *query = &ctx->queries[worker];
+    FindChunk *chunk = &ctx->chunks[index];
+
+    const char *p = chunk->begin;
+    const char *counted_upto = p;
+    size_t line_offset = 0;
+    const char *line_start, *line_end;
+    chunk->hit_count = 0;
+
+    while (p < chunk->end && find_next_line(query, p, chunk->end, p == chunk->begin && chunk->word_before,
+                                            chunk->word_after, &line_start, &line_end)) {
+        p = line_end + 1; // Mỗi dòng chỉ được ghi nhận một lần
+        if (!ctx->store_hits) {
+            if (++chunk->hit_count == ctx->hit_limit) return;
+            continue;
+        }
+        line_offset += count_newlines(counted_upto, line_start);
+        counted_upto = line_start;
+        if (chunk->hit_count == chunk->hit_capacity) {
+            chunk->hit_capacity = chunk->hit_capacity == 0 ? 64 : chunk->hit_capacity * 2;
+            chunk->hits = (FoundRange*)realloc(chunk->hits, chunk->hit_capacity * sizeof(FoundRange));
+            CHECK_ALLOC(chunk->hits, "Mở rộng danh sách kết quả tìm kiếm");
+        }
+        FoundRange *hit = &chunk->hits[chunk->hit_count++];
+        hit->line_start = line_start;
+        hit->line_end = line_end;
+        hit->line_offset = line_offset;
+        if (chunk->hit_count == ctx->hit_limit) return;
+    }
+    if (ctx->store_hits) chunk->newline_count = line_offset + count_newlines(counted_upto, chunk->end);
+}
+
+/**
+ * @brief Tạo nhóm luồng và bản truy vấn cho từng luồng (chỉ một lần, khi lần đầu gặp tệp lớn).
+ */
+static void start_find_pool(FindBatchContext *ctx) {
+    ctx->pool = threadpool_create(ctx->config->num_threads);
+    ctx->num_workers = threadpool_size(ctx->pool);
+    ctx->batch_size = ctx->num_workers * FIND_CHUNKS_PER_THREAD;
+
+    ctx->queries = (FindQuery*)realloc(ctx->queries, ctx->num_workers * sizeof(FindQuery));
+    ctx->chunks = (FindChunk*)realloc(ctx->chunks, ctx->batch_size * sizeof(FindChunk));
+    CHECK_ALLOC(ctx->queries, "Tạo truy vấn cho từng luồng");
+    CHECK_ALLOC(ctx->chunks, "Tạo danh sách đoạn tệp");
+    memset(ctx->chunks + 1, 0, (ctx->batch_size - 1) * sizeof(FindChunk));
+    for (int i = 1; i < ctx->num_workers; i++) {
+        ctx->queries[i] = ctx->query;
+        if (ctx->config->use_regex) {
+            ctx->queries[i].regex = regex_compile(ctx->config->keyword, ctx->config->case_sensitive, NULL, 0);
+            CHECK_ALLOC(ctx->queries[i].regex, "Biên dịch biểu thức chính quy cho từng luồng");
+        }
+    }
+}
+
+/**
+ * @brief Tìm trong một tệp (hoặc khoảng --bytes/--lines của nó) theo từng đợt đoạn tệp và in kết quả
+ * theo thứ tự trong tệp (sau dòng "== tên tệp ==" khi tìm nhiều tệp). Dừng đọc tệp ngay khi đã đủ hit_limit dòng khớp.
+ * @return Số dòng khớp, hoặc -1 nếu không đọc được tệp.
+ */
+static int find_in_file(FindBatchContext *ctx, const char *filename, FILE *output_stream) {
+    FileRegion region;
+    if (load_file_region(ctx->config, filename, &region) != 0) return -1;
+    if (ctx->config->find_output == FIND_OUTPUT_LINES && ctx->config->input_count > 1) {
+        fprintf(output_stream, "== %s ==\n", filename);
+    }
+
+    // Tệp nhỏ hơn một đoạn thì tìm ngay trên luồng chính
+    int use_pool = ctx->config->num_threads != 1 && region.size > FIND_CHUNK_SIZE;
+    if (use_pool && ctx->pool == NULL) start_find_pool(ctx);
+    int batch_size = use_pool ? ctx->batch_size : 1;
+
+    const char *p = region.data;
+    const char *end = region.data + region.size;
+    size_t line_base = region.first_line; // Số dòng của đầu đoạn tiếp theo
+    int found = 0;
+
+    while (p < end && (ctx->hit_limit == 0 || found < ctx->hit_limit)) {
+        int count = 0;
+        while (count < batch_size && p < end) {
+            const char *chunk_end = end;
+            if ((size_t)(end - p) > FIND_CHUNK_SIZE) {
+                const char *newline = (const char*)memchr(p + FIND_CHUNK_SIZE, '\n', end - (p + FIND_CHUNK_SIZE));
+                if (newline != NULL) chunk_end = newline + 1;
             }
-            if (strstr(search_target, keyword_to_find) != NULL) {
-                fprintf(output_stream, "Tìm thấy từ '%s' trong dòng: %s", keyword_to_find, line_buffer);
-                found++;
+            ctx->chunks[count].begin = p;
+            ctx->chunks[count].end = chunk_end;
+            ctx->chunks[count].word_before = p == region.data && region.word_before;
+            ctx->chunks[count].word_after = chunk_end == end && region.word_after;
+            count++;
+            p = chunk_end;
+        }
+
+        if (use_pool) {
+            threadpool_run(ctx->pool, count, find_chunk_task, ctx);
+        } else {
+            for (int i = 0; i < count; i++) find_chunk_task(ctx, i, 0);
+        }
+
+        for (int i = 0; i < count && (ctx->hit_limit == 0 || found < ctx->hit_limit); i++) {
+            const FindChunk *chunk = &ctx->chunks[i];
+            int take = chunk->hit_count;
+            if (ctx->hit_limit > 0 && take > ctx->hit_limit - found) take = ctx->hit_limit - found;
+            if (ctx->store_hits) {
+                for (int j = 0; j < take; j++) {
+                    const FoundRange *hit = &chunk->hits[j];
+                    print_found_line(output_stream, ctx->config->keyword, (int)(line_base + hit->line_offset), hit->line_start, hit->line_end);
+                }
             }
-            free(temp_line_copy);
+            found += take;
+            line_base += chunk->newline_count;
         }
     }
 
-    free(keyword_to_find); // Giải phóng bộ nhớ đã cấp phát cho từ cần tìm
+    free_file_region(&region);
+    return found;
+}
+
+/**
+ * @brief Tìm kiếm một từ trong một hoặc nhiều tệp và in kết quả.
+ * Mỗi tệp được ánh xạ vào bộ nhớ và chia thành các đoạn kết thúc ở cuối dòng. Các đoạn được tìm
+ * song song (-j), số '\n' của từng đoạn được cộng dồn thành số dòng tuyệt đối, và kết quả
+ * được in theo đúng thứ tự trong tệp nên đầu ra giống hệt khi chạy một luồng.
+ * Với --count và --files-with-matches chỉ đếm dòng khớp, không dựng nội dung dòng;
+ * --files-with-matches và --max-count dừng đọc tệp ngay khi đã có câu trả lời.
+ * Tệp không đọc được bị bỏ qua (có thông báo lỗi) và các tệp còn lại vẫn được tìm.
+ * @param config Cấu hình chứa các tệp đầu vào, từ khóa, các tùy chọn tìm kiếm, số luồng và tệp đầu ra.
+ * @return 0 nếu tìm được trên mọi tệp, -1 nếu có tệp không đọc được hoặc truy vấn không hợp lệ.
+ */
+int perform_find(const Config* config) {
+    const char *word_to_find = config->keyword;
+
+    FindBatchContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.config = config;
+    ctx.query.case_sensitive = config->case_sensitive;
+    ctx.query.exact_match = config->exact_match;
+    ctx.query.keyword_length = strlen(word_to_find);
+    ctx.query.keyword_is_token = 1;
+    for (size_t i = 0; i < ctx.query.keyword_length; i++) {
+        if (is_token_delimiter(word_to_find[i])) ctx.query.keyword_is_token = 0;
+    }
+    if (config->use_regex) {
+        char error[256];
+        ctx.query.regex = regex_compile(word_to_find, config->case_sensitive, error, sizeof(error));
+        if (ctx.query.regex == NULL) {
+            fprintf(stderr, "Lỗi: Biểu thức chính quy không hợp lệ: %s\n", error);
+            return -1;
+        }
+    } else if (config->fuzzy_errors >= 0) {
+        ctx.query.fuzzy = (FuzzyPattern*)malloc(sizeof(FuzzyPattern));
+        CHECK_ALLOC(ctx.query.fuzzy, "Tạo mẫu tìm gần đúng");
+        if (fuzzy_compile(ctx.query.fuzzy, word_to_find, ctx.query.keyword_length, config->fuzzy_errors, config->case_sensitive) != 0) {
+            fprintf(stderr, "Lỗi: Từ khóa cho '--fuzzy' phải dài từ 1 đến %d ký tự và dài hơn số lỗi cho phép.\n", FUZZY_MAX_PATTERN);
+            free_find_query(&ctx.query);
+            return -1;
+        }
+    } else if (search_compile(&ctx.query.pattern, word_to_find, ctx.query.keyword_length, config->case_sensitive) != 0) {
+        fprintf(stderr, "Lỗi: Từ khóa tìm kiếm không hợp lệ.\n");
+        free_find_query(&ctx.query);
+        return -1;
+    }
+
+    FILE *output_stream = stdout; // Mặc định in ra console
+    if (config->output_filename != NULL) {
+        output_stream = fopen(config->output_filename, "w");
+        if (output_stream == NULL) {
+            printf("Lỗi: Không thể tạo tệp đầu ra '%s'\n", config->output_filename);
+            free_find_query(&ctx.query);
+            return -1; // Thoát nếu không tạo được file
+        }
+        printf("Đã ghi kết quả vào tệp: %s\n", config->output_filename);
+    }
+
+    // Truy vấn của luồng chính (bản 0) và một đoạn cho chế độ tuần tự; start_find_pool mở rộng khi cần
+    ctx.num_workers = 1;
+    ctx.batch_size = 1;
+    ctx.queries = (FindQuery*)malloc(sizeof(FindQuery));
+    ctx.chunks = (FindChunk*)calloc(1, sizeof(FindChunk));
+    CHECK_ALLOC(ctx.queries, "Tạo truy vấn cho từng luồng");
+    CHECK_ALLOC(ctx.chunks, "Tạo danh sách đoạn tệp");
+    ctx.queries[0] = ctx.query;
+    ctx.store_hits = config->find_output == FIND_OUTPUT_LINES;
+    ctx.hit_limit = config->find_output == FIND_OUTPUT_FILES ? 1 : config->max_count;
+
+    int total_found = 0;
+    int failed = 0; // Số tệp không đọc được; các tệp còn lại vẫn được tìm
+    for (int f = 0; f < config->input_count; f++) {
+        const char *filename = config->input_files[f];
+        int found = find_in_file(&ctx, filename, output_stream);
+        if (found < 0) {
+            failed++;
+            continue;
+        }
+        total_found += found;
+
+        if (config->find_output == FIND_OUTPUT_COUNT) {
+            fprintf(output_stream, "%s: %d\n", filename, found);
+        } else if (config->find_output == FIND_OUTPUT_FILES) {
+            if (found > 0) fprintf(output_stream, "%s\n", filename);
+        } else if (!found) {
+            fprintf(output_stream, "Không tìm thấy từ '%s' trong tệp.\n", word_to_find);
+        }
+    }
+    if (config->find_output == FIND_OUTPUT_FILES && total_found == 0) {
+        fprintf(output_stream, "Không có tệp nào chứa từ '%s'.\n", word_to_find);
+    }
 
-    if (!found) fprintf(output_stream, "Không tìm thấy từ '%s' trong tệp.\n", word_to_find);
+    for (int i = 0; i < ctx.batch_size; i++) free(ctx.chunks[i].hits);
+    for (int i = 1; i < ctx.num_workers; i++) regex_free(ctx.queries[i].regex);
+    free(ctx.chunks);
+    free(ctx.queries);
+    threadpool_destroy(ctx.pool);
+    free_find_query(&ctx.query);
     if (output_stream != stdout) fclose(output_stream);
+    return failed > 0 ? -1 : 0;
+}
+
+// Trạng thái của 'find --patterns' khi nhận kết quả từ automaton Aho-Corasick
+typedef struct {
+    FILE *output_stream;
+    const PatternList *patterns;
+    int exact_match;
+    const char *data;          // Đầu và cuối vùng nhớ ánh xạ
+    const char *end;
+    const char *line_start;    // Dòng chứa kết quả gần nhất (line_end == NULL nếu chưa có)
+    const char *line_end;
+    int line_number;
+    int *last_reported_line;   // Dòng cuối cùng đã in cho từng mẫu, để mỗi cặp (dòng, mẫu) chỉ in một lần
+    int found;
+} PatternFindContext;
+
+/**
+ * @brief Nhận một kết quả từ multisearch_scan (theo thứ tự vị trí kết thúc, nên số dòng chỉ tăng).
+ */
+static int report_pattern_hit(void *context, int pattern_index, const char *match_start, const char *match_end) {
+    PatternFindContext *ctx = (PatternFindContext*)context;
+
+    // --match: kết quả phải đứng riêng, hai bên là ký tự phân tách như khi tách từ
+    if (ctx->exact_match) {
+        if (match_start > ctx->data && !is_token_delimiter(match_start[-1])) return 0;
+        if (match_end < ctx->end && !is_token_delimiter(*match_end)) return 0;
+    }
+
+    if (ctx->line_end == NULL || match_start > ctx->line_end) {
+        const char *new_line_start = match_start;
+        while (new_line_start > ctx->line_start && new_line_start[-1] != '\n') new_line_start--;
+        ctx->line_number += (int)count_newlines(ctx->line_start, new_line_start);
+        ctx->line_start = new_line_start;
+        const char *newline = (const char*)memchr(match_start, '\n', ctx->end - match_start);
+        ctx->line_end = newline != NULL ? newline : ctx->end;
+    }
+
+    if (ctx->last_reported_line[pattern_index] != ctx->line_number) {
+        ctx->last_reported_line[pattern_index] = ctx->line_number;
+        print_found_line(ctx->output_stream, ctx->patterns->patterns[pattern_index], ctx->line_number, ctx->line_start, ctx->line_end);
+        ctx->found++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Tìm đồng thời mọi mẫu trong tệp danh sách (--patterns) bằng một lượt quét Aho-Corasick.
+ * Mỗi dòng của tệp đầu vào được in một lần cho mỗi mẫu xuất hiện trong nó.
+ * @param config Cấu hình chứa tệp đầu vào, tệp mẫu và các tùy chọn tìm kiếm.
+ * @return 0 nếu thành công, -1 nếu không đọc được tệp đầu vào hoặc tệp mẫu.
+ */
+int perform_find_patterns(const Config* config) {
+    PatternList patterns;
+    if (pattern_list_load(&patterns, config->patterns_filename) != 0) {
+        fprintf(stderr, "Lỗi: Không thể đọc tệp danh sách mẫu '%s'\n", config->patterns_filename);
+        return -1;
+    }
+
+    MultiSearch automaton;
+    if (multisearch_compile(&automaton, patterns.patterns, patterns.lengths, patterns.count, config->case_sensitive) != 0) {
+        fprintf(stderr, "Lỗi: Tệp danh sách mẫu '%s' không có mẫu hợp lệ.\n", config->patterns_filename);
+        pattern_list_free(&patterns);
+        return -1;
+    }
+
+    MappedFile mapped;
+    if (map_file(config->input_filename, &mapped) != 0) {
+        fprintf(stderr, "Lỗi: Không thể ánh xạ tệp '%s'\n", config->input_filename);
+        multisearch_free(&automaton);
+        pattern_list_free(&patterns);
+        return -1;
+    }
+
+    FILE *output_stream = stdout;
+    if (config->output_filename != NULL) {
+        output_stream = fopen(config->output_filename, "w");
+        if (output_stream == NULL) {
+            printf("Lỗi: Không thể tạo tệp đầu ra '%s'\n", config->output_filename);
+            unmap_file(&mapped);
+            multisearch_free(&automaton);
+            pattern_list_free(&patterns);
+            return -1;
+        }
+        printf("Đã ghi kết quả vào tệp: %s\n", config->output_filename);
+    }
+
+    PatternFindContext ctx;
+    ctx.output_stream = output_stream;
+    ctx.patterns = &patterns;
+    ctx.exact_match = config->exact_match;
+    ctx.data = mapped.data;
+    ctx.end = mapped.data + mapped.size;
+    ctx.line_start = mapped.data;
+    ctx.line_end = NULL;
+    ctx.line_number = 1;
+    ctx.found = 0;
+    ctx.last_reported_line = (int*)calloc(patterns.count, sizeof(int));
+    CHECK_ALLOC(ctx.last_reported_line, "Tạo bảng dòng đã in cho từng mẫu");
+
+    multisearch_scan(&automaton, ctx.data, ctx.end, report_pattern_hit, &ctx);
+
+    if (!ctx.found) fprintf(output_stream, "Không tìm thấy mẫu nào trong tệp.\n");
+
+    free(ctx.last_reported_line);
+    unmap_file(&mapped);
+    multisearch_free(&automaton);
+    pattern_list_free(&patterns);
+    if (output_stream != stdout) fclose(output_stream);
+    return 0;
+}
+
+/**
+ * @brief Tạo tên tệp chỉ mục mặc định "<tên_tệp>.idx".
+ * @return Chuỗi mới cấp phát (người gọi giải phóng).
+ */
+static char* make_index_filename(const char *input_filename) {
+    char *index_filename = (char*)malloc(strlen(input_filename) + 5);
+    CHECK_ALLOC(index_filename, "Tạo tên tệp chỉ mục");
+    strcpy(index_filename, input_filename);
+    strcat(index_filename, ".idx");
+    return index_filename;
+}
+
+/**
+ * @brief Tạo chỉ mục đảo có vị trí cho tệp đầu vào.
+ * @param config Cấu hình chứa tệp đầu vào, tệp chỉ mục (-o) và chế độ phân biệt hoa/thường.
+ * @return 0 nếu thành công, -1 nếu thất bại.
+ */
+int perform_index(const Config* config) {
+    char *index_filename = config->output_filename != NULL ? strdup(config->output_filename) : make_index_filename(config->input_filename);
+    CHECK_ALLOC(index_filename, "Tạo tên tệp chỉ mục");
+
+    clock_t start = clock();
+    IndexBuildStats stats;
+    if (index_build(config->input_filename, index_filename, config->case_sensitive, &stats) != 0) {
+        fprintf(stderr, "Lỗi: Không thể tạo chỉ mục '%s' cho tệp '%s'\n", index_filename, config->input_filename);
+        free(index_filename);
+        return -1;
+    }
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("Đã tạo chỉ mục: %s\n", index_filename);
+    printf("Số từ đã lập chỉ mục: %llu (%u từ duy nhất)\n", (unsigned long long)stats.token_count, stats.term_count);
+    printf("Kích thước chỉ mục: %llu bytes\n", (unsigned long long)stats.index_size);
+    printf("Thời gian: %.3f giây\n", elapsed);
+    free(index_filename);
+    return 0;
+}
+
+/**
+ * @brief Tìm từ hoặc cụm từ chính xác bằng chỉ mục đảo: giao các danh sách vị trí rồi chỉ
+ * đọc những dòng chứa kết quả từ tệp nguồn, không quét lại toàn bộ tệp.
+ * @param config Cấu hình chứa tệp đầu vào, từ khóa, tệp chỉ mục (--index-file) và các tùy chọn tìm kiếm.
+ * @return 0 nếu thành công, -1 nếu không dùng được chỉ mục hoặc tệp đầu vào.
+ */
+int perform_find_indexed(const Config* config) {
+    char *index_filename = config->index_filename != NULL ? strdup(config->index_filename) : make_index_filename(config->input_filename);
+    CHECK_ALLOC(index_filename, "Tạo tên tệp chỉ mục");
+    InvertedIndex index;
+    if (index_open(&index, index_filename) != 0) {
+        fprintf(stderr, "Lỗi: Không thể mở chỉ mục '%s'. Hãy tạo bằng lệnh 'index' trước.\n", index_filename);
+        free(index_filename);
+        return -1;
+    }
+    if (index_is_stale(&index, config->input_filename)) {
+        fprintf(stderr, "Lỗi: Chỉ mục '%s' không còn khớp với tệp nguồn. Hãy chạy lại lệnh 'index'.\n", index_filename);
+        index_close(&index);
+        free(index_filename);
+        return -1;
+    }
+    int index_case_sensitive = (index.flags & INDEX_FLAG_CASE_SENSITIVE) != 0;
+    if (index_case_sensitive != (config->case_sensitive != 0)) {
+        fprintf(stderr, "Lỗi: Chỉ mục '%s' được tạo %s tùy chọn '--case-sensitive'; hãy dùng cùng chế độ hoặc tạo lại chỉ mục.\n",
+                index_filename, index_case_sensitive ? "với" : "không có");
+        index_close(&index);
+        free(index_filename);
+        return -1;
+    }
+    free(index_filename);
+
+    // Tách từ khóa thành các từ theo cùng quy tắc với chỉ mục; nhiều từ nghĩa là tìm cụm từ
+    size_t keyword_length = strlen(config->keyword);
+    char *folded_keyword = strdup(config->keyword);
+    CHECK_ALLOC(folded_keyword, "Sao chép từ khóa");
+    if (!config->case_sensitive) to_lowercase(folded_keyword);
+    const char **terms = (const char**)malloc((keyword_length / 2 + 1) * sizeof(const char*));
+    size_t *term_lengths = (size_t*)malloc((keyword_length / 2 + 1) * sizeof(size_t));
+    CHECK_ALLOC(terms, "Tạo danh sách từ của truy vấn");
+    CHECK_ALLOC(term_lengths, "Tạo danh sách từ của truy vấn");
+    int term_count = 0;
+    const char *cursor = folded_keyword;
+    const char *term;
+    size_t term_length;
+    while ((term = next_token_span(&cursor, folded_keyword + keyword_length, &term_length)) != NULL) {
+        terms[term_count] = term;
+        term_lengths[term_count] = term_length;
+        term_count++;
+    }
+
+    Posting *results = NULL;
+    size_t result_count = 0;
+    MappedFile mapped;
+    memset(&mapped, 0, sizeof(mapped));
+    int ok = 0;
+    if (term_count == 0) {
+        fprintf(stderr, "Lỗi: Từ khóa không chứa từ nào để tra chỉ mục.\n");
+    } else if (index_find_phrase(&index, terms, term_lengths, term_count, &results, &result_count) != 0) {
+        fprintf(stderr, "Lỗi: Tệp chỉ mục bị hỏng.\n");
+    } else if (result_count > 0 && map_file(config->input_filename, &mapped) != 0) {
+        fprintf(stderr, "Lỗi: Không thể ánh xạ tệp '%s'\n", config->input_filename);
+    } else {
+        ok = 1;
+    }
+
+    FILE *output_stream = stdout;
+    if (ok && config->output_filename != NULL) {
+        output_stream = fopen(config->output_filename, "w");
+        if (output_stream == NULL) {
+            printf("Lỗi: Không thể tạo tệp đầu ra '%s'\n", config->output_filename);
+            output_stream = stdout;
+            ok = 0;
+        } else {
+            printf("Đã ghi kết quả vào tệp: %s\n", config->output_filename);
+        }
+    }
+
+    if (ok) {
+        // Kết quả tăng dần theo vị trí nên các dòng trùng nhau đứng liền nhau
+        uint64_t last_line = 0;
+        const char *end = mapped.data + mapped.size;
+        for (size_t i = 0; i < result_count; i++) {
+            if (results[i].line == last_line || results[i].offset >= mapped.size) continue;
+            last_line = results[i].line;
+            const char *hit = mapped.data + results[i].offset;
+            const char *line_start = hit;
+            while (line_start > mapped.data && line_start[-1] != '\n') line_start--;
+            const char *newline = (const char*)memchr(hit, '\n', end - hit);
+            print_found_line(output_stream, config->keyword, (int)results[i].line, line_start, newline != NULL ? newline : end);
+        }
+        if (result_count == 0) fprintf(output_stream, "Không tìm thấy từ '%s' trong tệp.\n", config->keyword);
+    }
+
+    free(results);
+    free(terms);
+    free(term_lengths);
+    free(folded_keyword);
+    unmap_file(&mapped);
+    index_close(&index);
+    if (output_stream != stdout) fclose(output_stream);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief Mở tệp đầu ra nhị phân; "-" nghĩa là đầu ra chuẩn (chuyển sang chế độ nhị phân trên Windows).
+ * @return Con trỏ đến tệp, hoặc NULL nếu không thể tạo.
+ */
+static FILE* open_binary_output(const char* filename) {
+    if (strcmp(filename, "-") == 0) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        return stdout;
+    }
+    return fopen(filename, "wb");
 }
 
 /**
@@ -502,26 +2235,36 @@ void perform_find(FILE *file, int case_sensitive, int exact_match, const char *w
  * @return 0 nếu thành công, -1 nếu thất bại.
  */
 int perform_compress(FILE* input_file, const Config* config) {
-    const char* extension = get_string_from_algo(config->algo);
-    // Tạo vùng nhớ cho tên tệp đầu ra
+    // Thông báo đi ra stderr khi dữ liệu nén đi ra stdout
+    FILE* log_stream = strcmp(config->output_filename, "-") == 0 ? stderr : stdout;
+    CompressionAlgorithm algo = config->algo;
+    if (algo == ALG_AUTO) {
+        algo = choose_compression_algorithm(input_file);
+        fprintf(log_stream, "Tự động chọn thuật toán: %s\n", get_string_from_algo(algo));
+    }
+    const char* extension = get_string_from_algo(algo);
+    // Tạo vùng nhớ cho tên tệp đầu ra ("-o -" ghi ra đầu ra chuẩn, không thêm đuôi)
     char* output_name = (char*)malloc(strlen(config->output_filename) + strlen(extension) + 2); // +2 cho '.' và '\0'
     CHECK_ALLOC(output_name, "Tạo tên tệp đầu ra cho compress");
-    sprintf(output_name, "%s.%s", config->output_filename, extension);
+    if (strcmp(config->output_filename, "-") == 0) strcpy(output_name, "-");
+    else sprintf(output_name, "%s.%s", config->output_filename, extension);
 
-    FILE* output_file = fopen(output_name, "wb");
+    FILE* output_file = open_binary_output(output_name);
     if (output_file == NULL) {
         fprintf(stderr, "Lỗi: Không thể tạo tệp đầu ra '%s'\n", output_name);
         free(output_name);
         return -1;
     }
 
-    printf("Đang nén '%s' -> '%s' (thuật toán: %s)\n", config->input_filename, output_name, extension);
-    int result = compress_file(input_file, output_file, config->algo);
+    fprintf(log_stream, "Đang nén '%s' -> '%s' (thuật toán: %s)\n", config->input_filename, output_name, extension);
+    CompressOptions options = { config->num_threads, config->compress_level, config->seekable };
+    int result = compress_file(input_file, output_file, algo, &options);
 
-    fclose(output_file); // Đóng tệp ngay sau khi dùng xong
+    if (output_file != stdout) fclose(output_file); // Đóng tệp ngay sau khi dùng xong
+    else if (fflush(stdout) != 0) result = -1;
 
     if (result == 0) {
-        printf("Nén thành công!\n");
+        fprintf(log_stream, "Nén thành công!\n");
     } else {
         fprintf(stderr, "Lỗi: Nén thất bại!\n");
         free(output_name);
@@ -539,30 +2282,29 @@ int perform_compress(FILE* input_file, const Config* config) {
  * @return 0 nếu thành công, -1 nếu thất bại.
  */
 int perform_decompress(FILE* input_file, const Config* config) {
-    CompressionAlgorithm detected_algo;
-    if (config->algo_is_manual) {
-        detected_algo = config->algo;
-        printf("Giải nén bằng thuật toán chỉ định: %s\n", get_string_from_algo(detected_algo));
-    } else {
-        detected_algo = get_algo_from_filename(config->input_filename);
-        if (detected_algo == ALG_UNKNOWN) {
-            fprintf(stderr, "Lỗi: Không thể tự động nhận diện thuật toán từ tệp '%s'.\n", config->input_filename);
-            return -1;
-        }
-        printf("Tự động nhận diện thuật toán: %s\n", get_string_from_algo(detected_algo));
-    }
+    // Thông báo đi ra stderr khi dữ liệu giải nén đi ra stdout
+    FILE* log_stream = strcmp(config->output_filename, "-") == 0 ? stderr : stdout;
+    // Thuật toán được nhận diện qua header; thuật toán chỉ định hoặc đuôi tệp chỉ là gợi ý cho RLE cũ (không có header)
+    CompressionAlgorithm hint = config->algo_is_manual ? config->algo : get_algo_from_filename(config->input_filename);
 
-    FILE* output_file = fopen(config->output_filename, "wb");
+    FILE* output_file = open_binary_output(config->output_filename);
     if (output_file == NULL) {
         fprintf(stderr, "Lỗi: Không thể tạo tệp đầu ra '%s'\n", config->output_filename);
         return -1;
     }
 
-    int result = decompress_file(input_file, output_file, detected_algo);
-    fclose(output_file); // Đóng tệp ngay sau khi dùng xong
+    CompressOptions options = { config->num_threads, config->compress_level, 0 };
+    CompressionAlgorithm detected_algo = ALG_UNKNOWN;
+    int result = decompress_file(input_file, output_file, hint, &options, &detected_algo);
+    if (output_file != stdout) fclose(output_file); // Đóng tệp ngay sau khi dùng xong
+    else if (fflush(stdout) != 0) result = -1;
 
     if (result == 0) {
-        printf("Đã giải nén '%s' -> '%s' (thuật toán: %s)\n", config->input_filename, config->output_filename, get_string_from_algo(detected_algo));
+        fprintf(log_stream, "Đã giải nén '%s' -> '%s' (thuật toán: %s)\n", config->input_filename, config->output_filename, get_string_from_algo(detected_algo));
+        if (config->algo_is_manual && config->algo != detected_algo) {
+            fprintf(log_stream, "Lưu ý: header cho biết tệp được nén bằng '%s', không phải '%s'.\n",
+                    get_string_from_algo(detected_algo), get_string_from_algo(config->algo));
+        }
     } else {
         fprintf(stderr, "Lỗi: Giải nén thất bại!\n");
         return -1;
@@ -571,6 +2313,23 @@ int perform_decompress(FILE* input_file, const Config* config) {
     return 0;
 }
 
+/**
+ * @brief Kiểm tra tệp nén: giải mã mọi khối (song song theo -j) và so CRC32C mà không ghi dữ liệu gốc ra đâu.
+ * @param input_file Con trỏ đến tệp nén.
+ * @param config Cấu hình chứa tên tệp đầu vào và số luồng.
+ * @return 0 nếu tệp nguyên vẹn, -1 nếu tệp hỏng, bị cắt cụt hoặc dùng định dạng cũ không có CRC.
+ */
+int perform_verify(FILE* input_file, const Config* config) {
+    CompressOptions options = { config->num_threads, 0, 0 };
+    CompressionAlgorithm algo = ALG_UNKNOWN;
+    if (decompress_file(input_file, NULL, ALG_UNKNOWN, &options, &algo) != 0) {
+        fprintf(stderr, "Lỗi: Tệp '%s' không vượt qua kiểm tra.\n", config->input_filename);
+        return -1;
+    }
+    printf("Tệp '%s' nguyên vẹn (thuật toán: %s).\n", config->input_filename, get_string_from_algo(algo));
+    return 0;
+}
+
 /**
  * @brief Chuyển một chuỗi thành chữ thường.
  */
@@ -688,6 +2447,10 @@ CompressionAlgorithm get_algo_from_filename(const char *filename) {
 
     if (strcmp(extension, "rle") == 0) return ALG_RLE;
     if (strcmp(extension, "huffman") == 0 || strcmp(extension, "huff") == 0) return ALG_HUFFMAN;
+    if (strcmp(extension, "rleb") == 0) return ALG_RLE_BLOCK;
+    if (strcmp(extension, "huffb") == 0) return ALG_HUFFMAN_BLOCK;
+    if (strcmp(extension, "lz77") == 0) return ALG_LZ77;
+    if (strcmp(extension, "lzh") == 0) return ALG_LZH;
     // Backwards compatibility with short extensions
     return ALG_UNKNOWN;
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include "threadpool.h"
+
+struct ThreadPool {
+    pthread_t* threads;
+    int num_threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready; // Có đợt công việc mới hoặc yêu cầu dừng
+    pthread_cond_t work_done;  // Đợt công việc hiện tại đã xong
+
+    // Đợt công việc hiện tại (được bảo vệ bởi lock)
+    ThreadPoolTask task;
+    void* context;
+    int count;
+    int next_index;
+    int completed;
+    unsigned long generation;
+    int shutdown;
+};
+
+// Tham số khởi động cho từng luồng
+typedef struct {
+    ThreadPool* pool;
+    int worker;
+} WorkerStart;
+
+static void* worker_main(void* arg) {
+    WorkerStart start = *(WorkerStart*)arg;
+    free(arg);
+    ThreadPool* pool = start.pool;
+    unsigned long seen_generation = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen_generation) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen_generation = pool->generation;
+
+        // Nhận lần lượt từng chỉ số cho đến khi hết đợt
+        while (pool->next_index < pool->count) {
+            int index = pool->next_index++;
+            pthread_mutex_unlock(&pool->lock);
+            pool->task(pool->context, index, start.worker);
+            pthread_mutex_lock(&pool->lock);
+            if (++pool->completed == pool->count) {
+                pthread_cond_signal(&pool->work_done);
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+int get_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+ThreadPool* threadpool_create(int num_threads) {
+    if (num_threads <= 0) num_threads = get_cpu_count();
+
+    ThreadPool* pool = calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) return NULL;
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for (int i = 0; i < num_threads; i++) {
+        WorkerStart* start = malloc(sizeof(WorkerStart));
+        if (start == NULL) break;
+        start->pool = pool;
+        start->worker = i;
+        if (pthread_create(&pool->threads[i], NULL, worker_main, start) != 0) {
+            free(start);
+            break;
+        }
+        pool->num_threads++;
+    }
+
+    if (pool->num_threads == 0) {
+        threadpool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+int threadpool_size(const ThreadPool* pool) {
+    return pool->num_threads;
+}
+
+void threadpool_run(ThreadPool* pool, int count, ThreadPoolTask task, void* context) {
+    if (count <= 0) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->count = count;
+    pool->next_index = 0;
+    pool->completed = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    while (pool->completed < pool->count) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadpool_destroy(ThreadPool* pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
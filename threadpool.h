@@ -0,0 +1,40 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/**
+ * @brief Nhóm luồng cố định, dùng chung cho các tác vụ song song (corpus, find -j, nén theo khối).
+ * Các luồng được tạo một lần và tái sử dụng qua nhiều lần gọi threadpool_run.
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief Chữ ký của một tác vụ.
+ * @param context Dữ liệu dùng chung do người gọi truyền vào.
+ * @param index Chỉ số công việc, từ 0 đến count - 1.
+ * @param worker Chỉ số luồng đang chạy (0..threadpool_size - 1), dùng cho dữ liệu riêng từng luồng.
+ */
+typedef void (*ThreadPoolTask)(void* context, int index, int worker);
+
+/**
+ * @brief Lấy số lõi CPU khả dụng (ít nhất 1).
+ */
+int get_cpu_count(void);
+
+/**
+ * @brief Tạo nhóm luồng.
+ * @param num_threads Số luồng; <= 0 nghĩa là dùng số lõi CPU.
+ * @return Con trỏ đến nhóm luồng, hoặc NULL nếu thất bại.
+ */
+ThreadPool* threadpool_create(int num_threads);
+
+int threadpool_size(const ThreadPool* pool);
+
+/**
+ * @brief Chạy task(context, i, worker) cho mọi i trong [0, count) và chờ tất cả hoàn thành.
+ * Các chỉ số được phát theo thứ tự tăng dần cho luồng rảnh kế tiếp.
+ */
+void threadpool_run(ThreadPool* pool, int count, ThreadPoolTask task, void* context);
+
+void threadpool_destroy(ThreadPool* pool);
+
+#endif // THREADPOOL_H
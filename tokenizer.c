@@ -0,0 +1,42 @@
+#include <stddef.h>
+#include "tokenizer.h"
+
+const unsigned char token_delimiter_table[256] = {
+    ['\0'] = 1, [' '] = 1, ['\t'] = 1, ['\n'] = 1, ['\r'] = 1,
+    [','] = 1, ['.'] = 1, [';'] = 1, [':'] = 1, ['!'] = 1,
+    ['?'] = 1, ['"'] = 1, ['('] = 1, [')'] = 1
+};
+
+char* next_token(char** cursor) {
+    unsigned char* p = (unsigned char*)*cursor;
+
+    // Bỏ qua các ký tự phân tách ở đầu (dừng tại '\0')
+    while (*p != '\0' && token_delimiter_table[*p]) p++;
+    if (*p == '\0') {
+        *cursor = (char*)p;
+        return NULL;
+    }
+
+    unsigned char* start = p;
+    while (!token_delimiter_table[*p]) p++;
+    if (*p != '\0') *p++ = '\0';
+    *cursor = (char*)p;
+    return (char*)start;
+}
+
+const char* next_token_span(const char** cursor, const char* end, size_t* length) {
+    const unsigned char* p = (const unsigned char*)*cursor;
+    const unsigned char* stop = (const unsigned char*)end;
+
+    while (p < stop && token_delimiter_table[*p]) p++;
+    if (p == stop) {
+        *cursor = end;
+        return NULL;
+    }
+
+    const unsigned char* start = p;
+    while (p < stop && !token_delimiter_table[*p]) p++;
+    *length = (size_t)(p - start);
+    *cursor = (const char*)p;
+    return (const char*)start;
+}
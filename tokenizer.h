@@ -0,0 +1,33 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stddef.h>
+
+// Các ký tự phân tách từ, dùng chung cho phân tích, theo dõi và tìm kiếm
+#define TOKEN_DELIMITERS " \t\n\r,.;:!?\"()"
+
+/**
+ * @brief Bảng tra 256 phần tử: 1 nếu byte là ký tự phân tách, 0 nếu không.
+ */
+extern const unsigned char token_delimiter_table[256];
+
+#define is_token_delimiter(c) (token_delimiter_table[(unsigned char)(c)])
+
+/**
+ * @brief Tách từ tiếp theo, tương tự strtok nhưng không dùng trạng thái toàn cục.
+ * Ghi '\0' vào ngay sau từ tìm được và cập nhật *cursor.
+ * @param cursor Con trỏ đến vị trí đọc hiện tại trong chuỗi (sẽ được cập nhật).
+ * @return Con trỏ đến đầu từ, hoặc NULL nếu không còn từ nào.
+ */
+char* next_token(char** cursor);
+
+/**
+ * @brief Tách từ tiếp theo trong vùng nhớ chỉ đọc [*cursor, end) (ví dụ tệp được ánh xạ),
+ * cùng quy tắc với next_token nhưng không ghi vào dữ liệu.
+ * @param cursor Vị trí đọc hiện tại (sẽ được cập nhật đến ngay sau từ tìm được).
+ * @param length Nhận độ dài của từ.
+ * @return Con trỏ đến đầu từ, hoặc NULL nếu không còn từ nào.
+ */
+const char* next_token_span(const char** cursor, const char* end, size_t* length);
+
+#endif // TOKENIZER_H